@@ -1,4 +1,7 @@
-#include <vector>
-#include "fly/base/common.hpp"
+#include "asic_resistant.hpp"
 
-#include "asic_resistant.data"
+// asic_resistant_table.inc is generated from asic_resistant.data by SConscript,
+// which checks the length and checksum of the data at build time.
+alignas(64) const uint32 __asic_resistant_data__[ASIC_RESISTANT_DATA_NUM] = {
+#include "asic_resistant_table.inc"
+};
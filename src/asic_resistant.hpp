@@ -0,0 +1,32 @@
+#ifndef ASIC_RESISTANT
+#define ASIC_RESISTANT
+
+#include <string>
+#include "fly/base/common.hpp"
+
+const uint32 ASIC_RESISTANT_DATA_NUM = 5 * 1024 * 1024;
+const uint32 ASIC_RESISTANT_BATCH_NUM = 8;
+extern const uint32 __asic_resistant_data__[ASIC_RESISTANT_DATA_NUM];
+
+// copy __asic_resistant_data__ into a read-only region, preferring a sealed memfd
+// on huge pages. if share_path is set, a region published there by another
+// process is reused, otherwise ours is published there. returns a description
+// of the memory obtained.
+std::string asic_resistant_load(std::string share_path);
+
+// the data used by the mixing kernels
+const uint32* asic_resistant_data();
+
+// mix the 64 bytes produced by the two coin_hash calls of the pow with
+// __asic_resistant_data__, buf holds big-endian words on input and output.
+void asic_resistant_mix(uint32 buf[16]);
+
+// same result as calling asic_resistant_mix on each buf, but up to
+// ASIC_RESISTANT_BATCH_NUM bufs share every pass over the data.
+void asic_resistant_mix_batch(uint32 bufs[][16], uint32 num);
+
+// select the fastest mixing kernel supported by this cpu, every kernel is
+// checked against the scalar one first. returns the name of the kernel.
+std::string asic_resistant_auto_detect();
+
+#endif
@@ -0,0 +1,254 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include "fly/base/logger.hpp"
+#include "asic_resistant.hpp"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_GET_SEALS 1034
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0x40000
+#endif
+
+namespace
+{
+
+const uint32 DATA_SIZE = ASIC_RESISTANT_DATA_NUM * sizeof(uint32);
+const uint32 *data_ptr = NULL;
+int data_fd = -1;
+bool data_sealed = false;
+
+int create_memfd(uint32 flags)
+{
+#ifdef SYS_memfd_create
+    return syscall(SYS_memfd_create, "askcoin_asic_resistant_data", flags);
+#else
+    errno = ENOSYS;
+
+    return -1;
+#endif
+}
+
+// open the region published by another askcoin process, it must be sealed
+// against writes and hold exactly the same data as this binary.
+const uint32* attach_shared(const std::string &share_path)
+{
+    int fd = open(share_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if(fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    int seals = fcntl(fd, F_GET_SEALS);
+    
+    if(fstat(fd, &st) != 0 || st.st_size != DATA_SIZE || seals < 0 || !(seals & F_SEAL_WRITE) || !(seals & F_SEAL_SHRINK))
+    {
+        close(fd);
+
+        return NULL;
+    }
+
+    void *ptr = mmap(NULL, DATA_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+
+    if(ptr == MAP_FAILED)
+    {
+        close(fd);
+
+        return NULL;
+    }
+    
+    if(memcmp(ptr, __asic_resistant_data__, DATA_SIZE) != 0)
+    {
+        munmap(ptr, DATA_SIZE);
+        close(fd);
+
+        return NULL;
+    }
+    
+    data_fd = fd;
+
+    return (const uint32*)ptr;
+}
+
+// copy the data into a fresh memfd, seal it and map it read-only
+const uint32* create_shared(bool hugetlb)
+{
+    int fd = create_memfd(MFD_CLOEXEC | MFD_ALLOW_SEALING | (hugetlb ? MFD_HUGETLB : 0));
+
+    if(fd < 0)
+    {
+        return NULL;
+    }
+
+    if(ftruncate(fd, DATA_SIZE) != 0)
+    {
+        close(fd);
+
+        return NULL;
+    }
+    
+    void *ptr = mmap(NULL, DATA_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if(ptr == MAP_FAILED)
+    {
+        close(fd);
+
+        return NULL;
+    }
+
+    if(!hugetlb)
+    {
+        madvise(ptr, DATA_SIZE, MADV_HUGEPAGE);
+    }
+    
+    memcpy(ptr, __asic_resistant_data__, DATA_SIZE);
+    munmap(ptr, DATA_SIZE);
+
+    // older kernels can't seal a hugetlb memfd, it's still mapped read-only here but won't be published
+    data_sealed = fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == 0;
+    
+    if(!data_sealed && !hugetlb)
+    {
+        close(fd);
+
+        return NULL;
+    }
+    
+    ptr = mmap(NULL, DATA_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+
+    if(ptr == MAP_FAILED)
+    {
+        close(fd);
+
+        return NULL;
+    }
+    
+    data_fd = fd;
+    
+    return (const uint32*)ptr;
+}
+
+const uint32* create_anonymous(bool hugetlb)
+{
+    void *ptr = mmap(NULL, DATA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | (hugetlb ? MAP_HUGETLB : 0), -1, 0);
+
+    if(ptr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    if(!hugetlb)
+    {
+        madvise(ptr, DATA_SIZE, MADV_HUGEPAGE);
+    }
+    
+    memcpy(ptr, __asic_resistant_data__, DATA_SIZE);
+    mprotect(ptr, DATA_SIZE, PROT_READ);
+    
+    return (const uint32*)ptr;
+}
+
+// let other processes find our memfd through share_path
+void publish_shared(const std::string &share_path)
+{
+    char fd_path[64];
+    sprintf(fd_path, "/proc/%d/fd/%d", getpid(), data_fd);
+    std::string tmp_path = share_path + ".tmp";
+    unlink(tmp_path.c_str());
+
+    if(symlink(fd_path, tmp_path.c_str()) != 0 || rename(tmp_path.c_str(), share_path.c_str()) != 0)
+    {
+        LOG_ERROR("publish asic resistant data to %s failed", share_path.c_str());
+    }
+}
+
+}
+
+const uint32* asic_resistant_data()
+{
+    if(data_ptr == NULL)
+    {
+        return __asic_resistant_data__;
+    }
+    
+    return data_ptr;
+}
+
+std::string asic_resistant_load(std::string share_path)
+{
+    std::string backing;
+    
+    if(!share_path.empty())
+    {
+        data_ptr = attach_shared(share_path);
+
+        if(data_ptr != NULL)
+        {
+            backing = "shared memfd attached from " + share_path;
+        }
+    }
+    
+    if(data_ptr == NULL)
+    {
+        if((data_ptr = create_shared(true)) != NULL)
+        {
+            backing = "memfd on 2MB huge pages";
+        }
+        else if((data_ptr = create_shared(false)) != NULL)
+        {
+            backing = "sealed memfd with transparent huge pages advised";
+        }
+        else if((data_ptr = create_anonymous(true)) != NULL)
+        {
+            backing = "anonymous 2MB huge pages";
+        }
+        else if((data_ptr = create_anonymous(false)) != NULL)
+        {
+            backing = "anonymous memory with transparent huge pages advised";
+        }
+        else
+        {
+            return "read-only data section of the binary";
+        }
+
+        if(data_sealed && !share_path.empty())
+        {
+            publish_shared(share_path);
+            backing += ", published to " + share_path;
+        }
+    }
+    
+    if(mlock(data_ptr, DATA_SIZE) == 0)
+    {
+        backing += ", locked";
+    }
+    else
+    {
+        backing += ", not locked";
+    }
+
+    return backing;
+}
@@ -0,0 +1,273 @@
+#include <netinet/in.h>
+#include <cstring>
+#include <vector>
+#if defined(__x86_64__) || defined(__amd64__)
+#include <immintrin.h>
+#endif
+#include "fly/base/logger.hpp"
+#include "asic_resistant.hpp"
+
+namespace
+{
+
+// mix K states of 16 words, stored one after another, with one pass over data
+typedef void (*Mix_Func)(uint32 *states, const uint32 *data, uint32 num);
+
+template<uint32 K>
+void mix_scalar(uint32 *states, const uint32 *data, uint32 num)
+{
+    uint32 arr_16[K][16];
+    memcpy(arr_16, states, K * 64);
+    
+    for(uint32 i = 0; i < num;)
+    {
+        for(uint32 c = 0; c < K; ++c)
+        {
+            for(int j = 0; j < 16; ++j)
+            {
+                arr_16[c][j] = (arr_16[c][j] + data[i + j]) * (arr_16[c][j] ^ data[i + j]);
+            }
+        }
+        
+        i += 16;
+    }
+
+    memcpy(states, arr_16, K * 64);
+}
+
+#if defined(__x86_64__) || defined(__amd64__)
+
+template<uint32 K>
+__attribute__((target("sse4.1")))
+void mix_sse4(uint32 *states, const uint32 *data, uint32 num)
+{
+    __m128i a[K][4];
+
+    for(uint32 c = 0; c < K; ++c)
+    {
+        for(uint32 j = 0; j < 4; ++j)
+        {
+            a[c][j] = _mm_loadu_si128((const __m128i*)(states + c * 16 + j * 4));
+        }
+    }
+    
+    for(uint32 i = 0; i < num; i += 16)
+    {
+        __m128i d0 = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i d1 = _mm_loadu_si128((const __m128i*)(data + i + 4));
+        __m128i d2 = _mm_loadu_si128((const __m128i*)(data + i + 8));
+        __m128i d3 = _mm_loadu_si128((const __m128i*)(data + i + 12));
+
+        for(uint32 c = 0; c < K; ++c)
+        {
+            a[c][0] = _mm_mullo_epi32(_mm_add_epi32(a[c][0], d0), _mm_xor_si128(a[c][0], d0));
+            a[c][1] = _mm_mullo_epi32(_mm_add_epi32(a[c][1], d1), _mm_xor_si128(a[c][1], d1));
+            a[c][2] = _mm_mullo_epi32(_mm_add_epi32(a[c][2], d2), _mm_xor_si128(a[c][2], d2));
+            a[c][3] = _mm_mullo_epi32(_mm_add_epi32(a[c][3], d3), _mm_xor_si128(a[c][3], d3));
+        }
+    }
+
+    for(uint32 c = 0; c < K; ++c)
+    {
+        for(uint32 j = 0; j < 4; ++j)
+        {
+            _mm_storeu_si128((__m128i*)(states + c * 16 + j * 4), a[c][j]);
+        }
+    }
+}
+
+template<uint32 K>
+__attribute__((target("avx2")))
+void mix_avx2(uint32 *states, const uint32 *data, uint32 num)
+{
+    __m256i a[K][2];
+
+    for(uint32 c = 0; c < K; ++c)
+    {
+        a[c][0] = _mm256_loadu_si256((const __m256i*)(states + c * 16));
+        a[c][1] = _mm256_loadu_si256((const __m256i*)(states + c * 16 + 8));
+    }
+    
+    for(uint32 i = 0; i < num; i += 16)
+    {
+        __m256i d0 = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i d1 = _mm256_loadu_si256((const __m256i*)(data + i + 8));
+
+        for(uint32 c = 0; c < K; ++c)
+        {
+            a[c][0] = _mm256_mullo_epi32(_mm256_add_epi32(a[c][0], d0), _mm256_xor_si256(a[c][0], d0));
+            a[c][1] = _mm256_mullo_epi32(_mm256_add_epi32(a[c][1], d1), _mm256_xor_si256(a[c][1], d1));
+        }
+    }
+
+    for(uint32 c = 0; c < K; ++c)
+    {
+        _mm256_storeu_si256((__m256i*)(states + c * 16), a[c][0]);
+        _mm256_storeu_si256((__m256i*)(states + c * 16 + 8), a[c][1]);
+    }
+}
+
+template<uint32 K>
+__attribute__((target("avx512f")))
+void mix_avx512(uint32 *states, const uint32 *data, uint32 num)
+{
+    __m512i a[K];
+
+    for(uint32 c = 0; c < K; ++c)
+    {
+        a[c] = _mm512_loadu_si512(states + c * 16);
+    }
+    
+    for(uint32 i = 0; i < num; i += 16)
+    {
+        __m512i d = _mm512_loadu_si512(data + i);
+
+        for(uint32 c = 0; c < K; ++c)
+        {
+            a[c] = _mm512_mullo_epi32(_mm512_add_epi32(a[c], d), _mm512_xor_si512(a[c], d));
+        }
+    }
+
+    for(uint32 c = 0; c < K; ++c)
+    {
+        _mm512_storeu_si512(states + c * 16, a[c]);
+    }
+}
+
+#endif
+
+// index K holds the kernel which mixes K states per pass
+#define MIX_FUNCS(name) {nullptr, name<1>, name<2>, name<3>, name<4>, name<5>, name<6>, name<7>, name<8>}
+
+const Mix_Func mix_scalar_funcs[ASIC_RESISTANT_BATCH_NUM + 1] = MIX_FUNCS(mix_scalar);
+
+#if defined(__x86_64__) || defined(__amd64__)
+const Mix_Func mix_sse4_funcs[ASIC_RESISTANT_BATCH_NUM + 1] = MIX_FUNCS(mix_sse4);
+const Mix_Func mix_avx2_funcs[ASIC_RESISTANT_BATCH_NUM + 1] = MIX_FUNCS(mix_avx2);
+const Mix_Func mix_avx512_funcs[ASIC_RESISTANT_BATCH_NUM + 1] = MIX_FUNCS(mix_avx512);
+#endif
+
+bool self_test(const Mix_Func *funcs)
+{
+    const uint32 num = 4096;
+    std::vector<uint32> data(num);
+    uint32 seed = 0x9e3779b9;
+    uint32 expect[ASIC_RESISTANT_BATCH_NUM][16];
+    uint32 states[ASIC_RESISTANT_BATCH_NUM][16];
+    
+    for(uint32 i = 0; i < num; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        data[i] = seed;
+    }
+
+    for(uint32 c = 0; c < ASIC_RESISTANT_BATCH_NUM; ++c)
+    {
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            expect[c][i] = (c * 16 + i) * 0x01010101 + 0x12345678;
+        }
+        
+        mix_scalar<1>(expect[c], &data[0], num);
+    }
+
+    for(uint32 k = 1; k <= ASIC_RESISTANT_BATCH_NUM; ++k)
+    {
+        for(uint32 c = 0; c < k; ++c)
+        {
+            for(uint32 i = 0; i < 16; ++i)
+            {
+                states[c][i] = (c * 16 + i) * 0x01010101 + 0x12345678;
+            }
+        }
+
+        funcs[k](states[0], &data[0], num);
+        
+        if(memcmp(states, expect, k * 64) != 0)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+const Mix_Func *mix_funcs = mix_scalar_funcs;
+
+}
+
+void asic_resistant_mix(uint32 buf[16])
+{
+    asic_resistant_mix_batch((uint32(*)[16])buf, 1);
+}
+
+void asic_resistant_mix_batch(uint32 bufs[][16], uint32 num)
+{
+    uint32 arr_16[ASIC_RESISTANT_BATCH_NUM][16];
+
+    for(uint32 n = 0; n < num;)
+    {
+        uint32 k = num - n;
+
+        if(k > ASIC_RESISTANT_BATCH_NUM)
+        {
+            k = ASIC_RESISTANT_BATCH_NUM;
+        }
+
+        for(uint32 c = 0; c < k; ++c)
+        {
+            for(uint32 i = 0; i < 16; ++i)
+            {
+                arr_16[c][i] = ntohl(bufs[n + c][i]);
+            }
+        }
+
+        mix_funcs[k](arr_16[0], asic_resistant_data(), ASIC_RESISTANT_DATA_NUM);
+    
+        for(uint32 c = 0; c < k; ++c)
+        {
+            for(uint32 i = 0; i < 16; ++i)
+            {
+                bufs[n + c][i] = htonl(arr_16[c][i]);
+            }
+        }
+
+        n += k;
+    }
+}
+
+std::string asic_resistant_auto_detect()
+{
+    std::string algo = "standard";
+    std::vector<std::string> failed_algos;
+    
+#if defined(__x86_64__) || defined(__amd64__)
+    __builtin_cpu_init();
+    auto try_funcs = [&](const char *name, const Mix_Func *funcs) -> bool {
+        if(!self_test(funcs))
+        {
+            failed_algos.push_back(name);
+
+            return false;
+        }
+
+        mix_funcs = funcs;
+        algo = name;
+
+        return true;
+    };
+    
+    // a kernel which fails the self test (a miscompiled build, a broken cpu) is skipped
+    bool found = __builtin_cpu_supports("avx512f") && try_funcs("avx512", mix_avx512_funcs);
+    found = found || (__builtin_cpu_supports("avx2") && try_funcs("avx2", mix_avx2_funcs));
+    found = found || (__builtin_cpu_supports("sse4.1") && try_funcs("sse4", mix_sse4_funcs));
+#endif
+
+    for(auto &failed_algo : failed_algos)
+    {
+        CONSOLE_LOG_FATAL("the '%s' asic resistant mixing implementation failed its self test, falling back to '%s'", \
+                          failed_algo.c_str(), algo.c_str());
+    }
+    
+    return algo;
+}
@@ -20,6 +20,9 @@
 #include "net/p2p/node.hpp"
 #include "net/api/wsock_node.hpp"
 #include "blockchain.hpp"
+#include "verify_pool.hpp"
+#include "block_cache.hpp"
+#include "asic_resistant.hpp"
 #include "command.hpp"
 #include "utilstrencodings.h"
 
@@ -51,6 +54,8 @@ bool AppInitSanityChecks()
 {
     std::string sha256_algo = SHA256AutoDetect();
     CONSOLE_LOG_INFO("Using the '%s' SHA256 implementation", sha256_algo.c_str());
+    std::string mix_algo = asic_resistant_auto_detect();
+    CONSOLE_LOG_INFO("Using the '%s' asic resistant mixing implementation", mix_algo.c_str());
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -70,7 +75,7 @@ void Shutdown()
 class Askcoin : public fly::base::Singleton<Askcoin>
 {
 public:
-    int main()
+    int main(int argc, char **argv)
     {
         //init library
         fly::init();
@@ -154,6 +159,164 @@ public:
         {
             repair_db = true;
         }
+
+        bool fast_start = false;
+        bool full_verify = false;
+        
+        if(doc.HasMember("fast_start") && doc["fast_start"].IsTrue())
+        {
+            fast_start = true;
+        }
+        
+        for(int32 i = 1; i < argc; ++i)
+        {
+            if(std::string(argv[i]) == "--full-verify")
+            {
+                full_verify = true;
+            }
+            else
+            {
+                CONSOLE_LOG_FATAL("unknown option: %s, usage: %s [--full-verify]", argv[i], argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+
+        Blockchain::instance()->set_fast_start(fast_start, full_verify);
+
+        if(doc.HasMember("db"))
+        {
+            const rapidjson::Value &db = doc["db"];
+
+            if(!db.IsObject())
+            {
+                CONSOLE_LOG_FATAL("db field must be an object");
+                return EXIT_FAILURE;
+            }
+
+            uint64 db_cache_size = 8;
+            uint32 db_bloom_bits = 10;
+            uint64 db_write_buffer_size = 4;
+            bool db_compression = true;
+            
+            if(db.HasMember("engine"))
+            {
+                if(!db["engine"].IsString())
+                {
+                    CONSOLE_LOG_FATAL("db engine must be a string");
+                    return EXIT_FAILURE;
+                }
+
+                std::string engine = db["engine"].GetString();
+
+                if(engine == "memory")
+                {
+                    Blockchain::instance()->set_db_in_memory(true);
+                }
+                else if(engine != "leveldb")
+                {
+                    CONSOLE_LOG_FATAL("db engine must be \"leveldb\" or \"memory\"");
+                    return EXIT_FAILURE;
+                }
+            }
+            
+            if(db.HasMember("cache_size"))
+            {
+                if(!db["cache_size"].IsUint() || db["cache_size"].GetUint() == 0)
+                {
+                    CONSOLE_LOG_FATAL("db cache_size must be an unsigned integer greater than 0");
+                    return EXIT_FAILURE;
+                }
+
+                db_cache_size = db["cache_size"].GetUint();
+            }
+
+            if(db.HasMember("bloom_bits"))
+            {
+                if(!db["bloom_bits"].IsUint())
+                {
+                    CONSOLE_LOG_FATAL("db bloom_bits must be an unsigned integer");
+                    return EXIT_FAILURE;
+                }
+
+                db_bloom_bits = db["bloom_bits"].GetUint();
+            }
+
+            if(db.HasMember("write_buffer_size"))
+            {
+                if(!db["write_buffer_size"].IsUint() || db["write_buffer_size"].GetUint() == 0)
+                {
+                    CONSOLE_LOG_FATAL("db write_buffer_size must be an unsigned integer greater than 0");
+                    return EXIT_FAILURE;
+                }
+
+                db_write_buffer_size = db["write_buffer_size"].GetUint();
+            }
+
+            if(db.HasMember("compression"))
+            {
+                if(!db["compression"].IsString())
+                {
+                    CONSOLE_LOG_FATAL("db compression must be a string");
+                    return EXIT_FAILURE;
+                }
+
+                std::string compression = db["compression"].GetString();
+                
+                if(compression == "snappy")
+                {
+                    db_compression = true;
+                }
+                else if(compression == "none")
+                {
+                    db_compression = false;
+                }
+                else
+                {
+                    CONSOLE_LOG_FATAL("db compression must be \"snappy\" or \"none\"");
+                    return EXIT_FAILURE;
+                }
+            }
+
+            Blockchain::instance()->set_db_options(db_cache_size * 1024 * 1024, db_bloom_bits, db_write_buffer_size * 1024 * 1024, db_compression);
+        }
+        
+        if(doc.HasMember("block_cache_size"))
+        {
+            if(!doc["block_cache_size"].IsUint())
+            {
+                CONSOLE_LOG_FATAL("block_cache_size must be an unsigned integer");
+                return EXIT_FAILURE;
+            }
+
+            Block_Cache::instance()->set_capacity((uint64)doc["block_cache_size"].GetUint() * 1024 * 1024);
+        }
+        
+        if(doc.HasMember("prune"))
+        {
+            const rapidjson::Value &prune = doc["prune"];
+
+            if(!prune.IsObject())
+            {
+                CONSOLE_LOG_FATAL("prune field must be an object");
+                return EXIT_FAILURE;
+            }
+
+            bool prune_enable = prune.HasMember("enable") && prune["enable"].IsTrue();
+            uint64 prune_depth = BODY_PRUNE_MIN_DEPTH;
+
+            if(prune.HasMember("depth"))
+            {
+                if(!prune["depth"].IsUint() || prune["depth"].GetUint() < BODY_PRUNE_MIN_DEPTH)
+                {
+                    CONSOLE_LOG_FATAL("prune depth must be an unsigned integer not less than %u", BODY_PRUNE_MIN_DEPTH);
+                    return EXIT_FAILURE;
+                }
+
+                prune_depth = prune["depth"].GetUint();
+            }
+            
+            Blockchain::instance()->set_prune(prune_enable, prune_depth);
+        }
         
         if(!doc.HasMember("network"))
         {
@@ -388,6 +551,119 @@ public:
 
         net::api::Wsock_Node::instance()->set_max_conn(websocket_max_conn);
 
+        if(doc.HasMember("mine"))
+        {
+            const rapidjson::Value &mine = doc["mine"];
+
+            if(!mine.IsObject())
+            {
+                CONSOLE_LOG_FATAL("mine field must be an object");
+                return EXIT_FAILURE;
+            }
+            
+            if(mine.HasMember("threads"))
+            {
+                if(!mine["threads"].IsUint())
+                {
+                    CONSOLE_LOG_FATAL("mine threads must be an unsigned integer");
+                    return EXIT_FAILURE;
+                }
+
+                uint32 mine_threads = mine["threads"].GetUint();
+                
+                if(mine_threads == 0)
+                {
+                    CONSOLE_LOG_FATAL("mine threads must be greater than 0");
+                    return EXIT_FAILURE;
+                }
+
+                Blockchain::instance()->set_mine_thread_num(mine_threads);
+            }
+        }
+
+        if(doc.HasMember("verify"))
+        {
+            const rapidjson::Value &verify = doc["verify"];
+
+            if(!verify.IsObject())
+            {
+                CONSOLE_LOG_FATAL("verify field must be an object");
+                return EXIT_FAILURE;
+            }
+
+            uint32 verify_threads = 0;
+            uint32 verify_pow_threads = 0;
+            
+            if(verify.HasMember("threads"))
+            {
+                if(!verify["threads"].IsUint())
+                {
+                    CONSOLE_LOG_FATAL("verify threads must be an unsigned integer");
+                    return EXIT_FAILURE;
+                }
+
+                verify_threads = verify["threads"].GetUint();
+                
+                if(verify_threads == 0)
+                {
+                    CONSOLE_LOG_FATAL("verify threads must be greater than 0");
+                    return EXIT_FAILURE;
+                }
+            }
+
+            if(verify.HasMember("pow_threads"))
+            {
+                if(!verify["pow_threads"].IsUint())
+                {
+                    CONSOLE_LOG_FATAL("verify pow_threads must be an unsigned integer");
+                    return EXIT_FAILURE;
+                }
+
+                verify_pow_threads = verify["pow_threads"].GetUint();
+                
+                if(verify_pow_threads == 0)
+                {
+                    CONSOLE_LOG_FATAL("verify pow_threads must be greater than 0");
+                    return EXIT_FAILURE;
+                }
+            }
+            
+            Verify_Pool::instance()->set_thread_num(verify_threads, verify_pow_threads);
+        }
+
+        std::string asic_data_share_path;
+        
+        if(doc.HasMember("asic_data"))
+        {
+            const rapidjson::Value &asic_data = doc["asic_data"];
+
+            if(!asic_data.IsObject())
+            {
+                CONSOLE_LOG_FATAL("asic_data field must be an object");
+                return EXIT_FAILURE;
+            }
+
+            if(asic_data.HasMember("share_path"))
+            {
+                if(!asic_data["share_path"].IsString())
+                {
+                    CONSOLE_LOG_FATAL("asic_data share_path must be a string");
+                    return EXIT_FAILURE;
+                }
+                
+                asic_data_share_path = asic_data["share_path"].GetString();
+            }
+        }
+
+        std::string asic_data_backing = asic_resistant_load(asic_data_share_path);
+        CONSOLE_LOG_INFO("asic resistant data backing: %s", asic_data_backing.c_str());
+        
+        Verify_Pool::instance()->start();
+        fly::base::Scope_CB scope_cb([] {
+            Verify_Pool::instance()->stop();
+            Verify_Pool::instance()->wait();
+        });
+        
         if(!Blockchain::instance()->start(doc["db_path"].GetString(), repair_db))
         {
             CONSOLE_LOG_FATAL("load from leveldb failed");
@@ -439,6 +715,8 @@ public:
             ">enable_mine [true|false]\n"
             ">info\n"
             ">myinfo\n"
+            ">db_stats\n"
+            ">merge_export [block_id] [export_path]\n"
             ">help\n"
             "\nfor example, if you want to stop askcoin, yout can input 'stop' command:";
 
@@ -583,6 +861,22 @@ public:
                         continue;
                     }
                 }
+                else if(cmd == "db_stats")
+                {
+                    if(param_num > 0)
+                    {
+                        cout << "db_stats doesn't need any param" << endl;
+                        continue;
+                    }
+                }
+                else if(cmd == "merge_export")
+                {
+                    if(param_num != 2)
+                    {
+                        cout << "usage: merge_export [block_id] [export_path]" << endl;
+                        continue;
+                    }
+                }
                 else if(cmd == "myinfo")
                 {
                     if(param_num > 0)
@@ -657,7 +951,7 @@ public:
     }
 };
 
-int main()
+int main(int argc, char **argv)
 {
-    return Askcoin::instance()->main();
+    return Askcoin::instance()->main(argc, argv);
 }
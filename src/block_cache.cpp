@@ -0,0 +1,111 @@
+#include "block_cache.hpp"
+
+Block_Cache::Block_Cache()
+{
+}
+
+void Block_Cache::set_capacity(uint64 capacity)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_capacity = capacity;
+    evict();
+}
+
+bool Block_Cache::get(const std::string &block_hash, std::shared_ptr<const rapidjson::Document> &doc)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_map.find(block_hash);
+
+    if(iter == m_map.end())
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        
+        return false;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, iter->second);
+    doc = iter->second->m_doc;
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    
+    return true;
+}
+
+void Block_Cache::put(const std::string &block_hash, std::shared_ptr<const rapidjson::Document> doc, uint64 size)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    if(size > m_capacity)
+    {
+        return;
+    }
+    
+    auto iter = m_map.find(block_hash);
+
+    if(iter != m_map.end())
+    {
+        m_lru.splice(m_lru.begin(), m_lru, iter->second);
+        
+        return;
+    }
+
+    m_lru.push_front(Entry {block_hash, doc, size});
+    m_map[block_hash] = m_lru.begin();
+    m_bytes += size;
+    evict();
+}
+
+void Block_Cache::erase(const std::string &block_hash)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_map.find(block_hash);
+
+    if(iter == m_map.end())
+    {
+        return;
+    }
+
+    m_bytes -= iter->second->m_size;
+    m_lru.erase(iter->second);
+    m_map.erase(iter);
+}
+
+void Block_Cache::evict()
+{
+    while(m_bytes > m_capacity)
+    {
+        m_bytes -= m_lru.back().m_size;
+        m_map.erase(m_lru.back().m_block_hash);
+        m_lru.pop_back();
+    }
+}
+
+uint64 Block_Cache::hits() const
+{
+    return m_hits.load(std::memory_order_relaxed);
+}
+
+uint64 Block_Cache::misses() const
+{
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+uint64 Block_Cache::bytes()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    
+    return m_bytes;
+}
+
+uint64 Block_Cache::capacity()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    
+    return m_capacity;
+}
+
+uint32 Block_Cache::size()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    
+    return m_lru.size();
+}
@@ -0,0 +1,50 @@
+#ifndef BLOCK_CACHE
+#define BLOCK_CACHE
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "fly/base/common.hpp"
+#include "fly/base/singleton.hpp"
+#include "rapidjson/document.h"
+
+// decoded block records keyed by block hash. a record never changes once it is
+// written, so one decoded document is shared read-only by every reader. the fork
+// pruner, which deletes or rewrites records, erases them here as well. the cache
+// is bounded by the approximate memory of the documents, not by count.
+class Block_Cache : public fly::base::Singleton<Block_Cache>
+{
+public:
+    Block_Cache();
+    void set_capacity(uint64 capacity);
+    bool get(const std::string &block_hash, std::shared_ptr<const rapidjson::Document> &doc);
+    void put(const std::string &block_hash, std::shared_ptr<const rapidjson::Document> doc, uint64 size);
+    void erase(const std::string &block_hash);
+    uint64 hits() const;
+    uint64 misses() const;
+    uint64 bytes();
+    uint64 capacity();
+    uint32 size();
+
+private:
+    struct Entry
+    {
+        std::string m_block_hash;
+        std::shared_ptr<const rapidjson::Document> m_doc;
+        uint64 m_size;
+    };
+
+    void evict();
+    uint64 m_capacity = 64 * 1024 * 1024;
+    uint64 m_bytes = 0;
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_map;
+    std::mutex m_mutex;
+    std::atomic<uint64> m_hits{0};
+    std::atomic<uint64> m_misses{0};
+};
+
+#endif
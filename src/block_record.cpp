@@ -0,0 +1,1315 @@
+#include <endian.h>
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "serialize.h"
+#include "block_record.hpp"
+
+namespace
+{
+
+enum TAG
+{
+    TAG_NULL = 0,
+    TAG_FALSE,
+    TAG_TRUE,
+    TAG_UINT64,
+    TAG_INT64,
+    TAG_DOUBLE,
+    TAG_STRING,
+    TAG_BASE64,
+    TAG_ARRAY,
+    TAG_OBJECT
+};
+
+// member names are stored as their index + 1 in this table, 0 means the name follows inline.
+// the table is part of BLOCK_RECORD_VERSION, only append to it together with a version bump.
+const char* const KEYS[] = {
+    "hash", "sign", "data", "tx", "children", "id", "utc", "version", "zero_bits", "pre_hash",
+    "miner", "tx_ids", "nonce", "type", "pubkey", "fee", "block_id", "amount", "receiver", "memo",
+    "referrer", "name", "avatar", "sign_data", "topic_key", "topic", "reply_to", "reply", "reward"
+};
+
+const uint32 KEY_NUM = sizeof(KEYS) / sizeof(KEYS[0]);
+const uint32 MAX_DEPTH = 32;
+
+// the member order of the block data which version 2 rebuilds, a pruned header has the first 6
+const char* const DATA_KEYS[] = {"id", "utc", "version", "zero_bits", "pre_hash", "miner", "tx_ids", "nonce"};
+const char* const BLOCK_KEYS[] = {"hash", "sign", "data", "tx", "children"};
+const char* const PRUNED_KEYS[] = {"hash", "sign", "data", "tx_num", "pruned", "children"};
+const uint8 BLOCK_RECORD_VERSION_1 = 1;
+
+class Record_Writer
+{
+public:
+    Record_Writer(std::string &buf)
+        : m_buf(buf)
+    {
+    }
+
+    void write(const char *data, size_t len)
+    {
+        m_buf.append(data, len);
+    }
+
+private:
+    std::string &m_buf;
+};
+
+class Record_Reader
+{
+public:
+    Record_Reader(const std::string &buf, uint64 pos)
+        : m_buf(buf), m_pos(pos)
+    {
+    }
+
+    void read(char *data, size_t len)
+    {
+        if(m_pos + len > m_buf.length())
+        {
+            throw std::ios_base::failure("block record is truncated");
+        }
+
+        memcpy(data, m_buf.data() + m_pos, len);
+        m_pos += len;
+    }
+
+    const char* take(size_t len)
+    {
+        if(m_pos + len > m_buf.length())
+        {
+            throw std::ios_base::failure("block record is truncated");
+        }
+
+        const char *p = m_buf.data() + m_pos;
+        m_pos += len;
+
+        return p;
+    }
+
+    bool eof() const
+    {
+        return m_pos == m_buf.length();
+    }
+
+    uint64 pos() const
+    {
+        return m_pos;
+    }
+
+    std::string slice(uint64 start) const
+    {
+        return m_buf.substr(start, m_pos - start);
+    }
+
+private:
+    const std::string &m_buf;
+    uint64 m_pos;
+};
+
+// only strings which come back byte for byte from their decoded form are stored raw
+bool base64_raw(const char *str, uint32 len, std::string &raw)
+{
+    if(len == 0 || len % 4 != 0)
+    {
+        return false;
+    }
+
+    for(uint32 i = 0; i < len; ++i)
+    {
+        char c = str[i];
+
+        if(!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '='))
+        {
+            return false;
+        }
+    }
+
+    raw.resize(len / 4 * 3);
+    uint32 raw_len = fly::base::base64_decode(str, len, &raw[0], raw.length());
+    raw.resize(raw_len);
+
+    if(raw_len == 0)
+    {
+        return false;
+    }
+
+    return fly::base::base64_encode(raw.data(), raw_len) == std::string(str, len);
+}
+
+void write_string(Record_Writer &w, const char *str, uint32 len)
+{
+    WriteCompactSize(w, len);
+    w.write(str, len);
+}
+
+void encode_value(Record_Writer &w, const rapidjson::Value &v)
+{
+    if(v.IsNull())
+    {
+        ser_writedata8(w, TAG_NULL);
+    }
+    else if(v.IsFalse())
+    {
+        ser_writedata8(w, TAG_FALSE);
+    }
+    else if(v.IsTrue())
+    {
+        ser_writedata8(w, TAG_TRUE);
+    }
+    else if(v.IsDouble())
+    {
+        ser_writedata8(w, TAG_DOUBLE);
+        ser_writedata64(w, ser_double_to_uint64(v.GetDouble()));
+    }
+    else if(v.IsUint64())
+    {
+        ser_writedata8(w, TAG_UINT64);
+        ser_writedata64(w, v.GetUint64());
+    }
+    else if(v.IsInt64())
+    {
+        ser_writedata8(w, TAG_INT64);
+        ser_writedata64(w, (uint64)v.GetInt64());
+    }
+    else if(v.IsString())
+    {
+        std::string raw;
+
+        if(base64_raw(v.GetString(), v.GetStringLength(), raw))
+        {
+            ser_writedata8(w, TAG_BASE64);
+            write_string(w, raw.data(), raw.length());
+        }
+        else
+        {
+            ser_writedata8(w, TAG_STRING);
+            write_string(w, v.GetString(), v.GetStringLength());
+        }
+    }
+    else if(v.IsArray())
+    {
+        ser_writedata8(w, TAG_ARRAY);
+        WriteCompactSize(w, v.Size());
+
+        for(rapidjson::SizeType i = 0; i < v.Size(); ++i)
+        {
+            encode_value(w, v[i]);
+        }
+    }
+    else
+    {
+        ser_writedata8(w, TAG_OBJECT);
+        WriteCompactSize(w, v.MemberCount());
+
+        for(rapidjson::Value::ConstMemberIterator iter = v.MemberBegin(); iter != v.MemberEnd(); ++iter)
+        {
+            const char *name = iter->name.GetString();
+            uint32 key_idx = 0;
+
+            for(uint32 i = 0; i < KEY_NUM; ++i)
+            {
+                if(strcmp(KEYS[i], name) == 0)
+                {
+                    key_idx = i + 1;
+                    break;
+                }
+            }
+
+            ser_writedata8(w, key_idx);
+
+            if(key_idx == 0)
+            {
+                write_string(w, name, iter->name.GetStringLength());
+            }
+
+            encode_value(w, iter->value);
+        }
+    }
+}
+
+void decode_value(Record_Reader &r, rapidjson::Value &v, rapidjson::Document::AllocatorType &allocator, uint32 depth)
+{
+    if(depth > MAX_DEPTH)
+    {
+        throw std::ios_base::failure("block record is too deep");
+    }
+
+    uint8 tag = ser_readdata8(r);
+
+    if(tag == TAG_NULL)
+    {
+        v.SetNull();
+    }
+    else if(tag == TAG_FALSE)
+    {
+        v.SetBool(false);
+    }
+    else if(tag == TAG_TRUE)
+    {
+        v.SetBool(true);
+    }
+    else if(tag == TAG_UINT64)
+    {
+        v.SetUint64(ser_readdata64(r));
+    }
+    else if(tag == TAG_INT64)
+    {
+        v.SetInt64((int64)ser_readdata64(r));
+    }
+    else if(tag == TAG_DOUBLE)
+    {
+        v.SetDouble(ser_uint64_to_double(ser_readdata64(r)));
+    }
+    else if(tag == TAG_STRING)
+    {
+        uint64 len = ReadCompactSize(r);
+        v.SetString(r.take(len), len, allocator);
+    }
+    else if(tag == TAG_BASE64)
+    {
+        uint64 len = ReadCompactSize(r);
+        std::string b64 = fly::base::base64_encode(r.take(len), len);
+        v.SetString(b64.data(), b64.length(), allocator);
+    }
+    else if(tag == TAG_ARRAY)
+    {
+        uint64 num = ReadCompactSize(r);
+        v.SetArray();
+
+        for(uint64 i = 0; i < num; ++i)
+        {
+            rapidjson::Value elem;
+            decode_value(r, elem, allocator, depth + 1);
+            v.PushBack(elem, allocator);
+        }
+    }
+    else if(tag == TAG_OBJECT)
+    {
+        uint64 num = ReadCompactSize(r);
+        v.SetObject();
+
+        for(uint64 i = 0; i < num; ++i)
+        {
+            uint8 key_idx = ser_readdata8(r);
+            rapidjson::Value name;
+
+            if(key_idx == 0)
+            {
+                uint64 len = ReadCompactSize(r);
+                name.SetString(r.take(len), len, allocator);
+            }
+            else if(key_idx <= KEY_NUM)
+            {
+                name.SetString(rapidjson::StringRef(KEYS[key_idx - 1]));
+            }
+            else
+            {
+                throw std::ios_base::failure("block record has an unknown member name");
+            }
+
+            rapidjson::Value value;
+            decode_value(r, value, allocator, depth + 1);
+            v.AddMember(name, value, allocator);
+        }
+    }
+    else
+    {
+        throw std::ios_base::failure("block record has an unknown tag");
+    }
+}
+
+std::string read_string(Record_Reader &r)
+{
+    uint64 len = ReadCompactSize(r);
+
+    return std::string(r.take(len), len);
+}
+
+const char* read_name(Record_Reader &r, std::string &buf)
+{
+    uint8 key_idx = ser_readdata8(r);
+
+    if(key_idx == 0)
+    {
+        buf = read_string(r);
+
+        return buf.c_str();
+    }
+
+    if(key_idx > KEY_NUM)
+    {
+        throw std::ios_base::failure("block record has an unknown member name");
+    }
+
+    return KEYS[key_idx - 1];
+}
+
+void skip_value(Record_Reader &r, uint32 depth);
+
+// skips the value whose tag was read already
+void skip_body(Record_Reader &r, uint8 tag, uint32 depth)
+{
+    if(depth > MAX_DEPTH)
+    {
+        throw std::ios_base::failure("block record is too deep");
+    }
+
+    if(tag == TAG_NULL || tag == TAG_FALSE || tag == TAG_TRUE)
+    {
+        return;
+    }
+
+    if(tag == TAG_UINT64 || tag == TAG_INT64 || tag == TAG_DOUBLE)
+    {
+        r.take(8);
+    }
+    else if(tag == TAG_STRING || tag == TAG_BASE64)
+    {
+        r.take(ReadCompactSize(r));
+    }
+    else if(tag == TAG_ARRAY)
+    {
+        uint64 num = ReadCompactSize(r);
+
+        for(uint64 i = 0; i < num; ++i)
+        {
+            skip_value(r, depth + 1);
+        }
+    }
+    else if(tag == TAG_OBJECT)
+    {
+        uint64 num = ReadCompactSize(r);
+        std::string buf;
+
+        for(uint64 i = 0; i < num; ++i)
+        {
+            read_name(r, buf);
+            skip_value(r, depth + 1);
+        }
+    }
+    else
+    {
+        throw std::ios_base::failure("block record has an unknown tag");
+    }
+}
+
+void skip_value(Record_Reader &r, uint32 depth)
+{
+    skip_body(r, ser_readdata8(r), depth);
+}
+
+// integers and strings are returned, base64 as its text, anything else is skipped
+void read_scalar(Record_Reader &r, uint8 tag, uint64 &num, std::string &str)
+{
+    if(tag == TAG_UINT64 || tag == TAG_INT64)
+    {
+        num = ser_readdata64(r);
+    }
+    else if(tag == TAG_STRING)
+    {
+        str = read_string(r);
+    }
+    else if(tag == TAG_BASE64)
+    {
+        uint64 len = ReadCompactSize(r);
+        str = fly::base::base64_encode(r.take(len), len);
+    }
+    else
+    {
+        skip_body(r, tag, 1);
+    }
+}
+
+// writes the tagged value as rapidjson::Writer writes the decoded document, byte for byte
+void write_json(Record_Reader &r, rapidjson::Writer<rapidjson::StringBuffer> &writer, uint32 depth)
+{
+    if(depth > MAX_DEPTH)
+    {
+        throw std::ios_base::failure("block record is too deep");
+    }
+
+    uint8 tag = ser_readdata8(r);
+
+    if(tag == TAG_NULL)
+    {
+        writer.Null();
+    }
+    else if(tag == TAG_FALSE)
+    {
+        writer.Bool(false);
+    }
+    else if(tag == TAG_TRUE)
+    {
+        writer.Bool(true);
+    }
+    else if(tag == TAG_UINT64)
+    {
+        writer.Uint64(ser_readdata64(r));
+    }
+    else if(tag == TAG_INT64)
+    {
+        writer.Int64((int64)ser_readdata64(r));
+    }
+    else if(tag == TAG_DOUBLE)
+    {
+        writer.Double(ser_uint64_to_double(ser_readdata64(r)));
+    }
+    else if(tag == TAG_STRING)
+    {
+        uint64 len = ReadCompactSize(r);
+        writer.String(r.take(len), len);
+    }
+    else if(tag == TAG_BASE64)
+    {
+        uint64 len = ReadCompactSize(r);
+        std::string b64 = fly::base::base64_encode(r.take(len), len);
+        writer.String(b64.data(), b64.length());
+    }
+    else if(tag == TAG_ARRAY)
+    {
+        uint64 num = ReadCompactSize(r);
+        writer.StartArray();
+
+        for(uint64 i = 0; i < num; ++i)
+        {
+            write_json(r, writer, depth + 1);
+        }
+
+        writer.EndArray(num);
+    }
+    else if(tag == TAG_OBJECT)
+    {
+        uint64 num = ReadCompactSize(r);
+        std::string buf;
+        writer.StartObject();
+
+        for(uint64 i = 0; i < num; ++i)
+        {
+            const char *name = read_name(r, buf);
+            writer.Key(name, strlen(name));
+            write_json(r, writer, depth + 1);
+        }
+
+        writer.EndObject(num);
+    }
+    else
+    {
+        throw std::ios_base::failure("block record has an unknown tag");
+    }
+}
+
+std::string to_json(const rapidjson::Value &v)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    v.Accept(writer);
+
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+bool has_members(const rapidjson::Value &v, const char* const names[], uint32 num)
+{
+    if(v.MemberCount() != num)
+    {
+        return false;
+    }
+
+    uint32 i = 0;
+
+    for(rapidjson::Value::ConstMemberIterator iter = v.MemberBegin(); iter != v.MemberEnd(); ++iter, ++i)
+    {
+        if(strcmp(iter->name.GetString(), names[i]) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool is_base64_char(const rapidjson::Value &v)
+{
+    if(!v.IsString())
+    {
+        return false;
+    }
+
+    const char *str = v.GetString();
+
+    for(uint32 i = 0; i < v.GetStringLength(); ++i)
+    {
+        char c = str[i];
+
+        if(!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '='))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the raw bytes of a base64 string, false if they do not give back the same string
+bool to_raw(const rapidjson::Value &v, std::string &raw)
+{
+    if(base64_raw(v.GetString(), v.GetStringLength(), raw))
+    {
+        return true;
+    }
+
+    raw.resize(v.GetStringLength() / 4 * 3 + 3);
+    raw.resize(fly::base::base64_decode(v.GetString(), v.GetStringLength(), &raw[0], raw.length()));
+
+    return false;
+}
+
+void read_tx_data(Record_Reader &r, Block_Record::Tx &tx)
+{
+    if(ser_readdata8(r) != TAG_OBJECT)
+    {
+        throw std::ios_base::failure("block record has a tx without data");
+    }
+
+    uint64 num = ReadCompactSize(r);
+    std::string buf;
+
+    for(uint64 i = 0; i < num; ++i)
+    {
+        const char *name = read_name(r, buf);
+        uint8 tag = ser_readdata8(r);
+        uint64 n = 0;
+        std::string str;
+
+        if(strcmp(name, "sign_data") == 0 && tag == TAG_OBJECT)
+        {
+            uint64 num_1 = ReadCompactSize(r);
+            std::string buf_1;
+
+            for(uint64 j = 0; j < num_1; ++j)
+            {
+                const char *name_1 = read_name(r, buf_1);
+                std::string str_1;
+                read_scalar(r, ser_readdata8(r), n, str_1);
+
+                if(strcmp(name_1, "name") == 0)
+                {
+                    tx.m_name = str_1;
+                }
+                else if(strcmp(name_1, "referrer") == 0)
+                {
+                    tx.m_referrer = str_1;
+                }
+            }
+
+            continue;
+        }
+
+        read_scalar(r, tag, n, str);
+
+        if(strcmp(name, "type") == 0)
+        {
+            tx.m_type = n;
+        }
+        else if(strcmp(name, "utc") == 0)
+        {
+            tx.m_utc = n;
+        }
+        else if(strcmp(name, "block_id") == 0)
+        {
+            tx.m_block_id = n;
+        }
+        else if(strcmp(name, "fee") == 0)
+        {
+            tx.m_fee = n;
+        }
+        else if(strcmp(name, "pubkey") == 0)
+        {
+            tx.m_pubkey = str;
+        }
+        else if(strcmp(name, "avatar") == 0)
+        {
+            tx.m_avatar = n;
+        }
+        else if(strcmp(name, "receiver") == 0)
+        {
+            tx.m_receiver = str;
+        }
+        else if(strcmp(name, "amount") == 0)
+        {
+            tx.m_amount = n;
+        }
+        else if(strcmp(name, "reward") == 0)
+        {
+            tx.m_reward = n;
+        }
+        else if(strcmp(name, "topic") == 0)
+        {
+            tx.m_topic = str;
+        }
+        else if(strcmp(name, "topic_key") == 0)
+        {
+            tx.m_topic_key = str;
+        }
+        else if(strcmp(name, "reply_to") == 0)
+        {
+            tx.m_reply_to = str;
+        }
+        else if(strcmp(name, "reply") == 0)
+        {
+            tx.m_reply = str;
+        }
+    }
+}
+
+uint64 get_uint64(const rapidjson::Value &v, const char *name)
+{
+    rapidjson::Value::ConstMemberIterator iter = v.FindMember(name);
+
+    if(iter == v.MemberEnd() || !iter->value.IsUint64())
+    {
+        return 0;
+    }
+
+    return iter->value.GetUint64();
+}
+
+std::string get_string(const rapidjson::Value &v, const char *name)
+{
+    rapidjson::Value::ConstMemberIterator iter = v.FindMember(name);
+
+    if(iter == v.MemberEnd() || !iter->value.IsString())
+    {
+        return std::string();
+    }
+
+    return std::string(iter->value.GetString(), iter->value.GetStringLength());
+}
+
+// the header and the txs of a version 2 record, txs is NULL to stop after the header
+void read_block(Record_Reader &r, Block_Record::Header &header, std::vector<Block_Record::Tx> *txs)
+{
+    header.m_hash.assign(r.take(32), 32);
+    header.m_sign = read_string(r);
+    header.m_pruned = ser_readdata8(r) != 0;
+    header.m_id = ser_readdata64(r);
+    header.m_utc = ser_readdata64(r);
+    header.m_version = ser_readdata32(r);
+    header.m_zero_bits = ser_readdata32(r);
+    header.m_pre_hash.assign(r.take(32), 32);
+    std::string miner = read_string(r);
+    header.m_miner = fly::base::base64_encode(miner.data(), miner.length());
+
+    if(header.m_pruned)
+    {
+        header.m_tx_num = ser_readdata32(r);
+    }
+    else
+    {
+        uint64 tx_num = ReadCompactSize(r);
+        header.m_tx_num = tx_num;
+        header.m_tx_ids.resize(tx_num);
+
+        for(uint64 i = 0; i < tx_num; ++i)
+        {
+            header.m_tx_ids[i].assign(r.take(32), 32);
+        }
+
+        for(uint32 i = 0; i < 4; ++i)
+        {
+            header.m_nonce[i] = ser_readdata64(r);
+        }
+    }
+
+    uint64 child_num = ReadCompactSize(r);
+    header.m_children.resize(child_num);
+
+    for(uint64 i = 0; i < child_num; ++i)
+    {
+        header.m_children[i].assign(r.take(32), 32);
+    }
+
+    if(txs == NULL)
+    {
+        return;
+    }
+
+    txs->clear();
+    txs->resize(header.m_pruned ? 0 : header.m_tx_num);
+
+    for(auto &tx : *txs)
+    {
+        tx.m_sign = read_string(r);
+        uint64 start = r.pos();
+        read_tx_data(r, tx);
+        tx.m_data = r.slice(start);
+        tx.m_data_is_json = false;
+    }
+
+    if(!r.eof())
+    {
+        throw std::ios_base::failure("block record has trailing bytes");
+    }
+}
+
+// the version 2 layout, false if the block does not fit it exactly
+bool encode_block(const rapidjson::Value &doc, std::string &record)
+{
+    Block_Record::Header header;
+
+    if(!Block_Record::header_from_doc(doc, header) || !header.m_data_json.empty())
+    {
+        return false;
+    }
+
+    if(!has_members(doc, header.m_pruned ? PRUNED_KEYS : BLOCK_KEYS, header.m_pruned ? 6 : 5))
+    {
+        return false;
+    }
+
+    const rapidjson::Value &data = doc["data"];
+    std::string miner;
+    std::string raw;
+
+    if(!base64_raw(data["miner"].GetString(), data["miner"].GetStringLength(), miner) || !to_raw(doc["sign"], raw))
+    {
+        return false;
+    }
+
+    if(header.m_pruned && (!doc["pruned"].IsTrue() || !has_members(data, DATA_KEYS, 6)))
+    {
+        return false;
+    }
+
+    // the safety net of the rebuilt data, the block hash covers it
+    if(header.data_json() != to_json(data))
+    {
+        return false;
+    }
+
+    const rapidjson::Value &children = doc["children"];
+
+    for(rapidjson::SizeType i = 0; i < children.Size(); ++i)
+    {
+        if(!children[i].IsString() || !to_raw(children[i], raw) || raw.length() != 32)
+        {
+            return false;
+        }
+    }
+
+    std::vector<std::string> tx_signs;
+
+    if(!header.m_pruned)
+    {
+        const rapidjson::Value &tx = doc["tx"];
+
+        for(rapidjson::SizeType i = 0; i < tx.Size(); ++i)
+        {
+            const rapidjson::Value &tx_node = tx[i];
+
+            if(!tx_node.IsObject() || !has_members(tx_node, BLOCK_KEYS + 1, 2) || !tx_node["sign"].IsString() \
+               || !tx_node["data"].IsObject() || !to_raw(tx_node["sign"], raw))
+            {
+                return false;
+            }
+
+            tx_signs.push_back(raw);
+        }
+    }
+
+    record.clear();
+    Record_Writer w(record);
+    ser_writedata8(w, BLOCK_RECORD_VERSION);
+    w.write(header.m_hash.data(), 32);
+    write_string(w, header.m_sign.data(), header.m_sign.length());
+    ser_writedata8(w, header.m_pruned ? 1 : 0);
+    ser_writedata64(w, header.m_id);
+    ser_writedata64(w, header.m_utc);
+    ser_writedata32(w, header.m_version);
+    ser_writedata32(w, header.m_zero_bits);
+    w.write(header.m_pre_hash.data(), 32);
+    write_string(w, miner.data(), miner.length());
+
+    if(header.m_pruned)
+    {
+        ser_writedata32(w, header.m_tx_num);
+    }
+    else
+    {
+        WriteCompactSize(w, header.m_tx_ids.size());
+
+        for(auto &tx_id : header.m_tx_ids)
+        {
+            w.write(tx_id.data(), 32);
+        }
+
+        for(uint32 i = 0; i < 4; ++i)
+        {
+            ser_writedata64(w, header.m_nonce[i]);
+        }
+    }
+
+    WriteCompactSize(w, header.m_children.size());
+
+    for(auto &child : header.m_children)
+    {
+        w.write(child.data(), 32);
+    }
+
+    if(!header.m_pruned)
+    {
+        const rapidjson::Value &tx = doc["tx"];
+
+        for(rapidjson::SizeType i = 0; i < tx.Size(); ++i)
+        {
+            write_string(w, tx_signs[i].data(), tx_signs[i].length());
+            encode_value(w, tx[i]["data"]);
+        }
+    }
+
+    return true;
+}
+
+void decode_doc(const std::string &record, rapidjson::Document &doc)
+{
+    Block_Record::Header header;
+    std::vector<Block_Record::Tx> txs;
+    Record_Reader r(record, 1);
+    read_block(r, header, &txs);
+    rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
+    std::string hash = fly::base::base64_encode(header.m_hash.data(), 32);
+    std::string sign = fly::base::base64_encode(header.m_sign.data(), header.m_sign.length());
+    doc.SetObject();
+    doc.AddMember("hash", rapidjson::Value(hash.c_str(), allocator), allocator);
+    doc.AddMember("sign", rapidjson::Value(sign.c_str(), allocator), allocator);
+    rapidjson::Value data;
+    header.data_value(data, allocator);
+    doc.AddMember("data", data, allocator);
+
+    if(header.m_pruned)
+    {
+        doc.AddMember("tx_num", header.m_tx_num, allocator);
+        doc.AddMember("pruned", true, allocator);
+    }
+    else
+    {
+        rapidjson::Value tx_arr(rapidjson::kArrayType);
+
+        for(auto &tx : txs)
+        {
+            std::string tx_sign = fly::base::base64_encode(tx.m_sign.data(), tx.m_sign.length());
+            Record_Reader r_1(tx.m_data, 0);
+            rapidjson::Value tx_node(rapidjson::kObjectType);
+            rapidjson::Value tx_data;
+            decode_value(r_1, tx_data, allocator, 1);
+            tx_node.AddMember("sign", rapidjson::Value(tx_sign.c_str(), allocator), allocator);
+            tx_node.AddMember("data", tx_data, allocator);
+            tx_arr.PushBack(tx_node, allocator);
+        }
+
+        doc.AddMember("tx", tx_arr, allocator);
+    }
+
+    rapidjson::Value children(rapidjson::kArrayType);
+
+    for(auto &child : header.m_children)
+    {
+        std::string b64 = fly::base::base64_encode(child.data(), 32);
+        children.PushBack(rapidjson::Value(b64.c_str(), allocator), allocator);
+    }
+
+    doc.AddMember("children", children, allocator);
+}
+
+}
+
+void Block_Record::encode(const rapidjson::Value &doc, std::string &record)
+{
+    if(encode_block(doc, record))
+    {
+        return;
+    }
+
+    record.clear();
+    Record_Writer w(record);
+    ser_writedata8(w, BLOCK_RECORD_VERSION_1);
+    encode_value(w, doc);
+}
+
+bool Block_Record::is_json(const std::string &record)
+{
+    return !record.empty() && record[0] == '{';
+}
+
+bool Block_Record::is_current(const std::string &record)
+{
+    return !record.empty() && (uint8)record[0] == BLOCK_RECORD_VERSION;
+}
+
+bool Block_Record::decode(const std::string &record, rapidjson::Document &doc)
+{
+    if(is_json(record))
+    {
+        doc.Parse(record.c_str());
+
+        return !doc.HasParseError();
+    }
+
+    if(record.empty())
+    {
+        return false;
+    }
+
+    try
+    {
+        if((uint8)record[0] == BLOCK_RECORD_VERSION)
+        {
+            decode_doc(record, doc);
+
+            return true;
+        }
+
+        if((uint8)record[0] != BLOCK_RECORD_VERSION_1)
+        {
+            return false;
+        }
+
+        Record_Reader r(record, 1);
+        decode_value(r, doc, doc.GetAllocator(), 0);
+
+        return r.eof();
+    }
+    catch(const std::ios_base::failure &)
+    {
+        return false;
+    }
+}
+
+bool Block_Record::decode_header(const std::string &record, Header &header)
+{
+    if(is_current(record))
+    {
+        try
+        {
+            Record_Reader r(record, 1);
+            read_block(r, header, NULL);
+        }
+        catch(const std::ios_base::failure &)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    rapidjson::Document doc;
+
+    return decode(record, doc) && header_from_doc(doc, header);
+}
+
+bool Block_Record::decode_block(const std::string &record, Header &header, std::vector<Tx> &txs)
+{
+    if(is_current(record))
+    {
+        try
+        {
+            Record_Reader r(record, 1);
+            read_block(r, header, &txs);
+        }
+        catch(const std::ios_base::failure &)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    rapidjson::Document doc;
+
+    return decode(record, doc) && header_from_doc(doc, header) && txs_from_doc(doc, txs);
+}
+
+bool Block_Record::header_from_doc(const rapidjson::Value &doc, Header &header)
+{
+    if(!doc.IsObject() || !doc.HasMember("hash") || !doc.HasMember("sign") || !doc.HasMember("data") || !doc.HasMember("children"))
+    {
+        return false;
+    }
+
+    const rapidjson::Value &hash = doc["hash"];
+    const rapidjson::Value &sign = doc["sign"];
+    const rapidjson::Value &data = doc["data"];
+
+    if(!is_base64_char(hash) || hash.GetStringLength() != 44 || !is_base64_char(sign) || !data.IsObject() || !doc["children"].IsArray())
+    {
+        return false;
+    }
+
+    header.m_pruned = doc.HasMember("pruned");
+
+    if(header.m_pruned ? !doc.HasMember("tx_num") || !doc["tx_num"].IsUint() : !doc.HasMember("tx") || !doc["tx"].IsArray())
+    {
+        return false;
+    }
+
+    if(data.MemberCount() != (header.m_pruned ? 6 : 8))
+    {
+        return false;
+    }
+
+    if(!data.HasMember("id") || !data["id"].IsUint64() || !data.HasMember("utc") || !data["utc"].IsUint64() \
+       || !data.HasMember("version") || !data["version"].IsUint() || !data.HasMember("zero_bits") || !data["zero_bits"].IsUint() \
+       || !data.HasMember("pre_hash") || !is_base64_char(data["pre_hash"]) || !data.HasMember("miner") || !is_base64_char(data["miner"]))
+    {
+        return false;
+    }
+
+    // an old record rebuilds the same json only if it is in the order and form the node writes
+    bool canonical = has_members(data, DATA_KEYS, header.m_pruned ? 6 : 8);
+    std::string raw;
+    canonical = to_raw(hash, header.m_hash) && header.m_hash.length() == 32 && canonical;
+    to_raw(sign, header.m_sign);
+    canonical = to_raw(data["pre_hash"], header.m_pre_hash) && header.m_pre_hash.length() == 32 && canonical;
+    header.m_id = data["id"].GetUint64();
+    header.m_utc = data["utc"].GetUint64();
+    header.m_version = data["version"].GetUint();
+    header.m_zero_bits = data["zero_bits"].GetUint();
+    header.m_miner.assign(data["miner"].GetString(), data["miner"].GetStringLength());
+    header.m_tx_ids.clear();
+    header.m_children.clear();
+    header.m_data_json.clear();
+
+    if(header.m_pruned)
+    {
+        header.m_tx_num = doc["tx_num"].GetUint();
+    }
+    else
+    {
+        if(!data.HasMember("tx_ids") || !data["tx_ids"].IsArray() || !data.HasMember("nonce") || !data["nonce"].IsArray())
+        {
+            return false;
+        }
+
+        const rapidjson::Value &tx_ids = data["tx_ids"];
+        const rapidjson::Value &nonce = data["nonce"];
+
+        if(tx_ids.Size() != doc["tx"].Size() || nonce.Size() != 4)
+        {
+            return false;
+        }
+
+        for(rapidjson::SizeType i = 0; i < tx_ids.Size(); ++i)
+        {
+            const rapidjson::Value &tx_id = tx_ids[i];
+
+            if(!is_base64_char(tx_id) || tx_id.GetStringLength() != 44)
+            {
+                return false;
+            }
+
+            canonical = to_raw(tx_id, raw) && raw.length() == 32 && canonical;
+            header.m_tx_ids.push_back(raw);
+        }
+
+        for(uint32 i = 0; i < 4; ++i)
+        {
+            if(!nonce[i].IsUint64())
+            {
+                return false;
+            }
+
+            header.m_nonce[i] = nonce[i].GetUint64();
+        }
+
+        header.m_tx_num = tx_ids.Size();
+    }
+
+    if(!canonical)
+    {
+        header.m_data_json = to_json(data);
+    }
+
+    const rapidjson::Value &children = doc["children"];
+
+    for(rapidjson::SizeType i = 0; i < children.Size(); ++i)
+    {
+        const rapidjson::Value &child = children[i];
+
+        if(!is_base64_char(child))
+        {
+            return false;
+        }
+
+        to_raw(child, raw);
+        header.m_children.push_back(raw);
+    }
+
+    return true;
+}
+
+bool Block_Record::txs_from_doc(const rapidjson::Value &doc, std::vector<Tx> &txs)
+{
+    txs.clear();
+
+    if(!doc.HasMember("tx"))
+    {
+        return true;
+    }
+
+    const rapidjson::Value &tx_arr = doc["tx"];
+
+    if(!tx_arr.IsArray())
+    {
+        return false;
+    }
+
+    for(rapidjson::SizeType i = 0; i < tx_arr.Size(); ++i)
+    {
+        const rapidjson::Value &tx_node = tx_arr[i];
+
+        if(!tx_node.IsObject() || !tx_node.HasMember("sign") || !is_base64_char(tx_node["sign"]) || !tx_node.HasMember("data") \
+           || !tx_node["data"].IsObject())
+        {
+            return false;
+        }
+
+        const rapidjson::Value &data = tx_node["data"];
+        Tx tx;
+        to_raw(tx_node["sign"], tx.m_sign);
+        tx.m_type = get_uint64(data, "type");
+        tx.m_utc = get_uint64(data, "utc");
+        tx.m_block_id = get_uint64(data, "block_id");
+        tx.m_fee = get_uint64(data, "fee");
+        tx.m_pubkey = get_string(data, "pubkey");
+        tx.m_avatar = get_uint64(data, "avatar");
+        tx.m_receiver = get_string(data, "receiver");
+        tx.m_amount = get_uint64(data, "amount");
+        tx.m_reward = get_uint64(data, "reward");
+        tx.m_topic = get_string(data, "topic");
+        tx.m_topic_key = get_string(data, "topic_key");
+        tx.m_reply_to = get_string(data, "reply_to");
+        tx.m_reply = get_string(data, "reply");
+
+        if(data.HasMember("sign_data") && data["sign_data"].IsObject())
+        {
+            tx.m_name = get_string(data["sign_data"], "name");
+            tx.m_referrer = get_string(data["sign_data"], "referrer");
+        }
+
+        tx.m_data = to_json(data);
+        tx.m_data_is_json = true;
+        txs.push_back(std::move(tx));
+    }
+
+    return true;
+}
+
+std::string Block_Record::Header::data_json() const
+{
+    if(!m_data_json.empty())
+    {
+        return m_data_json;
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    std::string pre_hash = fly::base::base64_encode(m_pre_hash.data(), m_pre_hash.length());
+    writer.StartObject();
+    writer.Key("id");
+    writer.Uint64(m_id);
+    writer.Key("utc");
+    writer.Uint64(m_utc);
+    writer.Key("version");
+    writer.Uint(m_version);
+    writer.Key("zero_bits");
+    writer.Uint(m_zero_bits);
+    writer.Key("pre_hash");
+    writer.String(pre_hash.data(), pre_hash.length());
+    writer.Key("miner");
+    writer.String(m_miner.data(), m_miner.length());
+
+    if(!m_pruned)
+    {
+        writer.Key("tx_ids");
+        writer.StartArray();
+
+        for(auto &tx_id : m_tx_ids)
+        {
+            std::string b64 = fly::base::base64_encode(tx_id.data(), tx_id.length());
+            writer.String(b64.data(), b64.length());
+        }
+
+        writer.EndArray();
+        writer.Key("nonce");
+        writer.StartArray();
+
+        for(uint32 i = 0; i < 4; ++i)
+        {
+            writer.Uint64(m_nonce[i]);
+        }
+
+        writer.EndArray();
+    }
+
+    writer.EndObject();
+
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+void Block_Record::Header::data_value(rapidjson::Value &data, rapidjson::Document::AllocatorType &allocator) const
+{
+    if(!m_data_json.empty())
+    {
+        rapidjson::Document doc;
+        doc.Parse(m_data_json.c_str());
+        data.CopyFrom(doc, allocator);
+
+        return;
+    }
+
+    std::string pre_hash = fly::base::base64_encode(m_pre_hash.data(), m_pre_hash.length());
+    data.SetObject();
+    data.AddMember("id", m_id, allocator);
+    data.AddMember("utc", m_utc, allocator);
+    data.AddMember("version", m_version, allocator);
+    data.AddMember("zero_bits", m_zero_bits, allocator);
+    data.AddMember("pre_hash", rapidjson::Value(pre_hash.c_str(), allocator), allocator);
+    data.AddMember("miner", rapidjson::Value(m_miner.c_str(), allocator), allocator);
+
+    if(m_pruned)
+    {
+        return;
+    }
+
+    rapidjson::Value tx_ids(rapidjson::kArrayType);
+    rapidjson::Value nonce(rapidjson::kArrayType);
+
+    for(auto &tx_id : m_tx_ids)
+    {
+        std::string b64 = fly::base::base64_encode(tx_id.data(), tx_id.length());
+        tx_ids.PushBack(rapidjson::Value(b64.c_str(), allocator), allocator);
+    }
+
+    for(uint32 i = 0; i < 4; ++i)
+    {
+        nonce.PushBack(m_nonce[i], allocator);
+    }
+
+    data.AddMember("tx_ids", tx_ids, allocator);
+    data.AddMember("nonce", nonce, allocator);
+}
+
+std::string Block_Record::Tx::data_json() const
+{
+    if(m_data_is_json)
+    {
+        return m_data;
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    Record_Reader r(m_data, 0);
+    write_json(r, writer, 1);
+
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
@@ -0,0 +1,100 @@
+#ifndef BLOCK_RECORD
+#define BLOCK_RECORD
+
+#include <string>
+#include <vector>
+#include "fly/base/common.hpp"
+#include "rapidjson/document.h"
+
+const uint8 BLOCK_RECORD_VERSION = 2;
+
+// binary encoding of the block records stored in leveldb under the block hash. the
+// record starts with its version, old records are json text which always starts with
+// '{', so every format can be told apart by the first byte.
+//
+// version 2 lays the block out with fixed width ids and raw 32-byte hashes, so the
+// header is read straight into a Header and the txs are skipped unless asked for.
+// the data of a tx is kept in the tagged encoding of version 1 in its original
+// member order, its fields are read into a Tx and its canonical json, which the tx
+// id covers, is written from the encoding only where the id must be checked. a block
+// which does not fit the layout exactly falls back to the tagged encoding of version
+// 1, which stores any json tree.
+class Block_Record
+{
+public:
+    struct Header
+    {
+        // raw bytes, 32 for the hashes
+        std::string m_hash;
+        std::string m_sign;
+        uint64 m_id = 0;
+        uint64 m_utc = 0;
+        uint32 m_version = 0;
+        uint32 m_zero_bits = 0;
+        std::string m_pre_hash;
+        std::string m_miner;
+        std::vector<std::string> m_tx_ids;
+        uint64 m_nonce[4] = {0, 0, 0, 0};
+
+        // a header record left by the body pruner, m_tx_ids and m_nonce are empty
+        bool m_pruned = false;
+        uint32 m_tx_num = 0;
+
+        // children listed inline by records written before the child edges
+        std::vector<std::string> m_children;
+
+        // the json the block hash covers
+        std::string data_json() const;
+        void data_value(rapidjson::Value &data, rapidjson::Document::AllocatorType &allocator) const;
+
+        // set for an old record whose data can not be rebuilt from the fields
+        std::string m_data_json;
+    };
+
+    struct Tx
+    {
+        // raw bytes
+        std::string m_sign;
+        uint32 m_type = 0;
+        uint64 m_utc = 0;
+        uint64 m_block_id = 0;
+        uint64 m_fee = 0;
+
+        // the fields of the tx types as they are in the data, base64 strings stay base64
+        std::string m_pubkey;
+        std::string m_name;
+        std::string m_referrer;
+        uint32 m_avatar = 0;
+        std::string m_receiver;
+        uint64 m_amount = 0;
+        uint64 m_reward = 0;
+        std::string m_topic;
+        std::string m_topic_key;
+        std::string m_reply_to;
+        std::string m_reply;
+
+        // the json the tx id covers
+        std::string data_json() const;
+
+        // the tagged encoding of the data, or its json text for an old record
+        std::string m_data;
+        bool m_data_is_json = false;
+    };
+
+    static void encode(const rapidjson::Value &doc, std::string &record);
+
+    // accepts every version and the old json text
+    static bool decode(const std::string &record, rapidjson::Document &doc);
+
+    // only reads the header, the txs of a version 2 record are not touched
+    static bool decode_header(const std::string &record, Header &header);
+    static bool decode_block(const std::string &record, Header &header, std::vector<Tx> &txs);
+
+    // the same from a decoded document, for a document of the block cache
+    static bool header_from_doc(const rapidjson::Value &doc, Header &header);
+    static bool txs_from_doc(const rapidjson::Value &doc, std::vector<Tx> &txs);
+    static bool is_json(const std::string &record);
+    static bool is_current(const std::string &record);
+};
+
+#endif
@@ -0,0 +1,354 @@
+#include <memory>
+#include "leveldb/write_batch.h"
+#include "block_record.hpp"
+#include "block_store.hpp"
+
+Store_Status::Store_Status()
+    : m_code(CODE_OK)
+{
+}
+
+Store_Status::Store_Status(CODE code, const std::string &msg)
+    : m_code(code), m_msg(msg)
+{
+}
+
+Store_Status Store_Status::not_found(const std::string &key)
+{
+    return Store_Status(CODE_NOT_FOUND, key);
+}
+
+Store_Status Store_Status::corruption(const std::string &msg)
+{
+    return Store_Status(CODE_CORRUPTION, msg);
+}
+
+Store_Status Store_Status::io_error(const std::string &msg)
+{
+    return Store_Status(CODE_IO_ERROR, msg);
+}
+
+bool Store_Status::ok() const
+{
+    return m_code == CODE_OK;
+}
+
+bool Store_Status::is_not_found() const
+{
+    return m_code == CODE_NOT_FOUND;
+}
+
+std::string Store_Status::to_string() const
+{
+    if(m_code == CODE_OK)
+    {
+        return "OK";
+    }
+
+    if(m_code == CODE_NOT_FOUND)
+    {
+        return "NotFound: " + m_msg;
+    }
+
+    if(m_code == CODE_CORRUPTION)
+    {
+        return "Corruption: " + m_msg;
+    }
+
+    return "IO error: " + m_msg;
+}
+
+void Store_Batch::put(const std::string &key, const std::string &value)
+{
+    m_ops.push_back(Op {key, value, false});
+}
+
+void Store_Batch::del(const std::string &key)
+{
+    m_ops.push_back(Op {key, std::string(), true});
+}
+
+void Store_Batch::append(const Store_Batch &batch)
+{
+    m_ops.insert(m_ops.end(), batch.m_ops.begin(), batch.m_ops.end());
+}
+
+void Store_Batch::clear()
+{
+    m_ops.clear();
+}
+
+bool Store_Batch::empty() const
+{
+    return m_ops.empty();
+}
+
+const std::vector<Store_Batch::Op>& Store_Batch::ops() const
+{
+    return m_ops;
+}
+
+Store_Status Block_Store::get_block(const std::string &hash, rapidjson::Document &doc)
+{
+    std::string record;
+    Store_Status s = get(hash, &record);
+
+    if(!s.ok())
+    {
+        return s;
+    }
+
+    if(!Block_Record::decode(record, doc) || !doc.IsObject())
+    {
+        return Store_Status::corruption("block record " + hash + " can not be decoded");
+    }
+
+    return s;
+}
+
+Store_Status Block_Store::get_block_header(const std::string &hash, Block_Record::Header &header)
+{
+    std::string record;
+    Store_Status s = get(hash, &record);
+
+    if(!s.ok())
+    {
+        return s;
+    }
+
+    if(!Block_Record::decode_header(record, header))
+    {
+        return Store_Status::corruption("block record " + hash + " can not be decoded");
+    }
+
+    return s;
+}
+
+Store_Status Block_Store::get_block(const std::string &hash, Block_Record::Header &header, std::vector<Block_Record::Tx> &txs)
+{
+    std::string record;
+    Store_Status s = get(hash, &record);
+
+    if(!s.ok())
+    {
+        return s;
+    }
+
+    if(!Block_Record::decode_block(record, header, txs))
+    {
+        return Store_Status::corruption("block record " + hash + " can not be decoded");
+    }
+
+    return s;
+}
+
+void Block_Store::put_block(Store_Batch &batch, const std::string &hash, const rapidjson::Value &doc)
+{
+    std::string record;
+    Block_Record::encode(doc, record);
+    batch.put(hash, record);
+}
+
+Store_Status Block_Store::get_meta(const std::string &key, std::string *value)
+{
+    return get(key, value);
+}
+
+Store_Status Block_Store::put_meta(const std::string &key, const std::string &value)
+{
+    Store_Batch batch;
+    batch.put(key, value);
+
+    return write(batch);
+}
+
+Store_Status Block_Store::iterate_prefix(const std::string &prefix, Visitor visitor)
+{
+    return iterate(prefix, [&](const std::string &key, const std::string &value) -> bool {
+            return key.compare(0, prefix.length(), prefix) == 0 && visitor(key, value);
+        });
+}
+
+Leveldb_Store::Leveldb_Store(leveldb::DB *db)
+    : m_db(db)
+{
+}
+
+Store_Status Leveldb_Store::to_status(const leveldb::Status &s)
+{
+    if(s.ok())
+    {
+        return Store_Status();
+    }
+
+    // leveldb puts the kind of error in front of the message, Store_Status does the same
+    std::string msg = s.ToString();
+    auto pos = msg.find(": ");
+
+    if(pos != std::string::npos)
+    {
+        msg = msg.substr(pos + 2);
+    }
+    
+    if(s.IsNotFound())
+    {
+        return Store_Status::not_found(msg);
+    }
+
+    if(s.IsCorruption())
+    {
+        return Store_Status::corruption(msg);
+    }
+
+    return Store_Status::io_error(msg);
+}
+
+Store_Status Leveldb_Store::get(const std::string &key, std::string *value)
+{
+    return to_status(m_db->Get(leveldb::ReadOptions(), key, value));
+}
+
+Store_Status Leveldb_Store::write(const Store_Batch &batch)
+{
+    leveldb::WriteBatch leveldb_batch;
+
+    for(auto &op : batch.ops())
+    {
+        if(op.m_deleted)
+        {
+            leveldb_batch.Delete(op.m_key);
+        }
+        else
+        {
+            leveldb_batch.Put(op.m_key, op.m_value);
+        }
+    }
+
+    return to_status(m_db->Write(leveldb::WriteOptions(), &leveldb_batch));
+}
+
+Store_Status Leveldb_Store::iterate(const std::string &start, Visitor visitor)
+{
+    std::unique_ptr<leveldb::Iterator> iter(m_db->NewIterator(leveldb::ReadOptions()));
+
+    for(iter->Seek(start); iter->Valid(); iter->Next())
+    {
+        if(!visitor(iter->key().ToString(), iter->value().ToString()))
+        {
+            break;
+        }
+    }
+
+    return to_status(iter->status());
+}
+
+bool Leveldb_Store::get_property(const std::string &name, std::string *value)
+{
+    return m_db->GetProperty(name, value);
+}
+
+uint64 Leveldb_Store::approximate_size(const std::string &start, const std::string &limit)
+{
+    uint64_t size = 0;
+    leveldb::Range range(start, limit);
+    m_db->GetApproximateSizes(&range, 1, &size);
+
+    return size;
+}
+
+Memory_Store::Memory_Store()
+{
+}
+
+Store_Status Memory_Store::get(const std::string &key, std::string *value)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_data.find(key);
+
+    if(iter == m_data.end())
+    {
+        return Store_Status::not_found(key);
+    }
+
+    *value = iter->second;
+
+    return Store_Status();
+}
+
+Store_Status Memory_Store::write(const Store_Batch &batch)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    for(auto &op : batch.ops())
+    {
+        if(op.m_deleted)
+        {
+            m_data.erase(op.m_key);
+        }
+        else
+        {
+            m_data[op.m_key] = op.m_value;
+        }
+    }
+
+    return Store_Status();
+}
+
+Store_Status Memory_Store::iterate(const std::string &start, Visitor visitor)
+{
+    std::string key;
+    std::string value;
+    bool first = true;
+
+    // every entry is copied out and the position looked up again on every step, so the
+    // visitor may write to the store and the lock is never held while it runs.
+    while(true)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto iter = first ? m_data.lower_bound(start) : m_data.upper_bound(key);
+
+            if(iter == m_data.end())
+            {
+                break;
+            }
+
+            key = iter->first;
+            value = iter->second;
+            first = false;
+        }
+
+        if(!visitor(key, value))
+        {
+            break;
+        }
+    }
+
+    return Store_Status();
+}
+
+bool Memory_Store::get_property(const std::string &name, std::string *value)
+{
+    if(name == "leveldb.stats")
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        *value = "in-memory store, " + std::to_string(m_data.size()) + " keys";
+
+        return true;
+    }
+
+    return false;
+}
+
+uint64 Memory_Store::approximate_size(const std::string &start, const std::string &limit)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    uint64 size = 0;
+
+    for(auto iter = m_data.lower_bound(start); iter != m_data.end() && iter->first < limit; ++iter)
+    {
+        size += iter->first.length() + iter->second.length();
+    }
+
+    return size;
+}
@@ -0,0 +1,130 @@
+#ifndef BLOCK_STORE
+#define BLOCK_STORE
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <functional>
+#include "leveldb/db.h"
+#include "rapidjson/document.h"
+#include "fly/base/common.hpp"
+#include "block_record.hpp"
+
+// outcome of a Block_Store call, an engine maps its own errors onto these codes
+class Store_Status
+{
+public:
+    Store_Status();
+    static Store_Status not_found(const std::string &key);
+    static Store_Status corruption(const std::string &msg);
+    static Store_Status io_error(const std::string &msg);
+    bool ok() const;
+    bool is_not_found() const;
+    std::string to_string() const;
+
+private:
+    enum CODE
+    {
+        CODE_OK = 0,
+        CODE_NOT_FOUND,
+        CODE_CORRUPTION,
+        CODE_IO_ERROR
+    };
+
+    Store_Status(CODE code, const std::string &msg);
+    CODE m_code;
+    std::string m_msg;
+};
+
+// puts and deletes which Block_Store::write applies at once, in the order given
+class Store_Batch
+{
+public:
+    struct Op
+    {
+        std::string m_key;
+        std::string m_value;
+        bool m_deleted;
+    };
+
+    void put(const std::string &key, const std::string &value);
+    void del(const std::string &key);
+    void append(const Store_Batch &batch);
+    void clear();
+    bool empty() const;
+    const std::vector<Op>& ops() const;
+
+private:
+    std::vector<Op> m_ops;
+};
+
+// the key-value storage under the chain: block records keyed by hash, meta keys
+// such as "peer_score" or "snapshot_<id>", and the edge and height indexes. keys
+// are ordered bytewise. an engine implements the virtual primitives, the block and
+// meta calls are built on top of them, so the consensus code never sees the engine.
+class Block_Store
+{
+public:
+    // called with every key and value visited, returning false stops the iteration
+    typedef std::function<bool(const std::string &key, const std::string &value)> Visitor;
+    virtual ~Block_Store() {}
+    virtual Store_Status get(const std::string &key, std::string *value) = 0;
+    virtual Store_Status write(const Store_Batch &batch) = 0;
+
+    // visits the keys not less than start in order
+    virtual Store_Status iterate(const std::string &start, Visitor visitor) = 0;
+    virtual bool get_property(const std::string &name, std::string *value) = 0;
+
+    // bytes used by the keys in [start, limit)
+    virtual uint64 approximate_size(const std::string &start, const std::string &limit) = 0;
+
+    // the decoded block record, a record which can not be decoded is a corruption
+    Store_Status get_block(const std::string &hash, rapidjson::Document &doc);
+
+    // the same read straight into the typed fields, without a document
+    Store_Status get_block_header(const std::string &hash, Block_Record::Header &header);
+    Store_Status get_block(const std::string &hash, Block_Record::Header &header, std::vector<Block_Record::Tx> &txs);
+
+    // encodes the block record into batch, the blocks of one batch are written together
+    static void put_block(Store_Batch &batch, const std::string &hash, const rapidjson::Value &doc);
+    Store_Status get_meta(const std::string &key, std::string *value);
+    Store_Status put_meta(const std::string &key, const std::string &value);
+
+    // visits the keys starting with prefix
+    Store_Status iterate_prefix(const std::string &prefix, Visitor visitor);
+};
+
+class Leveldb_Store : public Block_Store
+{
+public:
+    Leveldb_Store(leveldb::DB *db);
+    Store_Status get(const std::string &key, std::string *value) override;
+    Store_Status write(const Store_Batch &batch) override;
+    Store_Status iterate(const std::string &start, Visitor visitor) override;
+    bool get_property(const std::string &name, std::string *value) override;
+    uint64 approximate_size(const std::string &start, const std::string &limit) override;
+
+private:
+    static Store_Status to_status(const leveldb::Status &s);
+    leveldb::DB *m_db;
+};
+
+// keeps everything in a std::map, nothing survives a restart. meant for
+// benchmarks and simulations which want the consensus and api code without disk.
+class Memory_Store : public Block_Store
+{
+public:
+    Memory_Store();
+    Store_Status get(const std::string &key, std::string *value) override;
+    Store_Status write(const Store_Batch &batch) override;
+    Store_Status iterate(const std::string &start, Visitor visitor) override;
+    bool get_property(const std::string &name, std::string *value) override;
+    uint64 approximate_size(const std::string &start, const std::string &limit) override;
+
+private:
+    std::map<std::string, std::string> m_data;
+    std::mutex m_mutex;
+};
+
+#endif
@@ -1,25 +1,37 @@
 #include <netinet/in.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <fstream>
+#include <condition_variable>
 #include "leveldb/comparator.h"
 #include "leveldb/write_batch.h"
+#include "leveldb/cache.h"
+#include "leveldb/filter_policy.h"
 #include "fly/base/logger.hpp"
 #include "blockchain.hpp"
+#include "block_record.hpp"
+#include "mine_template.hpp"
+#include "asic_resistant.hpp"
+#include "pow_cache.hpp"
+#include "block_cache.hpp"
+#include "snapshot.hpp"
+#include "merge_point.hpp"
+#include "verify_pool.hpp"
 #include "key.h"
 #include "version.hpp"
 #include "utilstrencodings.h"
 #include "random.h"
 #include "cryptopp/sha.h"
+#include "crypto/hmac_sha256.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
-#include "rapidjson/ostreamwrapper.h"
-#include "rapidjson/istreamwrapper.h"
 #include "net/p2p/node.hpp"
 #include "net/p2p/message.hpp"
 #include "net/api/wsock_node.hpp"
+#include "net/api/message.hpp"
 
 Blockchain::Blockchain()
 {
@@ -52,9 +64,6 @@ Blockchain::~Blockchain()
 {
 }
 
-const uint32 ASIC_RESISTANT_DATA_NUM = 5 * 1024 * 1024;
-extern std::vector<uint32> __asic_resistant_data__;
-
 bool Blockchain::hash_pow(char hash_arr[32], uint32 zero_bits)
 {
     uint32 zero_char_num = zero_bits / 8;
@@ -79,50 +88,105 @@ bool Blockchain::hash_pow(char hash_arr[32], uint32 zero_bits)
 
 bool Blockchain::verify_hash(std::string block_hash, std::string block_data, uint32 zero_bits)
 {
-    char hash_raw[32];
-    uint32 len = fly::base::base64_decode(block_hash.c_str(), block_hash.length(), hash_raw, 32);
+    return verify_hash(&block_hash, &block_data, &zero_bits, 1) == 1;
+}
 
-    if(len != 32)
-    {
-        return false;
-    }
-    
-    uint32 buf[16] = {0};
-    char *p = (char*)buf;
-    coin_hash(block_data.c_str(), block_data.length(), p);
-    block_data += "another_32_bytes";
-    coin_hash(block_data.c_str(), block_data.length(), p + 32);
-    uint32 arr_16[16] = {0};
-    
-    for(uint32 i = 0; i < 16; ++i)
-    {
-        arr_16[i] = ntohl(buf[i]);
-    }
+uint32 Blockchain::verify_hash(const std::string block_hash[], const std::string block_data[], const uint32 zero_bits[], uint32 num)
+{
+    Pow_Cache *pow_cache = Pow_Cache::instance();
+    uint32 bufs[ASIC_RESISTANT_BATCH_NUM][16];
+    std::string data_ext[ASIC_RESISTANT_BATCH_NUM];
+    const char *in[ASIC_RESISTANT_BATCH_NUM * 2];
+    uint32 in_size[ASIC_RESISTANT_BATCH_NUM * 2];
+    char hashes[ASIC_RESISTANT_BATCH_NUM * 2][32];
+    char hash_raw[ASIC_RESISTANT_BATCH_NUM][32];
+    bool pass[ASIC_RESISTANT_BATCH_NUM];
+    bool done[ASIC_RESISTANT_BATCH_NUM];
+    uint32 mix_idx[ASIC_RESISTANT_BATCH_NUM];
     
-    for(uint32 i = 0; i < ASIC_RESISTANT_DATA_NUM;)
+    for(uint32 n = 0; n < num;)
     {
-        for(int j = 0; j < 16; ++j)
+        uint32 k = num - n;
+        
+        if(k > ASIC_RESISTANT_BATCH_NUM)
         {
-            arr_16[j] = (arr_16[j] + __asic_resistant_data__[i + j]) * (arr_16[j] ^ __asic_resistant_data__[i + j]);
+            k = ASIC_RESISTANT_BATCH_NUM;
+        }
+
+        for(uint32 c = 0; c < k; ++c)
+        {
+            const std::string &hash = block_hash[n + c];
+            uint32 len = fly::base::base64_decode(hash.c_str(), hash.length(), hash_raw[c], 32);
+
+            // the leading zero check is cheap, so do it before the asic resistant mixing
+            pass[c] = len == 32 && hash_pow(hash_raw[c], zero_bits[n + c]);
+            done[c] = !pass[c];
+            data_ext[c] = block_data[n + c] + "another_32_bytes";
+            in[c] = block_data[n + c].data();
+            in_size[c] = block_data[n + c].length();
+            in[k + c] = data_ext[c].data();
+            in_size[k + c] = data_ext[c].length();
         }
+
+        coin_hash_multi(in, in_size, k * 2, hashes[0]);
+        uint32 mix_num = 0;
         
-        i += 16;
-    }
-    
-    for(uint32 i = 0; i < 16; ++i)
-    {
-        buf[i] = htonl(arr_16[i]);
-    }
-    
-    std::string hash_data = block_data + fly::base::base64_encode(p, 64);
-    std::string block_hash_verify = coin_hash_b64(hash_data.c_str(), hash_data.length());
-    
-    if(block_hash != block_hash_verify)
-    {
-        return false;
+        for(uint32 c = 0; c < k; ++c)
+        {
+            if(done[c])
+            {
+                continue;
+            }
+
+            // hashes[c] is the hash of block data
+            if(pow_cache->get(block_hash[n + c], hashes[c], zero_bits[n + c], pass[c]))
+            {
+                done[c] = true;
+                continue;
+            }
+            
+            char *p = (char*)bufs[mix_num];
+            memcpy(p, hashes[c], 32);
+            memcpy(p + 32, hashes[k + c], 32);
+            mix_idx[mix_num++] = c;
+        }
+
+        if(mix_num > 0)
+        {
+            asic_resistant_mix_batch(bufs, mix_num);
+            char data_hashes[ASIC_RESISTANT_BATCH_NUM][32];
+            
+            for(uint32 i = 0; i < mix_num; ++i)
+            {
+                uint32 c = mix_idx[i];
+                memcpy(data_hashes[i], hashes[c], 32);
+                data_ext[c] += fly::base::base64_encode((char*)bufs[i], 64);
+                in[i] = data_ext[c].data();
+                in_size[i] = data_ext[c].length();
+            }
+
+            coin_hash_multi(in, in_size, mix_num, hashes[0]);
+
+            for(uint32 i = 0; i < mix_num; ++i)
+            {
+                uint32 c = mix_idx[i];
+                pass[c] = block_hash[n + c] == fly::base::base64_encode(hashes[i], 32);
+                pow_cache->put(block_hash[n + c], data_hashes[i], zero_bits[n + c], pass[c]);
+            }
+        }
+        
+        for(uint32 c = 0; c < k; ++c)
+        {
+            if(!pass[c])
+            {
+                return n + c;
+            }
+        }
+        
+        n += k;
     }
     
-    return hash_pow(hash_raw, zero_bits);
+    return num;
 }
 
 std::string Blockchain::sign(std::string privk_b64, std::string hash_b64)
@@ -146,6 +210,23 @@ std::string Blockchain::sign(std::string privk_b64, std::string hash_b64)
 }
 
 bool Blockchain::verify_sign(std::string pubk_b64, std::string hash_b64, std::string sign_b64)
+{
+    if(!m_verified_signs.empty())
+    {
+        auto iter = m_verified_signs.find(pubk_b64 + hash_b64 + sign_b64);
+
+        if(iter != m_verified_signs.end())
+        {
+            m_verified_signs.erase(iter);
+            
+            return true;
+        }
+    }
+    
+    return check_sign(pubk_b64, hash_b64, sign_b64);
+}
+
+bool Blockchain::check_sign(const std::string &pubk_b64, const std::string &hash_b64, const std::string &sign_b64)
 {
     if(sign_b64.length() < 80 || sign_b64.length() > 108)
     {
@@ -291,57 +372,23 @@ bool Blockchain::proc_tx_map(std::shared_ptr<Block> block)
         }
     }
     
-    std::string block_data;
-    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), expired_block->hash(), &block_data);
-            
-    if(!s.ok())
-    {
-        return false;
-    }
-            
-    rapidjson::Document doc;
-    const char *block_data_str = block_data.c_str();
-    doc.Parse(block_data_str);
-        
-    if(doc.HasParseError())
-    {
-        return false;
-    }
-
-    if(!doc.IsObject())
-    {
-        return false;
-    }
-            
-    if(!doc.HasMember("data"))
-    {
-        return false;
-    }
-
-    const rapidjson::Value &data = doc["data"];
+    Block_Record::Header header;
 
-    if(!data.HasMember("tx_ids"))
+    if(!get_block_header(expired_block->hash(), header) || header.m_pruned)
     {
         return false;
     }
-        
-    const rapidjson::Value &tx_ids = data["tx_ids"];
 
-    if(!tx_ids.IsArray())
-    {
-        return false;
-    }
-            
-    uint32 tx_num = tx_ids.Size();
+    uint32 tx_num = header.m_tx_ids.size();
             
     if(tx_num > 2000)
     {
         return false;
     }
     
-    for(rapidjson::Value::ConstValueIterator iter = tx_ids.Begin(); iter != tx_ids.End(); ++iter)
+    for(auto &raw_id : header.m_tx_ids)
     {
-        std::string tx_id = iter->GetString();
+        std::string tx_id = fly::base::base64_encode(raw_id.data(), raw_id.length());
         tx_pair.second.push_front(tx_id);
                 
         if(m_tx_map.erase(tx_id) != 1)
@@ -465,13 +512,64 @@ void Blockchain::do_score()
         rapidjson::StringBuffer buffer;
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
         doc.Accept(writer);
-        leveldb::Status s = m_db->Put(leveldb::WriteOptions(), "peer_score", buffer.GetString());
+        Store_Status s = m_store->put_meta("peer_score", buffer.GetString());
         
         if(!s.ok())
         {
-            LOG_FATAL("write peer_score failed, reason: %s", s.ToString().c_str());
+            LOG_FATAL("write peer_score failed, reason: %s", s.to_string().c_str());
+        }
+    }
+}
+
+void Blockchain::set_mine_thread_num(uint32 num)
+{
+    m_mine_thread_num = num;
+}
+
+void Blockchain::get_mine_stat(rapidjson::Value &stat, rapidjson::Document::AllocatorType &allocator)
+{
+    uint64 hash_rate = 0;
+    rapidjson::Value thread_rates(rapidjson::kArrayType);
+    
+    if(m_mine_stats)
+    {
+        for(uint32 i = 0; i < m_mine_thread_num; ++i)
+        {
+            uint64 rate = m_mine_stats[i].m_hash_rate.load(std::memory_order_relaxed);
+            hash_rate += rate;
+            thread_rates.PushBack(rate, allocator);
+        }
+    }
+
+    uint64 latency_cnt = m_remine_latency_cnt.load(std::memory_order_relaxed);
+    uint64 latency_avg = 0;
+
+    if(latency_cnt > 0)
+    {
+        latency_avg = m_remine_latency_total_usec.load(std::memory_order_relaxed) / latency_cnt;
+    }
+    
+    uint32 remine_num = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_mine_mutex);
+        uint64 now = Timer::now_msec();
+        
+        for(auto remine_msec : m_remine_msecs)
+        {
+            if(remine_msec + 60 * 1000 >= now)
+            {
+                ++remine_num;
+            }
         }
     }
+    
+    stat.SetObject();
+    stat.AddMember("hash_rate", hash_rate, allocator);
+    stat.AddMember("thread_hash_rate", thread_rates, allocator);
+    stat.AddMember("remine_latency_usec", m_remine_latency_usec.load(std::memory_order_relaxed), allocator);
+    stat.AddMember("remine_latency_avg_usec", latency_avg, allocator);
+    stat.AddMember("remine_per_min", remine_num, allocator);
+    stat.AddMember("stale_share", m_stale_share_cnt.load(std::memory_order_relaxed), allocator);
 }
 
 void Blockchain::do_mine()
@@ -484,24 +582,65 @@ void Blockchain::do_mine()
             continue;
         }
         
-        std::list<std::shared_ptr<tx::Tx>> mined_txs;
-        uint64 cur_block_id, cur_block_utc;
-        uint32 zero_bits;
-        std::string cur_block_hash, miner_key;
-        std::atomic<uint64> mine_id_2 {0};
-    remine:
+        std::shared_ptr<Mine_Job> job = std::make_shared<Mine_Job>();
+        std::lock_guard<std::mutex> guard(m_mine_mutex);
+        job->m_mined_txs = std::move(m_mined_txs);
+        job->m_mine_id = m_mine_id_1.load(std::memory_order_relaxed);
+        job->m_cur_block_id = m_mine_cur_block_id;
+        job->m_cur_block_utc = m_mine_cur_block_utc;
+        job->m_cur_block_hash = m_mine_cur_block_hash;
+        job->m_zero_bits = m_mine_zero_bits;
+        job->m_miner_key = m_miner_privkey;
+        job->m_remine_usec = m_remine_usec.load(std::memory_order_relaxed);
+        m_need_remine.store(false, std::memory_order_relaxed);
+        m_mine_job = job;
+        uint64 now = Timer::now_msec();
+        m_remine_msecs.push_back(now);
+        
+        while(m_remine_msecs.front() + 60 * 1000 < now)
+        {
+            m_remine_msecs.pop_front();
+        }
+        
+        m_mine_job_seq.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void Blockchain::do_mine_worker(uint32 worker_id)
+{
+    uint64 job_seq = 0;
+    Mine_Stat &stat = m_mine_stats[worker_id];
+    uint64 rate_hashes = 0;
+    uint64 rate_msec = Timer::now_msec();
+    
+    while(!m_stop.load(std::memory_order_relaxed))
+    {
+        if(m_mine_job_seq.load(std::memory_order_acquire) == job_seq)
+        {
+            uint64 now = Timer::now_msec();
+            
+            if(now >= rate_msec + 1000)
+            {
+                stat.m_hash_rate.store(rate_hashes * 1000 / (now - rate_msec), std::memory_order_relaxed);
+                rate_hashes = 0;
+                rate_msec = now;
+            }
+            
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        
+        std::shared_ptr<Mine_Job> job;
         {
             std::lock_guard<std::mutex> guard(m_mine_mutex);
-            mined_txs = std::move(m_mined_txs);
-            mine_id_2.store(m_mine_id_1.load(std::memory_order_relaxed), std::memory_order_relaxed);
-            cur_block_id = m_mine_cur_block_id;
-            cur_block_utc = m_mine_cur_block_utc;
-            cur_block_hash = m_mine_cur_block_hash;
-            zero_bits = m_mine_zero_bits;
-            miner_key = m_miner_privkey;
-            m_need_remine.store(false, std::memory_order_relaxed);
+            job = m_mine_job;
+            job_seq = m_mine_job_seq.load(std::memory_order_relaxed);
         }
 
+        uint64 cur_block_id = job->m_cur_block_id;
+        uint64 cur_block_utc = job->m_cur_block_utc;
+        uint32 zero_bits = job->m_zero_bits;
+        const std::string &miner_key = job->m_miner_key;
         char privk[32];
         fly::base::base64_decode(miner_key.c_str(), miner_key.length(), privk, 32);
         CKey miner_priv_key;
@@ -520,11 +659,11 @@ void Blockchain::do_mine()
         data.AddMember("utc", time(NULL), allocator);
         data.AddMember("version", ASKCOIN_VERSION, allocator);
         data.AddMember("zero_bits", zero_bits, allocator);
-        data.AddMember("pre_hash", rapidjson::Value(cur_block_hash.c_str(), allocator), allocator);
+        data.AddMember("pre_hash", rapidjson::Value(job->m_cur_block_hash.c_str(), allocator), allocator);
         data.AddMember("miner", rapidjson::Value(miner_pub_key_b64.c_str(), allocator), allocator);
         rapidjson::Value tx_ids(rapidjson::kArrayType);
         
-        for(auto tx : mined_txs)
+        for(auto tx : job->m_mined_txs)
         {
             tx_ids.PushBack(rapidjson::Value(tx->m_id.c_str(), allocator), allocator);
         }
@@ -537,14 +676,27 @@ void Blockchain::do_mine()
         nonce.PushBack(0, allocator);
         data.AddMember("nonce", nonce, allocator);
         char hash_raw[32];
+        Mine_Template tmpl;
+        uint64 last_utc = 0;
+        uint64 win_utc = 0;
+        uint64 win_nonce[4] = {0};
+        
+        if(!tmpl.init(data))
+        {
+            LOG_FATAL("mine template init failed, block_id: %lu", cur_block_id + 1);
+            ASKCOIN_EXIT(EXIT_FAILURE);
+        }
         
-        for(uint64 i = 0; i < (uint64)-1; ++i)
+        // every worker owns the slice of nonce[3] congruent to its worker_id, so no
+        // two workers ever hash the same header.
+        for(uint64 i = worker_id; i < (uint64)-1 - m_mine_thread_num; i += m_mine_thread_num)
         {
             for(uint64 j = 0; j < (uint64)-1; ++j)
             {
                 for(uint64 k = 0; k < (uint64)-1; ++k)
                 {
-                    for(uint64 m = 0; m < (uint64)-1; ++m)
+                    // ASIC_RESISTANT_BATCH_NUM nonces share one pass over __asic_resistant_data__
+                    for(uint64 m = 0; m < (uint64)-1 - ASIC_RESISTANT_BATCH_NUM; m += ASIC_RESISTANT_BATCH_NUM)
                     {
                         if(m_stop.load(std::memory_order_relaxed))
                         {
@@ -553,7 +705,17 @@ void Blockchain::do_mine()
                         
                         if(m_need_remine.load(std::memory_order_acquire))
                         {
-                            goto remine;
+                            goto next_job;
+                        }
+
+                        if(m_mine_job_seq.load(std::memory_order_relaxed) != job_seq)
+                        {
+                            goto next_job;
+                        }
+
+                        if(job->m_found.load(std::memory_order_relaxed))
+                        {
+                            goto next_job;
                         }
                         
                         uint64 utc = time(NULL);
@@ -563,111 +725,141 @@ void Blockchain::do_mine()
                             utc = cur_block_utc;
                         }
                         
-                        data["utc"].SetUint64(utc);
-                        data["nonce"][0] = m;
-                        data["nonce"][1] = k;
-                        data["nonce"][2] = j;
-                        data["nonce"][3] = i;
-                        rapidjson::StringBuffer buffer;
-                        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                        data.Accept(writer);
-                        uint32 buf[16] = {0};
-                        char *p = (char*)buf;
-                        coin_hash(buffer.GetString(), buffer.GetSize(), p);
-                        char * ptr = buffer.Push(16);
-                        memcpy(ptr, "another_32_bytes", 16);
-                        coin_hash(buffer.GetString(), buffer.GetSize(), p + 32);
-                        uint32 arr_16[16] = {0};
-                            
-                        for(uint32 i = 0; i < 16; ++i)
+                        if(utc != last_utc)
                         {
-                            arr_16[i] = ntohl(buf[i]);
+                            tmpl.set_utc(utc);
+                            last_utc = utc;
                         }
-    
-                        for(uint32 i = 0; i < ASIC_RESISTANT_DATA_NUM;)
+                        
+                        uint32 bufs[ASIC_RESISTANT_BATCH_NUM][16];
+                        std::string tails[ASIC_RESISTANT_BATCH_NUM * 2];
+                        char hashes[ASIC_RESISTANT_BATCH_NUM * 2][32];
+                        
+                        for(uint32 c = 0; c < ASIC_RESISTANT_BATCH_NUM; ++c)
                         {
-                            for(int j = 0; j < 16; ++j)
-                            {
-                                arr_16[j] = (arr_16[j] + __asic_resistant_data__[i + j]) * (arr_16[j] ^ __asic_resistant_data__[i + j]);
-                            }
-        
-                            i += 16;
+                            tmpl.set_nonce(m + c, k, j, i);
+                            tails[c] = tmpl.tail();
+                            tails[ASIC_RESISTANT_BATCH_NUM + c] = tails[c] + "another_32_bytes";
                         }
-    
-                        for(uint32 i = 0; i < 16; ++i)
+                        
+                        tmpl.hash(tails, ASIC_RESISTANT_BATCH_NUM * 2, hashes[0]);
+                        
+                        for(uint32 c = 0; c < ASIC_RESISTANT_BATCH_NUM; ++c)
                         {
-                            buf[i] = htonl(arr_16[i]);
+                            char *p = (char*)bufs[c];
+                            memcpy(p, hashes[c], 32);
+                            memcpy(p + 32, hashes[ASIC_RESISTANT_BATCH_NUM + c], 32);
                         }
-
-                        ptr = buffer.Push(88);
-                        std::string p_b64 = fly::base::base64_encode(p, 64);
-                        memcpy(ptr, p_b64.data(), 88);
-                        coin_hash(buffer.GetString(), buffer.GetSize(), hash_raw);
-                        uint32 zero_char_num = zero_bits / 8;
-                        uint32 zero_remain_bit = 0;
-
-                        for(uint32 i = 0; i < zero_char_num; ++i)
+                        
+                        asic_resistant_mix_batch(bufs, ASIC_RESISTANT_BATCH_NUM);
+                        
+                        for(uint32 c = 0; c < ASIC_RESISTANT_BATCH_NUM; ++c)
                         {
-                            if(hash_raw[i] != 0)
-                            {
-                                goto try_next;
-                            }
+                            tails[c] = tails[ASIC_RESISTANT_BATCH_NUM + c] + fly::base::base64_encode((char*)bufs[c], 64);
                         }
 
-                        zero_remain_bit = zero_bits % 8;
+                        tmpl.hash(tails, ASIC_RESISTANT_BATCH_NUM, hashes[0]);
+                        stat.m_hashes.fetch_add(ASIC_RESISTANT_BATCH_NUM, std::memory_order_relaxed);
+                        rate_hashes += ASIC_RESISTANT_BATCH_NUM;
                         
-                        if(zero_remain_bit == 0)
+                        if(!job->m_first_hash.exchange(true, std::memory_order_relaxed) && job->m_remine_usec > 0)
                         {
-                            goto mine_success;
+                            uint64 latency = Timer::now_usec() - job->m_remine_usec;
+                            m_remine_latency_usec.store(latency, std::memory_order_relaxed);
+                            m_remine_latency_total_usec.fetch_add(latency, std::memory_order_relaxed);
+                            m_remine_latency_cnt.fetch_add(1, std::memory_order_relaxed);
                         }
+                        
+                        {
+                            uint64 now = Timer::now_msec();
                             
-                        if((uint8)hash_raw[zero_char_num] < 1 << 8 - zero_remain_bit)
+                            if(now >= rate_msec + 1000)
+                            {
+                                stat.m_hash_rate.store(rate_hashes * 1000 / (now - rate_msec), std::memory_order_relaxed);
+                                rate_hashes = 0;
+                                rate_msec = now;
+                            }
+                        }
+                        
+                        for(uint32 c = 0; c < ASIC_RESISTANT_BATCH_NUM; ++c)
                         {
-                            goto mine_success;
+                            if(hash_pow(hashes[c], zero_bits))
+                            {
+                                memcpy(hash_raw, hashes[c], 32);
+                                tmpl.set_nonce(m + c, k, j, i);
+                                win_utc = utc;
+                                win_nonce[0] = m + c;
+                                win_nonce[1] = k;
+                                win_nonce[2] = j;
+                                win_nonce[3] = i;
+                            
+                                goto mine_success;
+                            }
                         }
-
-                    try_next:
-                        ;
                     }
                 }
             }
         }
         
     mine_success:
-        std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
-        std::string block_hash = fly::base::base64_encode(hash_raw, 32);
-        LOG_DEBUG_INFO("mine successfully, zero_bits: %u, block_id: %lu, block_hash: %s (hex: %s)", \
-                       zero_bits, cur_block_id + 1, block_hash.c_str(), hex_hash.c_str());
-        doc["hash"].SetString(block_hash.c_str(), allocator);
-        std::vector<unsigned char> sign_vec;
-
-        if(!miner_priv_key.Sign(uint256(std::vector<unsigned char>(hash_raw, hash_raw + 32)), sign_vec))
+        // only the first worker that solves this job publishes it
+        if(!job->m_found.exchange(true, std::memory_order_acq_rel))
         {
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
+            data["utc"].SetUint64(win_utc);
+            data["nonce"][0] = win_nonce[0];
+            data["nonce"][1] = win_nonce[1];
+            data["nonce"][2] = win_nonce[2];
+            data["nonce"][3] = win_nonce[3];
+            {
+                rapidjson::StringBuffer buffer;
+                rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+                data.Accept(writer);
+                
+                if(buffer.GetSize() != tmpl.size() || memcmp(buffer.GetString(), tmpl.buf().data(), tmpl.size()) != 0)
+                {
+                    LOG_FATAL("mine template differs from the serialized block data, block_id: %lu", cur_block_id + 1);
+                    ASKCOIN_EXIT(EXIT_FAILURE);
+                }
+            }
+            
+            std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
+            std::string block_hash = fly::base::base64_encode(hash_raw, 32);
+            LOG_DEBUG_INFO("mine successfully, worker: %u, zero_bits: %u, block_id: %lu, block_hash: %s (hex: %s)", \
+                           worker_id, zero_bits, cur_block_id + 1, block_hash.c_str(), hex_hash.c_str());
+            doc["hash"].SetString(block_hash.c_str(), allocator);
+            std::vector<unsigned char> sign_vec;
+
+            if(!miner_priv_key.Sign(uint256(std::vector<unsigned char>(hash_raw, hash_raw + 32)), sign_vec))
+            {
+                ASKCOIN_EXIT(EXIT_FAILURE);
+            }
         
-        std::string block_sign = fly::base::base64_encode(&sign_vec[0], sign_vec.size());
-        doc["sign"].SetString(block_sign.c_str(), allocator);
-        doc.AddMember("data", data, allocator);
-        rapidjson::Value doc_tx(rapidjson::kArrayType);
+            std::string block_sign = fly::base::base64_encode(&sign_vec[0], sign_vec.size());
+            doc["sign"].SetString(block_sign.c_str(), allocator);
+            doc.AddMember("data", data, allocator);
+            rapidjson::Value doc_tx(rapidjson::kArrayType);
         
-        for(auto tx : mined_txs)
-        {
-            rapidjson::Document &doc = *tx->m_doc;
-            rapidjson::Value tx_node(rapidjson::kObjectType);
-            tx_node.AddMember("sign", rapidjson::Value().CopyFrom(doc["sign"], allocator), allocator);
-            tx_node.AddMember("data", rapidjson::Value().CopyFrom(doc["data"], allocator), allocator);
-            doc_tx.PushBack(tx_node, allocator);
-        }
+            for(auto tx : job->m_mined_txs)
+            {
+                rapidjson::Document &doc = *tx->m_doc;
+                rapidjson::Value tx_node(rapidjson::kObjectType);
+                tx_node.AddMember("sign", rapidjson::Value().CopyFrom(doc["sign"], allocator), allocator);
+                tx_node.AddMember("data", rapidjson::Value().CopyFrom(doc["data"], allocator), allocator);
+                doc_tx.PushBack(tx_node, allocator);
+            }
         
-        doc.AddMember("tx", doc_tx, allocator);
-        {
-            std::lock_guard<std::mutex> guard(m_mine_mutex);
-            m_mine_doc = doc_ptr;
-            m_mine_id_2.store(mine_id_2.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            doc.AddMember("tx", doc_tx, allocator);
+            {
+                std::lock_guard<std::mutex> guard(m_mine_mutex);
+                m_mine_doc = doc_ptr;
+                m_mine_id_2.store(job->m_mine_id, std::memory_order_relaxed);
+            }
+        
+            m_mine_success.store(true, std::memory_order_release);
         }
         
-        m_mine_success.store(true, std::memory_order_release);
+    next_job:
+        ;
     }
 }
 
@@ -718,11 +910,11 @@ void Blockchain::do_command(std::shared_ptr<Command> command)
         rapidjson::StringBuffer buffer;
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
         peer_doc.Accept(writer);
-        leveldb::Status s = m_db->Put(leveldb::WriteOptions(), "peer_score", buffer.GetString());
+        Store_Status s = m_store->put_meta("peer_score", buffer.GetString());
         
         if(!s.ok())
         {
-            printf("clear_peer failed, reason: %s\n", s.ToString().c_str());
+            printf("clear_peer failed, reason: %s\n", s.to_string().c_str());
         } else {
             printf("clear_peer successfully\n");
         }
@@ -824,6 +1016,48 @@ void Blockchain::do_command(std::shared_ptr<Command> command)
         printf("miner total: %u\n", m_miner_pubkeys.size());
         printf("topic count: %u\n", m_topic_list.size());
         printf("uv tx count: %u\n", m_uv_2_txs.size());
+        Pow_Cache *pow_cache = Pow_Cache::instance();
+        printf("pow cache size: %u, hits: %lu, misses: %lu\n", pow_cache->size(), pow_cache->hits(), pow_cache->misses());
+        Block_Cache *block_cache = Block_Cache::instance();
+        printf("block cache size: %u, bytes: %lu (capacity: %lu), hits: %lu, misses: %lu\n", block_cache->size(), \
+               block_cache->bytes(), block_cache->capacity(), block_cache->hits(), block_cache->misses());
+        printf("db commit queue: %lu\n", m_committer.pending_num());
+        printf("pruned fork blocks: %lu, bytes: %lu\n", m_pruned_block_num, m_pruned_bytes);
+        printf("pruned block bodies: 1 ~ %lu, bytes: %lu (prune: %s, depth: %lu)\n", m_pruned_block_id, m_pruned_body_bytes, \
+               m_prune_enable ? "on" : "off", m_prune_depth);
+
+        if(!m_merge_export)
+        {
+            printf("merge_point export: none\n");
+        }
+        else if(!m_merge_export->m_thread.joinable())
+        {
+            printf("merge_point export: block_id: %lu, waiting for the block\n", m_merge_export->m_block_id);
+        }
+        else
+        {
+            printf("merge_point export: block_id: %lu, records: %lu / %lu, bytes: %lu\n", m_merge_export->m_block_id, \
+                   m_merge_export->m_written_num.load(std::memory_order_relaxed), \
+                   m_merge_export->m_record_num.load(std::memory_order_relaxed), \
+                   m_merge_export->m_bytes.load(std::memory_order_relaxed));
+        }
+        
+        rapidjson::Document stat_doc;
+        rapidjson::Value mine_stat;
+        get_mine_stat(mine_stat, stat_doc.GetAllocator());
+        printf("mine hash rate: %lu H/s (threads:", mine_stat["hash_rate"].GetUint64());
+
+        const rapidjson::Value &thread_rates = mine_stat["thread_hash_rate"];
+        
+        for(uint32 i = 0; i < thread_rates.Size(); ++i)
+        {
+            printf(" %lu", thread_rates[i].GetUint64());
+        }
+        
+        printf(")\n");
+        printf("mine remine latency: %lu us (avg: %lu us), remines per min: %u, stale shares: %lu\n", \
+               mine_stat["remine_latency_usec"].GetUint64(), mine_stat["remine_latency_avg_usec"].GetUint64(), \
+               mine_stat["remine_per_min"].GetUint(), mine_stat["stale_share"].GetUint64());
         printf("cur block id: %lu\n", m_cur_block->id());
         auto block_hash = m_cur_block->hash();
         printf("cur block hash: %s\n", block_hash.c_str());
@@ -832,6 +1066,78 @@ void Blockchain::do_command(std::shared_ptr<Command> command)
         std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
         printf("cur block hash (hex): %s\n>", hex_hash.c_str());
     }
+    else if(command->m_cmd == "merge_export")
+    {
+        uint64 block_id = 0;
+        fly::base::string_to(command->m_params[0], block_id);
+
+        if(m_merge_export)
+        {
+            printf("merge_export failed, the export of block_id: %lu is not finished yet\n>", m_merge_export->m_block_id);
+            return;
+        }
+
+        // the state of older blocks is gone, only the tip or a coming block can be exported
+        if(block_id < m_cur_block->id())
+        {
+            printf("merge_export failed, block_id: %lu is lower than cur block id: %lu\n>", block_id, m_cur_block->id());
+            return;
+        }
+        
+        m_merge_export.reset(new Merge_Export);
+        m_merge_export->m_block_id = block_id;
+        m_merge_export->m_path = command->m_params[1];
+
+        if(block_id > m_cur_block->id())
+        {
+            printf("merge_export will start when block_id: %lu is reached\n>", block_id);
+            return;
+        }
+        
+        check_merge_export();
+        printf(">");
+    }
+    else if(command->m_cmd == "db_stats")
+    {
+        std::string stats;
+        
+        if(m_store->get_property("leveldb.stats", &stats))
+        {
+            printf("%s\n", stats.c_str());
+        }
+
+        if(m_store->get_property("leveldb.sstables", &stats))
+        {
+            printf("%s\n", stats.c_str());
+        }
+
+        // block records are keyed by their base64 hash, none of the other prefixes
+        // below can be the start of one, so the rest of the total is block records.
+        const char* const prefixes[][2] = {
+            {"c:", "child edges"},
+            {"h:", "height index"},
+            {"snapshot_", "snapshots"}
+        };
+        
+        uint64 total_size = m_store->approximate_size("", "\xff");
+        uint64 prefix_total_size = 0;
+        printf("approximate sizes (bytes on disk):\n");
+        
+        for(auto &prefix : prefixes)
+        {
+            std::string start = prefix[0];
+            std::string limit = start;
+            ++limit.back();
+            uint64 size = m_store->approximate_size(start, limit);
+            prefix_total_size += size;
+            printf("%s (%s*): %lu\n", prefix[1], prefix[0], size);
+        }
+
+        printf("block records: %lu\n", total_size > prefix_total_size ? total_size - prefix_total_size : 0);
+        printf("total: %lu\n", total_size);
+        printf("config: cache_size: %lu, bloom_bits: %u, write_buffer_size: %lu, compression: %s\n>", m_db_cache_size, \
+               m_db_bloom_bits, m_db_write_buffer_size, m_db_compression ? "snappy" : "none");
+    }
     else if(command->m_cmd == "lock")
     {
         if(m_is_locked)
@@ -1532,38 +1838,279 @@ void Blockchain::do_command(std::shared_ptr<Command> command)
     }
 }
 
-void Blockchain::do_message()
+void Blockchain::pre_verify(std::list<std::unique_ptr<fly::net::Message<Json>>> &peer_messages, \
+                            std::list<std::unique_ptr<fly::net::Message<Wsock>>> &wsock_messages)
 {
-    while(!m_stop.load(std::memory_order_relaxed))
-    {
-        bool peer_empty = false;
-        bool wsock_empty = false;
-        std::list<std::unique_ptr<fly::net::Message<Json>>> peer_messages;
-        std::list<std::unique_ptr<fly::net::Message<Wsock>>> wsock_messages;
+    // the expensive part of the checks done by do_peer_message and do_wsock_message runs here
+    // on Verify_Pool for the whole batch. only well-formed fields are picked up, the handlers
+    // still do every check themselves and find the results in Pow_Cache and m_verified_signs.
+    // a block gets its pow checked only if the handler would reach that check as well: it comes
+    // from a registered peer, is well-formed, is wanted, and its signature is valid.
+    std::vector<std::string> pow_hashes;
+    std::vector<std::string> pow_datas;
+    std::vector<uint32> pow_zero_bits;
+    std::vector<std::string> sign_pubkeys;
+    std::vector<std::string> sign_hashes;
+    std::vector<std::string> sign_signs;
+    std::vector<uint32> sign_pow_idxs;
+    net::p2p::Node *p2p_node = net::p2p::Node::instance();
+    
+    auto add_sign = [&](const rapidjson::Value &sign, const rapidjson::Value &data) {
+        if(!sign.IsString() || !data.IsObject() || !data.HasMember("pubkey") || !data["pubkey"].IsString())
+        {
+            return;
+        }
+
+        std::string pubkey = data["pubkey"].GetString();
+        
+        if(pubkey.length() != 88 || !is_base64_char(pubkey))
+        {
+            return;
+        }
+
+        std::string tx_sign = sign.GetString();
+
+        if(!is_base64_char(tx_sign))
+        {
+            return;
+        }
+        
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        data.Accept(writer);
+        std::string tx_id = coin_hash_b64(buffer.GetString(), buffer.GetSize());
+
+        if(m_tx_map.find(tx_id) != m_tx_map.end() || m_uv_tx_ids.find(tx_id) != m_uv_tx_ids.end())
+        {
+            return;
+        }
+        
+        sign_pubkeys.push_back(pubkey);
+        sign_hashes.push_back(tx_id);
+        sign_signs.push_back(tx_sign);
+        sign_pow_idxs.push_back((uint32)-1);
+    };
+    auto is_registered = [&](fly::net::Message<Json> &message) -> bool {
+        std::shared_ptr<fly::net::Connection<Json>> connection = message.get_connection();
+        std::lock_guard<std::mutex> guard(p2p_node->m_peer_mutex);
+        auto iter_reg = p2p_node->m_peers.find(connection->id());
+
+        return iter_reg != p2p_node->m_peers.end() && iter_reg->second->m_connection == connection;
+    };
+    auto add_block = [&](const rapidjson::Document &doc, uint32 cmd) {
+        if(!doc.HasMember("hash") || !doc["hash"].IsString() || !doc["sign"].IsString())
+        {
+            return;
+        }
+
+        std::string block_hash = doc["hash"].GetString();
+        std::string block_sign = doc["sign"].GetString();
+        const rapidjson::Value &data = doc["data"];
+            
+        if(block_hash.length() != 44 || !is_base64_char(block_hash) || !is_base64_char(block_sign))
+        {
+            return;
+        }
+
+        if(m_blocks.find(block_hash) != m_blocks.end() || m_pending_blocks.find(block_hash) != m_pending_blocks.end())
+        {
+            return;
+        }
+        
+        if(!data.IsObject() || !data.HasMember("id") || !data["id"].IsUint64() || !data.HasMember("zero_bits") \
+           || !data["zero_bits"].IsUint() || !data.HasMember("miner") || !data["miner"].IsString())
+        {
+            return;
+        }
+
+        uint64 block_id = data["id"].GetUint64();
+        uint32 zero_bits = data["zero_bits"].GetUint();
+        std::string miner_pubkey = data["miner"].GetString();
+        
+        if(zero_bits == 0 || zero_bits >= 256 || miner_pubkey.length() != 88 || !is_base64_char(miner_pubkey))
+        {
+            return;
+        }
+        
+        if(cmd == net::p2p::BLOCK_BROADCAST)
+        {
+            if(data.MemberCount() != 8 || !doc.HasMember("pow") || !doc["pow"].IsArray() || doc["pow"].Size() != 9)
+            {
+                return;
+            }
+
+            const rapidjson::Value &pow_array = doc["pow"];
+            
+            for(uint32 i = 0; i < 9; ++i)
+            {
+                if(!pow_array[i].IsUint())
+                {
+                    return;
+                }
+            }
+
+            Accum_Pow declared_pow(pow_array[0].GetUint(), pow_array[1].GetUint(), pow_array[2].GetUint(), pow_array[3].GetUint(), pow_array[4].GetUint(), \
+                                   pow_array[5].GetUint(), pow_array[6].GetUint(), pow_array[7].GetUint(), pow_array[8].GetUint());
+
+            // blocks far ahead go through the BLOCK_BROADCAST_1 exchange first
+            if(!m_most_difficult_block->difficult_than_me(declared_pow) || block_id > m_cur_block->id() + 1000)
+            {
+                return;
+            }
+        }
+        else if(m_pending_brief_reqs.find(block_hash) == m_pending_brief_reqs.end())
+        {
+            return;
+        }
+
+        if(block_id == 0 || (m_merge_point->m_import_block_id > 0 && block_id <= m_merge_point->m_import_block_id))
+        {
+            return;
+        }
         
-        if(m_wsock_messages.pop(wsock_messages))
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        data.Accept(writer);
+        sign_pubkeys.push_back(miner_pubkey);
+        sign_hashes.push_back(block_hash);
+        sign_signs.push_back(block_sign);
+        sign_pow_idxs.push_back(pow_hashes.size());
+        pow_hashes.push_back(block_hash);
+        pow_datas.push_back(std::string(buffer.GetString(), buffer.GetSize()));
+        pow_zero_bits.push_back(zero_bits);
+    };
+    
+    for(auto &message : peer_messages)
+    {
+        rapidjson::Document &doc = message->doc();
+        uint32 type = message->type();
+        uint32 cmd = message->cmd();
+        
+        if(!doc.HasMember("sign") || !doc.HasMember("data"))
+        {
+            continue;
+        }
+        
+        if(type == net::p2p::MSG_TX && cmd == net::p2p::TX_BROADCAST)
+        {
+            add_sign(doc["sign"], doc["data"]);
+        }
+        else if(type == net::p2p::MSG_BLOCK && (cmd == net::p2p::BLOCK_BROADCAST || cmd == net::p2p::BLOCK_BRIEF_RSP))
         {
-            for(auto &message : wsock_messages)
+            if(is_registered(*message))
             {
-                do_wsock_message(message);
+                add_block(doc, cmd);
             }
         }
-        else
+    }
+
+    for(auto &message : wsock_messages)
+    {
+        rapidjson::Document &doc = message->doc();
+        
+        if(message->type() != net::api::MSG_TX || message->cmd() != net::api::TX_CMD)
         {
-            wsock_empty = true;
+            continue;
         }
 
-        if(m_peer_messages.pop(peer_messages))
+        if(doc.HasMember("sign") && doc.HasMember("data"))
+        {
+            add_sign(doc["sign"], doc["data"]);
+        }
+    }
+    
+    Verify_Pool *verify_pool = Verify_Pool::instance();
+    uint32 sign_num = sign_pubkeys.size();
+    std::vector<char> pow_wanted(pow_hashes.size());
+
+    if(sign_num > 0)
+    {
+        std::vector<char> sign_ok(sign_num);
+        verify_pool->run(Verify_Pool::LANE_SIGN, sign_num, [&](uint32 i) {
+                sign_ok[i] = check_sign(sign_pubkeys[i], sign_hashes[i], sign_signs[i]);
+            });
+        
+        for(uint32 i = 0; i < sign_num; ++i)
         {
-            for(auto &message : peer_messages)
+            if(sign_ok[i])
             {
-                do_peer_message(message);
+                m_verified_signs.insert(sign_pubkeys[i] + sign_hashes[i] + sign_signs[i]);
+
+                if(sign_pow_idxs[i] != (uint32)-1)
+                {
+                    pow_wanted[sign_pow_idxs[i]] = 1;
+                }
             }
         }
-        else
+    }
+
+    // blocks with a bad signature are punished by the handler before it gets to the pow
+    uint32 pow_num = 0;
+
+    for(uint32 i = 0; i < pow_hashes.size(); ++i)
+    {
+        if(!pow_wanted[i])
+        {
+            continue;
+        }
+
+        if(pow_num != i)
+        {
+            pow_hashes[pow_num] = std::move(pow_hashes[i]);
+            pow_datas[pow_num] = std::move(pow_datas[i]);
+            pow_zero_bits[pow_num] = pow_zero_bits[i];
+        }
+        
+        ++pow_num;
+    }
+    
+    if(pow_num > 0)
+    {
+        // verify_hash fills Pow_Cache, the failed index it returns is of no use here
+        verify_pool->run(Verify_Pool::LANE_POW, (pow_num + ASIC_RESISTANT_BATCH_NUM - 1) / ASIC_RESISTANT_BATCH_NUM, [&](uint32 i) {
+                uint32 start = i * ASIC_RESISTANT_BATCH_NUM;
+                uint32 num = std::min(pow_num - start, ASIC_RESISTANT_BATCH_NUM);
+                
+                for(uint32 j = start; j < start + num;)
+                {
+                    j += verify_hash(&pow_hashes[j], &pow_datas[j], &pow_zero_bits[j], start + num - j) + 1;
+                }
+            });
+    }
+}
+
+void Blockchain::do_message()
+{
+    while(!m_stop.load(std::memory_order_relaxed))
+    {
+        bool peer_empty = false;
+        bool wsock_empty = false;
+        std::list<std::unique_ptr<fly::net::Message<Json>>> peer_messages;
+        std::list<std::unique_ptr<fly::net::Message<Wsock>>> wsock_messages;
+        
+        if(!m_wsock_messages.pop(wsock_messages))
+        {
+            wsock_empty = true;
+        }
+
+        if(!m_peer_messages.pop(peer_messages))
         {
             peer_empty = true;
         }
+        
+        pre_verify(peer_messages, wsock_messages);
+        
+        for(auto &message : wsock_messages)
+        {
+            do_wsock_message(message);
+        }
+        
+        for(auto &message : peer_messages)
+        {
+            do_peer_message(message);
+        }
+        
+        m_verified_signs.clear();
 
         bool command_empty = false;
         std::list<std::shared_ptr<Command>> commands;
@@ -1587,6 +2134,13 @@ void Blockchain::do_message()
             sync_block();
             do_uv_tx();
             m_block_changed = false;
+
+            if(m_cur_block->id() >= m_last_snapshot_id + SNAPSHOT_INTERVAL)
+            {
+                save_snapshot();
+            }
+
+            check_merge_export();
         }
 
         std::atomic<uint64> mine_id_2 {0};
@@ -1629,6 +2183,11 @@ void Blockchain::do_message()
                     last_mine_id.store(mine_id_2.load(std::memory_order_relaxed), std::memory_order_relaxed);
                 }
             }
+            else
+            {
+                // solved a template that was already replaced by a newer block
+                m_stale_share_cnt.fetch_add(1, std::memory_order_relaxed);
+            }
         }
         else if(peer_empty && wsock_empty && !called && command_empty)
         {
@@ -1646,47 +2205,50 @@ void Blockchain::stop()
 void Blockchain::wait()
 {
     m_msg_thread.join();
-    m_mine_thread.join();
-    m_score_thread.join();
-}
 
-bool Blockchain::start(std::string db_path, bool repair_db)
-{
-    // firstly, we need verify __asic_resistant_data__
-    if(__asic_resistant_data__.size() != ASIC_RESISTANT_DATA_NUM)
+    if(m_merge_export && m_merge_export->m_thread.joinable())
     {
-        CONSOLE_LOG_FATAL("verify __asic_resistant_data__ failed, length is not 5 * 1024 * 1024");
-        
-        return false;
+        m_merge_export->m_thread.join();
     }
-    
-    uint32 val_sum = 0, val_mult = 0, val_xor = 0;
 
-    for(uint32 i = 0; i < ASIC_RESISTANT_DATA_NUM; ++i)
+    // the batch of an unfinished run is dropped, the next start picks the blocks again
+    if(m_prune_job && m_prune_job->m_thread.joinable())
     {
-        val_sum += __asic_resistant_data__[i];
-        val_mult = (val_mult + __asic_resistant_data__[i]) * (val_mult ^ __asic_resistant_data__[i]);
-        val_xor ^= __asic_resistant_data__[i];
+        m_prune_job->m_thread.join();
     }
+    
+    m_committer.stop();
+    m_mine_thread.join();
 
-    if(val_sum != (uint32)278601749 || val_mult != (uint32)3863002825 || val_xor != (uint32)394700363)
+    for(auto &worker_thread : m_mine_worker_threads)
     {
-        CONSOLE_LOG_FATAL("verify __asic_resistant_data__ failed, invalid data");
-
-        return false;
+        worker_thread.join();
     }
     
-    CONSOLE_LOG_INFO("verify __asic_resistant_data__ ok");
+    m_score_thread.join();
+}
 
+bool Blockchain::start(std::string db_path, bool repair_db)
+{
     leveldb::Options options;
     options.create_if_missing = true;
     options.max_open_files = 50000;
     options.max_file_size = 100 * (1 << 20);
-    leveldb::Status s;
+    options.write_buffer_size = m_db_write_buffer_size;
+    options.compression = m_db_compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    m_db_cache = leveldb::NewLRUCache(m_db_cache_size);
+    options.block_cache = m_db_cache;
 
+    // block hashes are random, almost every Get misses all but one table of a level
+    if(m_db_bloom_bits > 0)
+    {
+        m_db_filter = leveldb::NewBloomFilterPolicy(m_db_bloom_bits);
+        options.filter_policy = m_db_filter;
+    }
+    
     if(repair_db)
     {
-        s = leveldb::RepairDB(db_path, options);
+        leveldb::Status s = leveldb::RepairDB(db_path, options);
         
         if(!s.ok())
         {
@@ -1700,13 +2262,55 @@ bool Blockchain::start(std::string db_path, bool repair_db)
         return true;
     }
     
-    s = leveldb::DB::Open(options, db_path, &m_db);
+    if(m_db_in_memory)
+    {
+        CONSOLE_LOG_INFO("db engine is in-memory, nothing will be written to %s", db_path.c_str());
+        m_store = new Memory_Store;
+    }
+    else
+    {
+        leveldb::DB *db = NULL;
+        leveldb::Status s = leveldb::DB::Open(options, db_path, &db);
     
-    if(!s.ok())
+        if(!s.ok())
+        {
+            CONSOLE_LOG_FATAL("open leveldb failed: %s", s.ToString().c_str());
+        
+            return false;
+        }
+
+        m_store = new Leveldb_Store(db);
+    }
+
+    Store_Status s;
+
+    // blocks up to trusted_id were fully verified by this node before they were committed,
+    // so their pow and signatures are not checked again.
+    uint64 trusted_id = 0;
+    std::string trusted_hash;
+
+    if(m_fast_start)
     {
-        CONSOLE_LOG_FATAL("open leveldb failed: %s", s.ToString().c_str());
+        if(!load_verify_key(db_path + ".verify_key"))
+        {
+            return false;
+        }
         
-        return false;
+        if(!load_verified_marker(trusted_id, trusted_hash))
+        {
+            return false;
+        }
+
+        if(m_full_verify)
+        {
+            CONSOLE_LOG_INFO("full verify is requested, verified marker is ignored");
+            trusted_id = 0;
+        }
+        else if(trusted_id > 0)
+        {
+            CONSOLE_LOG_INFO("fast start, skip verifying pow and signatures of blocks up to block_id: %lu, block_hash: %s", \
+                             trusted_id, trusted_hash.c_str());
+        }
     }
     
     struct Child_Block
@@ -1728,13 +2332,13 @@ bool Blockchain::start(std::string db_path, bool repair_db)
     if(m_merge_point->m_import_block_id == 0)
     {
         std::string block_0;
-        s = m_db->Get(leveldb::ReadOptions(), "0", &block_0);
+        s = m_committer.get("0", &block_0);
     
         if(!s.ok())
         {
-            if(!s.IsNotFound())
+            if(!s.is_not_found())
             {
-                CONSOLE_LOG_FATAL("read block_0 from leveldb failed: %s", s.ToString().c_str());
+                CONSOLE_LOG_FATAL("read block_0 from leveldb failed: %s", s.to_string().c_str());
 
                 return false;
             }
@@ -1762,27 +2366,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             char * ptr = buffer_1.Push(16);
             memcpy(ptr, "another_32_bytes", 16);
             coin_hash(buffer_1.GetString(), buffer_1.GetSize(), p + 32);
-            uint32 arr_16[16] = {0};
-        
-            for(uint32 i = 0; i < 16; ++i)
-            {
-                arr_16[i] = ntohl(buf[i]);
-            }
-    
-            for(uint32 i = 0; i < ASIC_RESISTANT_DATA_NUM;)
-            {
-                for(int j = 0; j < 16; ++j)
-                {
-                    arr_16[j] = (arr_16[j] + __asic_resistant_data__[i + j]) * (arr_16[j] ^ __asic_resistant_data__[i + j]);
-                }
-        
-                i += 16;
-            }
-    
-            for(uint32 i = 0; i < 16; ++i)
-            {
-                buf[i] = htonl(arr_16[i]);
-            }
+            asic_resistant_mix(buf);
         
             ptr = buffer_1.Push(88);
             std::string p_b64 = fly::base::base64_encode(p, 64);
@@ -1796,7 +2380,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             rapidjson::StringBuffer buffer_2;
             rapidjson::Writer<rapidjson::StringBuffer> writer_2(buffer_2);
             doc.Accept(writer_2);
-            s = m_db->Put(leveldb::WriteOptions(), "0", buffer_2.GetString());
+            s = m_store->put_meta("0", buffer_2.GetString());
         
             if(!s.ok())
             {
@@ -1812,7 +2396,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             rapidjson::StringBuffer buffer_3;
             rapidjson::Writer<rapidjson::StringBuffer> writer_3(buffer_3);
             peer_doc.Accept(writer_3);
-            s = m_db->Put(leveldb::WriteOptions(), "peer_score", buffer_3.GetString());
+            s = m_store->put_meta("peer_score", buffer_3.GetString());
         
             if(!s.ok())
             {
@@ -1820,7 +2404,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             }
         
             //try get again
-            s = m_db->Get(leveldb::ReadOptions(), "0", &block_0);
+            s = m_committer.get("0", &block_0);
 
             if(!s.ok())
             {
@@ -2057,580 +2641,504 @@ bool Blockchain::start(std::string db_path, bool repair_db)
         m_block_by_id.insert(std::make_pair(0, genesis_block));
         the_most_difficult_block = genesis_block;
 
-        for(rapidjson::Value::ConstValueIterator iter = children.Begin(); iter != children.End(); ++iter)
+        std::vector<std::string> children_hashes;
+        get_children(doc, "0", children_hashes);
+
+        for(auto &child_hash : children_hashes)
         {
-            Child_Block child_block(genesis_block, iter->GetString());
+            Child_Block child_block(genesis_block, child_hash);
             block_list.push_back(child_block);
         }
     }
     else
     {
-        std::ifstream ifs(m_merge_point->m_import_path);
-        rapidjson::IStreamWrapper isw(ifs);
+        // the first pass only checks the sha1, nothing is applied from a damaged file. then blocks
+        // are read before the rest, tx_map and topics refer to blocks by id and files exported by
+        // older versions list the blocks after them. only the small members at the top are
+        // collected into doc, the arrays are applied one element at a time.
+        std::set<std::string> array_names {"accounts", "blocks", "miners", "tx_map", "topics"};
+        Merge_Point_Reader reader(m_merge_point->m_import_path, array_names);
         rapidjson::Document doc;
-        doc.ParseStream(isw);
+        doc.SetObject();
 
-        if(doc.HasParseError())
+        if(!reader.verify())
         {
             CONSOLE_LOG_FATAL("merge_point import failed, import_path: %s, reason: %s", \
-                              m_merge_point->m_import_path.c_str(), GetParseError_En(doc.GetParseError()));
+                              m_merge_point->m_import_path.c_str(), reader.error().c_str());
             return false;
         }
+        
+        bool read_ok = reader.read([&](const std::string &name, rapidjson::Document &obj) -> bool {
+                if(name != "blocks")
+                {
+                    return true;
+                }
+            
+                if(!obj.IsObject())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, block should be object");
+                    return false;
+                }
 
-        if(!doc.HasMember("sha1"))
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, sha1 field not found");
-            return false;
-        }
+                uint64 block_id = obj["id"].GetUint64();
+                std::string block_hash = obj["hash"].GetString();
 
-        if(!doc["sha1"].IsString())
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, sha1 field should be string");
-            return false;
-        }
+                if(!is_base64_char(block_hash))
+                {
+                    ASKCOIN_RETURN false;
+                }
+
+                if(block_hash.length() != 44)
+                {
+                    ASKCOIN_RETURN false;
+                }
+            
+                std::shared_ptr<Block> block(new Block(block_id, obj["utc"].GetUint64(), obj["version"].GetUint(), \
+                                                       obj["zero_bits"].GetUint(), block_hash));
+                block->m_in_main_chain = true;
+                auto rp = m_blocks.insert(std::make_pair(block_hash, block));
+            
+                if(!rp.second)
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, duplicated block hash");
+                    return false;
+                }
+
+                auto rp1 = m_block_by_id.insert(std::make_pair(block_id, block));
+
+                if(!rp1.second)
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, duplicated block id");
+                    return false;
+                }
 
-        std::string sha1_b64 = doc["sha1"].GetString();
+                return true;
+            });
 
-        if(!is_base64_char(sha1_b64))
+        if(!read_ok)
         {
-            CONSOLE_LOG_FATAL("merge_point import failed, sha1 field is invalid");
-            return false;
-        }
-
-        if(sha1_b64.length() != 28)
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, length of sha1 field is invalid");
+            if(!reader.error().empty())
+            {
+                CONSOLE_LOG_FATAL("merge_point import failed, import_path: %s, reason: %s", \
+                                  m_merge_point->m_import_path.c_str(), reader.error().c_str());
+            }
+            
             return false;
         }
         
-        if(!doc.RemoveMember("sha1"))
+        for(auto name : {"accounts", "blocks", "miners", "tx_map", "topics"})
         {
-            ASKCOIN_RETURN false;
+            if(!reader.has_member(name))
+            {
+                CONSOLE_LOG_FATAL("merge_point import failed, %s field not found", name);
+                return false;
+            }
         }
         
-        rapidjson::StringBuffer buffer_sha1;
-        rapidjson::Writer<rapidjson::StringBuffer> writer_sha1(buffer_sha1);
-        doc.Accept(writer_sha1);
-        char buf[20] = {0};
-
-        if(!fly::base::sha1(buffer_sha1.GetString(), buffer_sha1.GetSize(), buf, 20))
-        {
-            ASKCOIN_RETURN false;
-        }
+        // referrers are set after all accounts exist, like the accounts of the same block
+        std::vector<std::pair<std::shared_ptr<Account>, uint64>> referrers;
         
-        std::string sha1_b64_verify = fly::base::base64_encode(buf, 20);
+        read_ok = reader.read([&](const std::string &name, rapidjson::Document &obj) -> bool {
+                if(name == "blocks")
+                {
+                    return true;
+                }
+            
+                if(name == "accounts")
+                {
+                    if(!obj.IsObject())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, account should be object");
+                        return false;
+                    }
+            
+                    auto account = std::make_shared<Account>(obj["id"].GetUint64(), obj["name"].GetString(), \
+                                                             obj["pubkey"].GetString(), obj["avatar"].GetUint(), obj["block_id"].GetUint64());
+                    uint64 account_id = account->id();
+                    auto rp = m_account_by_id.insert(std::make_pair(account_id, account));
 
-        if(sha1_b64 != sha1_b64_verify)
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, data of import file is invalid");
-            return false;
-        }
-        
-        if(!doc.HasMember("accounts"))
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, accounts field not found");
-            return false;
-        }
-        
-        const rapidjson::Value &accounts = doc["accounts"];
-        
-        if(!accounts.IsArray())
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, accounts field should be array");
-            return false;
-        }
+                    if(!rp.second)
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, duplicated account id");
+                        return false;
+                    }
 
-        uint32 account_num = accounts.Size();
+                    if(!is_base64_char(account->name()))
+                    {
+                        ASKCOIN_RETURN false;
+                    }
 
-        for(uint32 i = 0; i < account_num; ++i)
-        {
-            const rapidjson::Value &obj = accounts[i];
+                    auto rp1 = m_account_names.insert(account->name());
 
-            if(!obj.IsObject())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, account should be object");
-                return false;
-            }
+                    if(!rp1.second)
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, duplicated account name");
+                        return false;
+                    }
             
-            auto account = std::make_shared<Account>(obj["id"].GetUint64(), obj["name"].GetString(), \
-                                                     obj["pubkey"].GetString(), obj["avatar"].GetUint(), obj["block_id"].GetUint64());
-            uint64 account_id = account->id();
-            auto rp = m_account_by_id.insert(std::make_pair(account_id, account));
+                    account->set_balance(obj["balance"].GetUint64());
+            
+                    if(account_id == 0)
+                    {
+                        m_reserve_fund_account = account;
+                    }
+                    else
+                    {
+                        if(m_cur_account_id < account_id)
+                        {
+                            m_cur_account_id = account_id;
+                        }
+                
+                        m_account_by_pubkey.insert(std::make_pair(account->pubkey(), account));
+                    }
 
-            if(!rp.second)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, duplicated account id");
-                return false;
-            }
+                    if(account_id > 1)
+                    {
+                        if(!obj.HasMember("referrer"))
+                        {
+                            CONSOLE_LOG_FATAL("merge_point import failed, referrer field not found");
+                            return false;
+                        }
 
-            if(!is_base64_char(account->name()))
-            {
-                ASKCOIN_RETURN false;
-            }
+                        referrers.push_back(std::make_pair(account, obj["referrer"].GetUint64()));
+                    }
+
+                    return true;
+                }
+            
+                if(name == "miners")
+                {
+                    if(!obj.IsString())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, miner should be string");
+                        return false;
+                    }
 
-            auto rp1 = m_account_names.insert(account->name());
+                    std::string pubkey = obj.GetString();
 
-            if(!rp1.second)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, duplicated account name");
-                return false;
-            }
+                    if(!is_base64_char(pubkey))
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, miner pubkey is invalid");
+                        return false;
+                    }
             
-            account->set_balance(obj["balance"].GetUint64());
+                    if(pubkey.length() != 88)
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, miner pubkey length should be 88 bytes");
+                        return false;
+                    }
             
-            if(account_id == 0)
-            {
-                m_reserve_fund_account = account;
-            }
-            else
-            {
-                if(m_cur_account_id < account_id)
-                {
-                    m_cur_account_id = account_id;
+                    auto rp = m_miner_pubkeys.insert(pubkey);
+            
+                    if(!rp.second)
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, duplicated miner pubkey");
+                        return false;
+                    }
+
+                    return true;
                 }
-                
-                m_account_by_pubkey.insert(std::make_pair(account->pubkey(), account));
-            }
-        }
+            
+                if(name == "tx_map")
+                {
+                    if(!obj.IsObject())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, element in tx_map should be object");
+                        return false;
+                    }
 
-        for(uint32 i = 0; i < account_num; ++i)
-        {
-            const rapidjson::Value &obj = accounts[i];
-            uint64 account_id = obj["id"].GetUint64();
+                    uint64 block_id = obj["block_id"].GetUint64();
+                    std::string tx_id = obj["tx_id"].GetString();
 
-            if(account_id > 1)
-            {
-                auto &account = m_account_by_id[account_id];
+                    if(!is_base64_char(tx_id))
+                    {
+                        ASKCOIN_RETURN false;
+                    }
+
+                    if(tx_id.length() != 44)
+                    {
+                        ASKCOIN_RETURN false;
+                    }
+
+                    auto iter = m_block_by_id.find(block_id);
+            
+                    if(iter == m_block_by_id.end())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, block in tx_map not exist");
+                        return false;
+                    }
+            
+                    auto rp = m_tx_map.insert(std::make_pair(tx_id,iter->second));
+
+                    if(!rp.second)
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, duplicated tx id in tx_map");
+                        return false;
+                    }
+
+                    m_import_tx_map[block_id].push_back(tx_id);
+
+                    return true;
+                }
 
-                if(!obj.HasMember("referrer"))
+                if(name != "topics")
                 {
-                    CONSOLE_LOG_FATAL("merge_point import failed, referrer field not found");
+                    doc.AddMember(rapidjson::Value(name.c_str(), doc.GetAllocator()), rapidjson::Value(obj, doc.GetAllocator()), doc.GetAllocator());
+                
+                    return true;
+                }
+            
+                if(!obj.IsObject())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, topic should be object");
                     return false;
                 }
 
-                auto iter = m_account_by_id.find(obj["referrer"].GetUint64());
-
-                if(iter == m_account_by_id.end())
+                if(!obj.HasMember("block_id"))
                 {
-                    CONSOLE_LOG_FATAL("merge_point import failed, referrer not exist");
+                    CONSOLE_LOG_FATAL("merge_point import failed, block_id in topics not found");
                     return false;
                 }
 
-                account->set_referrer(iter->second);
-            }
-        }
-
-        if(!doc.HasMember("blocks"))
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, blocks field not found");
-            return false;
-        }
-        
-        const rapidjson::Value &blocks = doc["blocks"];
-
-        if(!blocks.IsArray())
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, blocks field should be array");
-            return false;
-        }
-
-        uint32 block_num = blocks.Size();
+                if(!obj["block_id"].IsUint64())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, block_id in topics should be uint64");
+                    return false;
+                }
 
-        for(uint32 i = 0; i < block_num; ++i)
-        {
-            const rapidjson::Value &obj = blocks[i];
+                uint64 block_id = obj["block_id"].GetUint64();
+                auto iter = m_block_by_id.find(block_id);
 
-            if(!obj.IsObject())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, block should be object");
-                return false;
-            }
+                if(iter == m_block_by_id.end())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, block_id in topics not exist");
+                    return false;
+                }
 
-            uint64 block_id = obj["id"].GetUint64();
-            std::string block_hash = obj["hash"].GetString();
+                if(!obj.HasMember("owner"))
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, owner in topics not found");
+                    return false;
+                }
 
-            if(!is_base64_char(block_hash))
-            {
-                ASKCOIN_RETURN false;
-            }
+                if(!obj["owner"].IsUint64())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, owner in topics should be uint64");
+                    return false;
+                }
 
-            if(block_hash.length() != 44)
-            {
-                ASKCOIN_RETURN false;
-            }
+                uint64 owner_id = obj["owner"].GetUint64();
+                auto iter1 = m_account_by_id.find(owner_id);
             
-            std::shared_ptr<Block> block(new Block(block_id, obj["utc"].GetUint64(), obj["version"].GetUint(), \
-                                                   obj["zero_bits"].GetUint(), block_hash));
-            block->m_in_main_chain = true;
-            auto rp = m_blocks.insert(std::make_pair(block_hash, block));
+                if(iter1 == m_account_by_id.end())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, owner in topics not exist");
+                    return false;
+                }
             
-            if(!rp.second)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, duplicated block hash");
-                return false;
-            }
+                auto owner = iter1->second;
+                std::string tx_id = obj["key"].GetString();
 
-            auto rp1 = m_block_by_id.insert(std::make_pair(block_id, block));
+                if(!is_base64_char(tx_id))
+                {
+                    ASKCOIN_RETURN false;
+                }
 
-            if(!rp1.second)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, duplicated block id");
-                return false;
-            }
-        }
-        
-        if(!doc.HasMember("miners"))
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, miners field not found");
-            return false;
-        }
+                if(tx_id.length() != 44)
+                {
+                    ASKCOIN_RETURN false;
+                }
+
+                std::shared_ptr<Topic> topic(new Topic(tx_id, obj["data"].GetString(), iter->second, obj["total"].GetUint64()));
+                topic->set_balance(obj["balance"].GetUint64());
+                topic->set_owner(owner);
+                owner->m_topic_list.push_back(topic);
+                m_topic_list.push_back(topic);
+                m_topics.insert(std::make_pair(tx_id, topic));
+            
+                if(!obj.HasMember("members"))
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, members in topics not found");
+                    return false;
+                }
         
-        const rapidjson::Value &miners = doc["miners"];
+                const rapidjson::Value &members = obj["members"];
 
-        if(!miners.IsArray())
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, miners field should be array");
-            return false;
-        }
+                if(!members.IsArray())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, members in topics should be array");
+                    return false;
+                }
 
-        uint32 miner_num = miners.Size();
+                uint32 member_num = members.Size();
 
-        for(uint32 i = 0; i < miner_num; ++i)
-        {
-            const rapidjson::Value &val = miners[i];
+                for(uint32 i = 0; i < member_num; ++i)
+                {
+                    const rapidjson::Value &val = members[i];
 
-            if(!val.IsString())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, miner should be string");
-                return false;
-            }
+                    if(!val.IsUint64())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, member should be uint64");
+                        return false;
+                    }
 
-            std::string pubkey = val.GetString();
+                    uint64 member_id = val.GetUint64();
+                    auto iter = m_account_by_id.find(member_id);
 
-            if(!is_base64_char(pubkey))
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, miner pubkey is invalid");
-                return false;
-            }
-            
-            if(pubkey.length() != 88)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, miner pubkey length should be 88 bytes");
-                return false;
-            }
-            
-            auto rp = m_miner_pubkeys.insert(pubkey);
-            
-            if(!rp.second)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, duplicated miner pubkey");
-                return false;
-            }
-        }
-        
-        if(!doc.HasMember("tx_map"))
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, tx_map field not found");
-            return false;
-        }
+                    if(iter == m_account_by_id.end())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, member in topics not exist");
+                        return false;
+                    }
+                
+                    auto member = iter->second;
+                    member->m_joined_topic_list.push_back(topic);
+                    topic->add_member("tx_id", member);
+                }
+
+                if(!obj.HasMember("replies"))
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, replies in topics not found");
+                    return false;
+                }
         
-        const rapidjson::Value &tx_map = doc["tx_map"];
+                const rapidjson::Value &replies = obj["replies"];
 
-        if(!tx_map.IsArray())
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, tx_map field should be array");
-            return false;
-        }
+                if(!replies.IsArray())
+                {
+                    CONSOLE_LOG_FATAL("merge_point import failed, replies in topics should be array");
+                    return false;
+                }
 
-        uint32 tx_num = tx_map.Size();
+                uint32 reply_num = replies.Size();
 
-        for(uint32 i = 0; i < tx_num; ++i)
-        {
-            const rapidjson::Value &obj = tx_map[i];
+                for(uint32 i = 0; i < reply_num; ++i)
+                {
+                    const rapidjson::Value &obj = replies[i];
 
-            if(!obj.IsObject())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, element in tx_map should be object");
-                return false;
-            }
-
-            uint64 block_id = obj["block_id"].GetUint64();
-            std::string tx_id = obj["tx_id"].GetString();
-
-            if(!is_base64_char(tx_id))
-            {
-                ASKCOIN_RETURN false;
-            }
-
-            if(tx_id.length() != 44)
-            {
-                ASKCOIN_RETURN false;
-            }
-
-            auto iter = m_block_by_id.find(block_id);
-            
-            if(iter == m_block_by_id.end())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, block in tx_map not exist");
-                return false;
-            }
-            
-            auto rp = m_tx_map.insert(std::make_pair(tx_id,iter->second));
-
-            if(!rp.second)
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, duplicated tx id in tx_map");
-                return false;
-            }
-
-            m_import_tx_map[block_id].push_back(tx_id);
-        }
-        
-        if(!doc.HasMember("topics"))
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, topics field not found");
-            return false;
-        }
-        
-        const rapidjson::Value &topics = doc["topics"];
-
-        if(!topics.IsArray())
-        {
-            CONSOLE_LOG_FATAL("merge_point import failed, topics field should be array");
-            return false;
-        }
-
-        uint32 topic_num = topics.Size();
-
-        for(uint32 i = 0; i < topic_num; ++i)
-        {
-            const rapidjson::Value &obj = topics[i];
-
-            if(!obj.IsObject())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, topic should be object");
-                return false;
-            }
+                    if(!obj.IsObject())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, reply should be object");
+                        return false;
+                    }
 
-            if(!obj.HasMember("block_id"))
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, block_id in topics not found");
-                return false;
-            }
+                    if(!obj.HasMember("block_id"))
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, block_id in reply not found");
+                        return false;
+                    }
 
-            if(!obj["block_id"].IsUint64())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, block_id in topics should be uint64");
-                return false;
-            }
+                    if(!obj["block_id"].IsUint64())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, block_id in reply should be uint64");
+                        return false;
+                    }
 
-            uint64 block_id = obj["block_id"].GetUint64();
-            auto iter = m_block_by_id.find(block_id);
+                    uint64 block_id = obj["block_id"].GetUint64();
+                    auto iter = m_block_by_id.find(block_id);
 
-            if(iter == m_block_by_id.end())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, block_id in topics not exist");
-                return false;
-            }
+                    if(iter == m_block_by_id.end())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, block_id in reply not exist");
+                        return false;
+                    }
 
-            if(!obj.HasMember("owner"))
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, owner in topics not found");
-                return false;
-            }
+                    if(!obj.HasMember("owner"))
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, owner in reply not found");
+                        return false;
+                    }
 
-            if(!obj["owner"].IsUint64())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, owner in topics should be uint64");
-                return false;
-            }
+                    if(!obj["owner"].IsUint64())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, owner in reply should be uint64");
+                        return false;
+                    }
 
-            uint64 owner_id = obj["owner"].GetUint64();
-            auto iter1 = m_account_by_id.find(owner_id);
+                    uint64 owner_id = obj["owner"].GetUint64();
+                    auto iter1 = m_account_by_id.find(owner_id);
             
-            if(iter1 == m_account_by_id.end())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, owner in topics not exist");
-                return false;
-            }
-            
-            auto owner = iter1->second;
-            std::string tx_id = obj["key"].GetString();
+                    if(iter1 == m_account_by_id.end())
+                    {
+                        CONSOLE_LOG_FATAL("merge_point import failed, owner in reply not exist");
+                        return false;
+                    }
+                
+                    auto owner = iter1->second;
+                    std::string tx_id = obj["key"].GetString();
 
-            if(!is_base64_char(tx_id))
-            {
-                ASKCOIN_RETURN false;
-            }
+                    if(!is_base64_char(tx_id))
+                    {
+                        ASKCOIN_RETURN false;
+                    }
 
-            if(tx_id.length() != 44)
-            {
-                ASKCOIN_RETURN false;
-            }
+                    if(tx_id.length() != 44)
+                    {
+                        ASKCOIN_RETURN false;
+                    }
+                
+                    std::shared_ptr<Reply> reply(new Reply(tx_id, obj["type"].GetUint(), iter->second, obj["data"].GetString()));
+                    reply->set_owner(owner);
+                    reply->set_balance(obj["balance"].GetUint64());
 
-            std::shared_ptr<Topic> topic(new Topic(tx_id, obj["data"].GetString(), iter->second, obj["total"].GetUint64()));
-            topic->set_balance(obj["balance"].GetUint64());
-            topic->set_owner(owner);
-            owner->m_topic_list.push_back(topic);
-            m_topic_list.push_back(topic);
-            m_topics.insert(std::make_pair(tx_id, topic));
-            
-            if(!obj.HasMember("members"))
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, members in topics not found");
-                return false;
-            }
-        
-            const rapidjson::Value &members = obj["members"];
+                    if(obj.HasMember("reply_to"))
+                    {
+                        std::string to_key = obj["reply_to"].GetString();
 
-            if(!members.IsArray())
-            {
-                CONSOLE_LOG_FATAL("merge_point import failed, members in topics should be array");
-                return false;
-            }
+                        if(!is_base64_char(to_key))
+                        {
+                            ASKCOIN_RETURN false;
+                        }
 
-            uint32 member_num = members.Size();
+                        if(to_key.length() != 44)
+                        {
+                            ASKCOIN_RETURN false;
+                        }
 
-            for(uint32 i = 0; i < member_num; ++i)
-            {
-                const rapidjson::Value &val = members[i];
+                        std::shared_ptr<Reply> reply_to;
+                    
+                        if(!topic->get_reply(to_key, reply_to))
+                        {
+                            CONSOLE_LOG_FATAL("merge_point import failed, reply_to not exist");
+                            return false;
+                        }
+                    
+                        if(reply_to->type() != 0)
+                        {
+                            ASKCOIN_RETURN false;
+                        }
 
-                if(!val.IsUint64())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, member should be uint64");
-                    return false;
+                        reply->set_reply_to(reply_to);
+                    }
+                
+                    topic->m_reply_list.push_back(reply);
                 }
 
-                uint64 member_id = val.GetUint64();
-                auto iter = m_account_by_id.find(member_id);
-
-                if(iter == m_account_by_id.end())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, member in topics not exist");
-                    return false;
-                }
-                
-                auto member = iter->second;
-                member->m_joined_topic_list.push_back(topic);
-                topic->add_member("tx_id", member);
-            }
+                return true;
+            });
 
-            if(!obj.HasMember("replies"))
+        if(!read_ok)
+        {
+            if(!reader.error().empty())
             {
-                CONSOLE_LOG_FATAL("merge_point import failed, replies in topics not found");
-                return false;
+                CONSOLE_LOG_FATAL("merge_point import failed, import_path: %s, reason: %s", \
+                                  m_merge_point->m_import_path.c_str(), reader.error().c_str());
             }
+            
+            return false;
+        }
         
-            const rapidjson::Value &replies = obj["replies"];
+        for(auto &p : referrers)
+        {
+            auto iter = m_account_by_id.find(p.second);
 
-            if(!replies.IsArray())
+            if(iter == m_account_by_id.end())
             {
-                CONSOLE_LOG_FATAL("merge_point import failed, replies in topics should be array");
+                CONSOLE_LOG_FATAL("merge_point import failed, referrer not exist");
                 return false;
             }
 
-            uint32 reply_num = replies.Size();
-
-            for(uint32 i = 0; i < reply_num; ++i)
-            {
-                const rapidjson::Value &obj = replies[i];
-
-                if(!obj.IsObject())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, reply should be object");
-                    return false;
-                }
-
-                if(!obj.HasMember("block_id"))
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, block_id in reply not found");
-                    return false;
-                }
-
-                if(!obj["block_id"].IsUint64())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, block_id in reply should be uint64");
-                    return false;
-                }
-
-                uint64 block_id = obj["block_id"].GetUint64();
-                auto iter = m_block_by_id.find(block_id);
-
-                if(iter == m_block_by_id.end())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, block_id in reply not exist");
-                    return false;
-                }
-
-                if(!obj.HasMember("owner"))
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, owner in reply not found");
-                    return false;
-                }
-
-                if(!obj["owner"].IsUint64())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, owner in reply should be uint64");
-                    return false;
-                }
-
-                uint64 owner_id = obj["owner"].GetUint64();
-                auto iter1 = m_account_by_id.find(owner_id);
-            
-                if(iter1 == m_account_by_id.end())
-                {
-                    CONSOLE_LOG_FATAL("merge_point import failed, owner in reply not exist");
-                    return false;
-                }
-                
-                auto owner = iter1->second;
-                std::string tx_id = obj["key"].GetString();
-
-                if(!is_base64_char(tx_id))
-                {
-                    ASKCOIN_RETURN false;
-                }
-
-                if(tx_id.length() != 44)
-                {
-                    ASKCOIN_RETURN false;
-                }
-                
-                std::shared_ptr<Reply> reply(new Reply(tx_id, obj["type"].GetUint(), iter->second, obj["data"].GetString()));
-                reply->set_owner(owner);
-                reply->set_balance(obj["balance"].GetUint64());
-
-                if(obj.HasMember("reply_to"))
-                {
-                    std::string to_key = obj["reply_to"].GetString();
-
-                    if(!is_base64_char(to_key))
-                    {
-                        ASKCOIN_RETURN false;
-                    }
-
-                    if(to_key.length() != 44)
-                    {
-                        ASKCOIN_RETURN false;
-                    }
-
-                    std::shared_ptr<Reply> reply_to;
-                    
-                    if(!topic->get_reply(to_key, reply_to))
-                    {
-                        CONSOLE_LOG_FATAL("merge_point import failed, reply_to not exist");
-                        return false;
-                    }
-                    
-                    if(reply_to->type() != 0)
-                    {
-                        ASKCOIN_RETURN false;
-                    }
-
-                    reply->set_reply_to(reply_to);
-                }
-                
-                topic->m_reply_list.push_back(reply);
-            }
+            p.first->set_referrer(iter->second);
         }
         
         if(!doc.HasMember("peer_score"))
@@ -2668,11 +3176,11 @@ bool Blockchain::start(std::string db_path, bool repair_db)
         rapidjson::StringBuffer buffer;
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
         peer_score.Accept(writer);
-        leveldb::Status s = m_db->Put(leveldb::WriteOptions(), "peer_score", buffer.GetString());
+        Store_Status s = m_store->put_meta("peer_score", buffer.GetString());
         
         if(!s.ok())
         {
-            CONSOLE_LOG_FATAL("merge_point import failed, write peers error: %s", s.ToString().c_str());
+            CONSOLE_LOG_FATAL("merge_point import failed, write peers error: %s", s.to_string().c_str());
             return false;
         }
         
@@ -2740,51 +3248,37 @@ bool Blockchain::start(std::string db_path, bool repair_db)
         the_most_difficult_block = merge_block;
         
         std::string block_data;
-        s = m_db->Get(leveldb::ReadOptions(), merge_block_hash, &block_data);
+        s = m_committer.get(merge_block_hash, &block_data);
         
         if(!s.ok())
         {
-            if(!s.IsNotFound())
+            if(!s.is_not_found())
             {
-                CONSOLE_LOG_FATAL("read merge_block from leveldb failed: %s", s.ToString().c_str());
+                CONSOLE_LOG_FATAL("read merge_block from leveldb failed: %s", s.to_string().c_str());
                 return false;
             }
             
-            rapidjson::StringBuffer buffer;
-            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-            doc["detail"].Accept(writer);
-            leveldb::Status s = m_db->Put(leveldb::WriteOptions(), merge_block_hash, buffer.GetString());
+            Store_Batch batch;
+            Block_Store::put_block(batch, merge_block_hash, doc["detail"]);
+            Store_Status s = m_store->write(batch);
             
             if(!s.ok())
             {
-                CONSOLE_LOG_FATAL("merge_point import failed, write merge_block error: %s", s.ToString().c_str());
+                CONSOLE_LOG_FATAL("merge_point import failed, write merge_block error: %s", s.to_string().c_str());
                 return false;
             }
-
-            s = m_db->Get(leveldb::ReadOptions(), merge_block_hash, &block_data);
-
-            if(!s.ok())
-            {
-                ASKCOIN_RETURN false;
-            }
         }
 
         {
-            const char *block_data_str = block_data.c_str();
             rapidjson::Document doc;
-            doc.Parse(block_data_str);
+            Store_Status s = m_committer.get_block(merge_block_hash, doc);
         
-            if(doc.HasParseError())
+            if(!s.ok())
             {
-                CONSOLE_LOG_FATAL("parse leveldb block 0 failed, data: %s, reason: %s", block_data_str, GetParseError_En(doc.GetParseError()));
+                CONSOLE_LOG_FATAL("parse leveldb merge_block failed, hash: %s, reason: %s", merge_block_hash.c_str(), s.to_string().c_str());
                 return false;
             }
 
-            if(!doc.IsObject())
-            {
-                ASKCOIN_RETURN false;
-            }
-
             if(!doc.HasMember("hash"))
             {
                 ASKCOIN_RETURN false;
@@ -3015,316 +3509,269 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             {
                 ASKCOIN_RETURN false;
             }
-        
-            for(rapidjson::Value::ConstValueIterator iter = children.Begin(); iter != children.End(); ++iter)
+
+            std::vector<std::string> children_hashes;
+            get_children(doc, block_hash, children_hashes);
+            
+            for(auto &child_hash : children_hashes)
             {
-                Child_Block child_block(merge_block, iter->GetString());
+                Child_Block child_block(merge_block, child_hash);
                 block_list.push_back(child_block);
             }
         }
     }
     
-    struct _Data
+    // phase 1 runs as a pipeline. reader threads prefetch block bodies from leveldb along the BFS
+    // frontier, the LANE_SIGN of Verify_Pool parses and validates them and feeds their children back
+    // to the frontier, and this thread links them into the block tree in frontier order, so a parent
+    // always comes before its children. readers stay within LOAD_WINDOW blocks of the apply stage,
+    // which bounds the reorder buffer before the apply stage, the queues of Verify_Pool are bounded
+    // by themselves. the pow of linked blocks is checked ASIC_RESISTANT_BATCH_NUM at a time on LANE_POW.
+    struct _Load_Item
+    {
+        uint64 m_seq;
+        std::string m_hash;
+        std::string m_parent_hash;
+        std::string m_block_data;
+        std::string m_data_str;
+        std::string m_pre_hash;
+        std::string m_miner_pubkey;
+        uint64 m_block_id;
+        uint64 m_utc;
+        uint32 m_version;
+        uint32 m_zero_bits;
+        uint32 m_tx_num;
+        bool m_pruned;
+    };
+
+    struct _Pow_Item
     {
         std::string m_block_hash;
         std::string m_block_data;
         uint32 m_zero_bits;
-        bool m_finished;
     };
     
-    fly::base::Lock_Queue<_Data> lock_q;
-    std::atomic<bool> finished_signal {false};
+    struct _Load_Stat
+    {
+        std::atomic<uint64> m_cnt {0};
+        std::atomic<uint64> m_bytes {0};
+        std::atomic<uint64> m_busy_usec {0};
+    };
+    
+    const uint64 LOAD_WINDOW = 4096;
+    const int32 reader_num = 4;
+    Verify_Pool *verify_pool = Verify_Pool::instance();
+    std::mutex load_mutex;
+    std::condition_variable frontier_cv;
+    std::condition_variable apply_cv;
+    std::list<std::shared_ptr<_Load_Item>> frontier;
+    std::map<uint64, std::shared_ptr<_Load_Item>> parsed;
+    std::vector<_Pow_Item> pow_batch;
+    uint64 seq_cnt = 0;
+    uint64 next_seq = 0;
+    uint32 parse_pending = 0;
+    uint32 pow_pending = 0;
+    bool load_stop = false;
     std::atomic<bool> error_signal {false};
-    std::atomic<uint64> verify_cnt {1};
-    int32 cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
-    const int32 thread_num = cpu_num * 2;
-    std::thread verify_threads[thread_num];
-    CONSOLE_ONLY("verify_hash threads num: %u", thread_num);
+    _Load_Stat read_stat, parse_stat, apply_stat, pow_stat;
+    uint64 load_start_usec = Timer::now_usec();
+    std::thread reader_threads[reader_num];
+    CONSOLE_ONLY("verify threads num: %u, pow verify threads num: %u", verify_pool->thread_num(Verify_Pool::LANE_SIGN), \
+                 verify_pool->thread_num(Verify_Pool::LANE_POW));
     CONSOLE_ONLY("loading block, phase 1, please wait a moment......");
     
-    for(int32 i = 0; i < thread_num; ++i)
+    for(auto &child_block : block_list)
     {
-        verify_threads[i] = std::move(std::thread([&] {
-            while(!finished_signal.load(std::memory_order_relaxed))
-            {
-                if(error_signal.load(std::memory_order_relaxed))
-                {
-                    return;
-                }
-                
-                std::list<_Data> data_list;
-
-                if(lock_q.pop(data_list))
-                {
-                    for(auto &d : data_list)
-                    {
-                        if(error_signal.load(std::memory_order_relaxed))
-                        {
-                            return;
-                        }
-                        
-                        if(d.m_finished)
-                        {
-                            finished_signal.store(true, std::memory_order_relaxed);
-                            return;
-                        }
-                        
-                        if(!Blockchain::verify_hash(d.m_block_hash, d.m_block_data, d.m_zero_bits))
-                        {
-                            error_signal.store(true, std::memory_order_relaxed);
-                            lock_q.pulse_notify_not_full();
-                            CONSOLE_LOG_FATAL("verify block hash and zero_bits failed, hash: %s", d.m_block_hash.c_str());
-                            return;
-                        }
-                        
-                        uint64 _cnt = verify_cnt.fetch_add(1, std::memory_order_relaxed);
-
-                        if(_cnt % 100 == 0)
-                        {
-                            CONSOLE_ONLY("verify_hash block from leveldb, %lu blocks have been verified", _cnt);
-                        }
-                    }
-                }
-            }
-        }));
+        std::shared_ptr<_Load_Item> item(new _Load_Item);
+        item->m_seq = seq_cnt++;
+        item->m_hash = child_block.m_hash;
+        item->m_parent_hash = child_block.m_parent->hash();
+        frontier.push_back(item);
     }
     
-    while(!block_list.empty())
-    {
-        const Child_Block &child_block = block_list.front();
-        std::string block_data;
-        s = m_db->Get(leveldb::ReadOptions(), child_block.m_hash, &block_data);
-
-        if(!s.ok())
+    block_list.clear();
+    auto stop_load = [&] {
+        std::lock_guard<std::mutex> guard(load_mutex);
+        load_stop = true;
+        frontier_cv.notify_all();
+        apply_cv.notify_all();
+    };
+    
+    auto report_load = [&] {
+        uint64 elapsed = Timer::now_usec() - load_start_usec + 1;
+        CONSOLE_ONLY("phase 1 reader: %lu blocks, %lu KB, %lu blocks/s, busy %lu ms (%d threads)", read_stat.m_cnt.load(), \
+                     read_stat.m_bytes.load() / 1024, read_stat.m_cnt.load() * 1000000 / elapsed, read_stat.m_busy_usec.load() / 1000, reader_num);
+        CONSOLE_ONLY("phase 1 parser: %lu blocks, %lu blocks/s, busy %lu ms", parse_stat.m_cnt.load(), \
+                     parse_stat.m_cnt.load() * 1000000 / elapsed, parse_stat.m_busy_usec.load() / 1000);
+        CONSOLE_ONLY("phase 1 apply: %lu blocks, %lu blocks/s, busy %lu ms", apply_stat.m_cnt.load(), \
+                     apply_stat.m_cnt.load() * 1000000 / elapsed, apply_stat.m_busy_usec.load() / 1000);
+        CONSOLE_ONLY("phase 1 pow: %lu blocks, %lu blocks/s, busy %lu ms", pow_stat.m_cnt.load(), \
+                     pow_stat.m_cnt.load() * 1000000 / elapsed, pow_stat.m_busy_usec.load() / 1000);
+    };
+    
+    auto post_pow_batch = [&] {
+        if(pow_batch.empty())
         {
-            CONSOLE_LOG_FATAL("read block data from leveldb failed, hash: %s", child_block.m_hash.c_str());
-            
-            return false;
+            return;
         }
         
-        rapidjson::Document doc;
-        const char *block_data_str = block_data.c_str();
-        doc.Parse(block_data_str);
-        
-        if(doc.HasParseError())
-        {
-            CONSOLE_LOG_FATAL("parse block data from leveldb failed, data: %s, hash: %s, reason: %s", block_data_str, child_block.m_hash.c_str(), \
-                              GetParseError_En(doc.GetParseError()));
-            return false;
-        }
-
-        if(!doc.IsObject())
-        {
-            ASKCOIN_RETURN false;
-        }
-
-        if(!doc.HasMember("hash"))
+        auto batch = std::make_shared<std::vector<_Pow_Item>>(std::move(pow_batch));
+        pow_batch.clear();
         {
-            ASKCOIN_RETURN false;
+            std::lock_guard<std::mutex> guard(load_mutex);
+            ++pow_pending;
         }
+        
+        verify_pool->post(Verify_Pool::LANE_POW, [&, batch] {
+            if(!error_signal.load(std::memory_order_relaxed))
+            {
+                uint64 start_usec = Timer::now_usec();
+                std::string block_hashes[ASIC_RESISTANT_BATCH_NUM];
+                std::string block_datas[ASIC_RESISTANT_BATCH_NUM];
+                uint32 zero_bits[ASIC_RESISTANT_BATCH_NUM];
+                uint32 batch_num = batch->size();
 
-        if(!doc.HasMember("sign"))
-        {
-            ASKCOIN_RETURN false;
-        }
+                for(uint32 i = 0; i < batch_num; ++i)
+                {
+                    block_hashes[i] = std::move((*batch)[i].m_block_hash);
+                    block_datas[i] = std::move((*batch)[i].m_block_data);
+                    zero_bits[i] = (*batch)[i].m_zero_bits;
+                }
+                
+                uint32 failed_idx = Blockchain::verify_hash(block_hashes, block_datas, zero_bits, batch_num);
 
-        if(!doc["hash"].IsString())
-        {
-            ASKCOIN_RETURN false;
-        }
+                if(failed_idx != batch_num)
+                {
+                    CONSOLE_LOG_FATAL("verify block hash and zero_bits failed, hash: %s", block_hashes[failed_idx].c_str());
+                    error_signal.store(true, std::memory_order_relaxed);
+                }
 
-        if(!doc["sign"].IsString())
-        {
-            ASKCOIN_RETURN false;
-        }
-        
-        std::string block_hash = doc["hash"].GetString();
-        std::string block_sign = doc["sign"].GetString();
+                pow_stat.m_busy_usec.fetch_add(Timer::now_usec() - start_usec, std::memory_order_relaxed);
+                
+                for(uint32 i = 0; i < batch_num; ++i)
+                {
+                    uint64 _cnt = pow_stat.m_cnt.fetch_add(1, std::memory_order_relaxed) + 1;
 
-        if(!is_base64_char(block_hash))
-        {
-            ASKCOIN_RETURN false;
-        }
+                    if(_cnt % 100 == 0)
+                    {
+                        CONSOLE_ONLY("verify_hash block from leveldb, %lu blocks have been verified", _cnt);
+                    }
+                }
+            }
             
-        if(!is_base64_char(block_sign))
-        {
-            ASKCOIN_RETURN false;
-        }
-
-        if(block_hash.length() != 44)
-        {
-            ASKCOIN_RETURN false;
-        }
-        
-        if(!doc.HasMember("data"))
-        {
-            ASKCOIN_RETURN false;
-        }
+            std::lock_guard<std::mutex> guard(load_mutex);
+            --pow_pending;
+            apply_cv.notify_all();
+        });
+    };
+    
+    auto parse_block = [&](_Load_Item &item, std::list<std::string> &children_hashes) -> bool {
+        // the header is read straight into its fields, the txs of a block are not touched
+        Block_Record::Header header;
         
-        if(!doc.HasMember("tx"))
-        {
-            ASKCOIN_RETURN false;
-        }
-
-        const rapidjson::Value &tx = doc["tx"];
-
-        if(!tx.IsArray())
+        if(!Block_Record::decode_header(item.m_block_data, header))
         {
-            ASKCOIN_RETURN false;
+            CONSOLE_LOG_FATAL("parse block data from leveldb failed, hash: %s", item.m_hash.c_str());
+            return false;
         }
 
-        if(!doc.HasMember("children"))
-        {
-            ASKCOIN_RETURN false;
-        }
+        std::string block_hash = fly::base::base64_encode(header.m_hash.data(), header.m_hash.length());
+        std::string block_sign = fly::base::base64_encode(header.m_sign.data(), header.m_sign.length());
         
-        if(block_hash != child_block.m_hash)
+        if(block_hash != item.m_hash)
         {
             ASKCOIN_RETURN false;
         }
 
-        const rapidjson::Value &data = doc["data"];
-        
-        if(!data.IsObject())
-        {
-            ASKCOIN_RETURN false;
-        }
+        // a header record left by prune_bodies, the body was verified before it was pruned
+        bool pruned = header.m_pruned;
+        uint32 tx_num = header.m_tx_num;
 
-        if(data.MemberCount() != 8)
+        if(tx_num > 2000)
         {
             ASKCOIN_RETURN false;
         }
         
-        if(!data.HasMember("id"))
-        {
-            ASKCOIN_RETURN false;
-        }
-
-        if(!data.HasMember("utc"))
-        {
-            ASKCOIN_RETURN false;
-        }
-
-        if(!data.HasMember("version"))
-        {
-            ASKCOIN_RETURN false;
-        }
-    
-        if(!data.HasMember("zero_bits"))
+        std::string &miner_pubkey = header.m_miner;
+        
+        if(!is_base64_char(miner_pubkey))
         {
             ASKCOIN_RETURN false;
         }
 
-        if(!data.HasMember("pre_hash"))
+        if(miner_pubkey.length() != 88)
         {
             ASKCOIN_RETURN false;
         }
         
-        if(!data.HasMember("miner"))
-        {
-            ASKCOIN_RETURN false;
-        }
+        uint64 block_id = header.m_id;
+        uint64 utc = header.m_utc;
+        uint32 version = header.m_version;
+        uint32 zero_bits = header.m_zero_bits;
 
-        if(!data.HasMember("tx_ids"))
+        if(zero_bits == 0 || zero_bits >= 256)
         {
             ASKCOIN_RETURN false;
         }
 
-        const rapidjson::Value &tx_ids = data["tx_ids"];
-
-        if(!tx_ids.IsArray())
+        if(!pruned && block_id > trusted_id && !check_sign(miner_pubkey, block_hash, block_sign))
         {
-            ASKCOIN_RETURN false;
-        }
-
-        uint32 tx_num = tx_ids.Size();
+            CONSOLE_LOG_FATAL("verify block sign from leveldb failed, hash: %s", item.m_hash.c_str());
 
-        if(tx_num > 2000)
-        {
-            ASKCOIN_RETURN false;
+            return false;
         }
         
-        if(tx.Size() != tx_num)
+        if(!version_compatible(version, ASKCOIN_VERSION))
         {
-            ASKCOIN_RETURN false;
+            CONSOLE_LOG_FATAL("verify block version from leveldb failed, hash: %s, block version: %u, askcoin version: %u", \
+                              item.m_hash.c_str(), version, ASKCOIN_VERSION);
+            return false;
         }
         
-        if(!data.HasMember("nonce"))
-        {
-            ASKCOIN_RETURN false;
-        }
+        uint64 now = time(NULL);
         
-        rapidjson::StringBuffer buffer;
-        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-        data.Accept(writer);
-
-        //base64 44 bytes length
-        if(block_hash.length() != 44)
+        if(utc > now)
         {
-            CONSOLE_LOG_FATAL("parse block data from leveldb failed, hash: %s, hash length is not 44 bytes", child_block.m_hash.c_str());
+            CONSOLE_LOG_FATAL("verify block utc from leveldb failed, id: %lu, hash: %s, please check your system time", block_id, item.m_hash.c_str());
             
             return false;
         }
-
-        std::string data_str(buffer.GetString(), buffer.GetSize());
-        std::string miner_pubkey = data["miner"].GetString();
         
-        if(!is_base64_char(miner_pubkey))
-        {
-            ASKCOIN_RETURN false;
-        }
-
-        if(miner_pubkey.length() != 88)
-        {
-            ASKCOIN_RETURN false;
-        }
+        std::vector<std::string> child_hashes;
+        get_children(header, item.m_hash, child_hashes);
+        children_hashes.insert(children_hashes.end(), child_hashes.begin(), child_hashes.end());
 
-        if(!verify_sign(miner_pubkey, block_hash, block_sign))
+        // the json the block hash covers, only built for the blocks whose hash is checked
+        if(!pruned && block_id > trusted_id)
         {
-            CONSOLE_LOG_FATAL("verify block sign from leveldb failed, hash: %s", child_block.m_hash.c_str());
-
-            return false;
+            item.m_data_str = header.data_json();
         }
         
-        uint64 block_id = data["id"].GetUint64();
-        uint64 utc = data["utc"].GetUint64();
-        uint32 version = data["version"].GetUint();
-        uint32 zero_bits = data["zero_bits"].GetUint();
-
-        if(zero_bits == 0 || zero_bits >= 256)
-        {
-            ASKCOIN_RETURN false;
-        }
+        item.m_pre_hash = fly::base::base64_encode(header.m_pre_hash.data(), header.m_pre_hash.length());
+        item.m_miner_pubkey = miner_pubkey;
+        item.m_block_id = block_id;
+        item.m_utc = utc;
+        item.m_version = version;
+        item.m_zero_bits = zero_bits;
+        item.m_tx_num = tx_num;
+        item.m_pruned = pruned;
+        item.m_block_data.clear();
         
-        std::string pre_hash = data["pre_hash"].GetString();
-        const rapidjson::Value &nonce = data["nonce"];
+        return true;
+    };
 
-        if(!version_compatible(version, ASKCOIN_VERSION))
-        {
-            CONSOLE_LOG_FATAL("verify block version from leveldb failed, hash: %s, block version: %u, askcoin version: %u", \
-                              child_block.m_hash.c_str(), version, ASKCOIN_VERSION);
-            return false;
-        }
-        
-        if(!nonce.IsArray())
-        {
-            ASKCOIN_RETURN false;
-        }
-        
-        if(nonce.Size() != 4)
+    auto apply_block = [&](_Load_Item &item) -> bool {
+        auto iter_parent = m_blocks.find(item.m_parent_hash);
+
+        if(iter_parent == m_blocks.end())
         {
             ASKCOIN_RETURN false;
         }
         
-        for(uint32 i = 0; i < 4; ++i)
-        {
-            if(!nonce[i].IsUint64())
-            {
-                ASKCOIN_RETURN false;
-            }
-        }
-        
-        std::shared_ptr<Block> parent = child_block.m_parent;
+        std::shared_ptr<Block> parent = iter_parent->second;
+        uint64 block_id = item.m_block_id;
+        uint64 utc = item.m_utc;
+        uint32 zero_bits = item.m_zero_bits;
         uint64 parent_block_id = parent->id();
         uint64 parent_utc = parent->utc();
         std::string parent_hash = parent->hash();
@@ -3336,7 +3783,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             ASKCOIN_RETURN false;
         }
 
-        if(pre_hash != parent_hash)
+        if(item.m_pre_hash != parent_hash)
         {
             ASKCOIN_RETURN false;
         }
@@ -3371,90 +3818,225 @@ bool Blockchain::start(std::string db_path, bool repair_db)
         {
             ASKCOIN_RETURN false;
         }
-
-        uint64 now = time(NULL);
-        
-        if(utc > now)
-        {
-            CONSOLE_LOG_FATAL("verify block utc from leveldb failed, id: %lu, hash: %s, please check your system time", block_id, child_block.m_hash.c_str());
-            
-            return false;
-        }
-        
-        _Data _data;
-        _data.m_block_hash = block_hash;
-        _data.m_block_data = data_str;
-        _data.m_zero_bits = zero_bits;
-        _data.m_finished = false;
-        lock_q.push(_data);
-        std::shared_ptr<Block> cur_block(new Block(block_id, utc, version, zero_bits, block_hash));
-        cur_block->set_parent(parent);
-        cur_block->set_miner_pubkey(miner_pubkey);
-        cur_block->add_difficulty_from(parent);
         
-        if(m_blocks.find(block_hash) != m_blocks.end())
+        if(m_blocks.find(item.m_hash) != m_blocks.end())
         {
             ASKCOIN_RETURN false;
         }
         
-        cur_block->m_tx_num = tx_num;
-        m_blocks.insert(std::make_pair(block_hash, cur_block));
-        const rapidjson::Value &children = doc["children"];
-        
-        if(!children.IsArray())
+        if(item.m_pruned)
         {
-            ASKCOIN_RETURN false;
+            if(block_id > m_pruned_block_id)
+            {
+                m_pruned_block_id = block_id;
+            }
         }
-        
-        for(rapidjson::Value::ConstValueIterator iter = children.Begin(); iter != children.End(); ++iter)
+        else if(block_id > trusted_id)
         {
-            Child_Block child_block(cur_block, iter->GetString());
-            block_list.push_back(child_block);
+            pow_batch.push_back(_Pow_Item {item.m_hash, std::move(item.m_data_str), zero_bits});
+
+            if(pow_batch.size() == ASIC_RESISTANT_BATCH_NUM)
+            {
+                post_pow_batch();
+            }
         }
         
+        std::shared_ptr<Block> cur_block(new Block(block_id, utc, item.m_version, zero_bits, item.m_hash));
+        cur_block->set_parent(parent);
+        cur_block->set_miner_pubkey(item.m_miner_pubkey);
+        cur_block->add_difficulty_from(parent);
+        cur_block->m_tx_num = item.m_tx_num;
+        m_blocks.insert(std::make_pair(item.m_hash, cur_block));
+        
         if(the_most_difficult_block->difficult_than_me(cur_block))
         {
             the_most_difficult_block = cur_block;
         }
         
-        block_list.pop_front();
-
-        if(error_signal.load(std::memory_order_relaxed))
-        {
-            for(int32 i = 0; i < thread_num; ++i)
-            {
-                verify_threads[i].join();
-            }
-
-            return false;
-        }
-    }
-    
-    _Data _data;
-    _data.m_finished = true;
-    lock_q.push(_data);
+        return true;
+    };
     
-    while(!finished_signal.load(std::memory_order_relaxed))
+    for(int32 i = 0; i < reader_num; ++i)
     {
-        if(error_signal.load(std::memory_order_relaxed))
-        {
-            for(int32 i = 0; i < thread_num; ++i)
+        reader_threads[i] = std::thread([&] {
+            while(true)
             {
-                verify_threads[i].join();
-            }
-            
-            return false;
-        }
-        
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-    }
-    
-    for(int32 i = 0; i < thread_num; ++i)
-    {
-        verify_threads[i].join();
-    }
-    
-    CONSOLE_ONLY("loading block, phase 2, please wait a moment......");
+                std::unique_lock<std::mutex> lock(load_mutex);
+                frontier_cv.wait(lock, [&] {
+                        return load_stop || (!frontier.empty() && frontier.front()->m_seq < next_seq + LOAD_WINDOW);
+                    });
+
+                if(load_stop)
+                {
+                    return;
+                }
+                
+                std::shared_ptr<_Load_Item> item = frontier.front();
+                frontier.pop_front();
+                ++parse_pending;
+                lock.unlock();
+                uint64 start_usec = Timer::now_usec();
+                Store_Status s = m_committer.get(item->m_hash, &item->m_block_data);
+                
+                if(!s.ok())
+                {
+                    CONSOLE_LOG_FATAL("read block data from leveldb failed, hash: %s", item->m_hash.c_str());
+                    stop_load();
+                    lock.lock();
+                    --parse_pending;
+                    apply_cv.notify_all();
+                    return;
+                }
+
+                read_stat.m_cnt.fetch_add(1, std::memory_order_relaxed);
+                read_stat.m_bytes.fetch_add(item->m_block_data.length(), std::memory_order_relaxed);
+                read_stat.m_busy_usec.fetch_add(Timer::now_usec() - start_usec, std::memory_order_relaxed);
+                verify_pool->post(Verify_Pool::LANE_SIGN, [&, item] {
+                    std::list<std::string> children_hashes;
+                    bool parse_ok = true;
+                    {
+                        std::lock_guard<std::mutex> guard(load_mutex);
+                        parse_ok = !load_stop;
+                    }
+                    
+                    if(parse_ok)
+                    {
+                        uint64 start_usec = Timer::now_usec();
+                        parse_ok = parse_block(*item, children_hashes);
+                        parse_stat.m_cnt.fetch_add(1, std::memory_order_relaxed);
+                        parse_stat.m_busy_usec.fetch_add(Timer::now_usec() - start_usec, std::memory_order_relaxed);
+
+                        if(!parse_ok)
+                        {
+                            stop_load();
+                        }
+                    }
+                    
+                    std::lock_guard<std::mutex> guard(load_mutex);
+                    --parse_pending;
+                    
+                    if(parse_ok)
+                    {
+                        for(auto &child_hash : children_hashes)
+                        {
+                            std::shared_ptr<_Load_Item> child(new _Load_Item);
+                            child->m_seq = seq_cnt++;
+                            child->m_hash = child_hash;
+                            child->m_parent_hash = item->m_hash;
+                            frontier.push_back(child);
+                        }
+                        
+                        parsed.insert(std::make_pair(item->m_seq, item));
+                        frontier_cv.notify_all();
+                    }
+                    
+                    apply_cv.notify_all();
+                });
+            }
+        });
+    }
+
+    bool load_failed = false;
+    
+    while(true)
+    {
+        std::unique_lock<std::mutex> lock(load_mutex);
+        apply_cv.wait_for(lock, std::chrono::seconds(1), [&] {
+                return load_stop || next_seq == seq_cnt || parsed.find(next_seq) != parsed.end();
+            });
+        
+        if(load_stop)
+        {
+            load_failed = true;
+            break;
+        }
+
+        if(error_signal.load(std::memory_order_relaxed))
+        {
+            lock.unlock();
+            stop_load();
+            load_failed = true;
+            break;
+        }
+        
+        if(next_seq == seq_cnt)
+        {
+            break;
+        }
+
+        auto iter = parsed.find(next_seq);
+
+        if(iter == parsed.end())
+        {
+            continue;
+        }
+        
+        std::shared_ptr<_Load_Item> item = iter->second;
+        parsed.erase(iter);
+        lock.unlock();
+        uint64 start_usec = Timer::now_usec();
+
+        if(!apply_block(*item))
+        {
+            stop_load();
+            load_failed = true;
+            break;
+        }
+
+        apply_stat.m_cnt.fetch_add(1, std::memory_order_relaxed);
+        apply_stat.m_busy_usec.fetch_add(Timer::now_usec() - start_usec, std::memory_order_relaxed);
+        
+        if(apply_stat.m_cnt.load(std::memory_order_relaxed) % 10000 == 0)
+        {
+            report_load();
+        }
+        
+        lock.lock();
+        ++next_seq;
+        frontier_cv.notify_all();
+    }
+
+    if(!load_failed)
+    {
+        post_pow_batch();
+    }
+    
+    stop_load();
+    
+    for(int32 i = 0; i < reader_num; ++i)
+    {
+        reader_threads[i].join();
+    }
+
+    // the jobs on Verify_Pool refer to this stack frame, so all of them must be finished here
+    {
+        std::unique_lock<std::mutex> lock(load_mutex);
+        apply_cv.wait(lock, [&] {
+                return parse_pending == 0 && pow_pending == 0;
+            });
+    }
+    
+    report_load();
+    
+    if(load_failed || error_signal.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    
+
+    if(trusted_id > 0)
+    {
+        auto iter_trusted = m_blocks.find(trusted_hash);
+
+        if(iter_trusted == m_blocks.end() || iter_trusted->second->id() != trusted_id)
+        {
+            CONSOLE_LOG_FATAL("verified marker doesn't match the blocks in leveldb, block_id: %lu, block_hash: %s, please restart with --full-verify", \
+                              trusted_id, trusted_hash.c_str());
+            return false;
+        }
+    }
+    
+    CONSOLE_ONLY("loading block, phase 2, please wait a moment......");
     std::list<std::shared_ptr<Block>> block_chain;
     std::shared_ptr<Block> iter_block = the_most_difficult_block;
     m_cur_block = the_most_difficult_block;
@@ -3479,33 +4061,86 @@ bool Blockchain::start(std::string db_path, bool repair_db)
         }
     }
     
+    // the newest snapshot at least 2 * TOPIC_LIFE_TIME below the tip replaces the replay of the blocks
+    // before it. m_rollback_topics and m_rollback_txs only reach back 2 * TOPIC_LIFE_TIME blocks, so
+    // replaying the rest of the chain rebuilds them completely.
+    {
+        std::vector<uint64> snapshot_ids;
+        get_snapshot_ids(snapshot_ids);
+        uint64 tip_id = m_cur_block->id();
+        
+        for(auto snapshot_id : snapshot_ids)
+        {
+            if(snapshot_id <= tip_id && m_last_snapshot_id == 0)
+            {
+                m_last_snapshot_id = snapshot_id;
+            }
+            
+            if(block_chain.empty() || snapshot_id + 2 * TOPIC_LIFE_TIME > tip_id || snapshot_id < block_chain.front()->id())
+            {
+                continue;
+            }
+            
+            if(m_merge_point->m_import_block_id > 0 && snapshot_id < m_merge_point->m_import_block_id + 2 * TOPIC_LIFE_TIME)
+            {
+                continue;
+            }
+
+            if(m_merge_point->m_export_block_id > 0 && snapshot_id >= m_merge_point->m_export_block_id)
+            {
+                continue;
+            }
+            
+            auto iter = block_chain.begin();
+            std::advance(iter, snapshot_id - block_chain.front()->id());
+            std::shared_ptr<Block> snapshot_block = *iter;
+            std::string snapshot_data;
+            s = m_committer.get("snapshot_" + std::to_string(snapshot_id), &snapshot_data);
+            
+            if(!s.ok())
+            {
+                CONSOLE_LOG_FATAL("read snapshot from leveldb failed, block_id: %lu, reason: %s", snapshot_id, s.to_string().c_str());
+                return false;
+            }
+
+            for(auto iter_1 = block_chain.begin(); iter_1 != std::next(iter); ++iter_1)
+            {
+                m_block_by_id.insert(std::make_pair((*iter_1)->id(), *iter_1));
+            }
+            
+            if(!load_snapshot(snapshot_data, snapshot_block))
+            {
+                CONSOLE_LOG_INFO("snapshot is invalid, block_id: %lu, try an older one", snapshot_id);
+                continue;
+            }
+
+            block_chain.erase(block_chain.begin(), std::next(iter));
+            CONSOLE_LOG_INFO("load snapshot successfully, block_id: %lu, block_hash: %s, %lu blocks left to replay", \
+                             snapshot_id, snapshot_block->hash().c_str(), block_chain.size());
+            break;
+        }
+    }
+    
     // now, load tx in every block in order
     while(!block_chain.empty())
     {
         iter_block = block_chain.front();
         uint64 cur_block_id = iter_block->id();
         std::string block_hash = iter_block->hash();
-        std::string block_data;
-        s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
-        
-        if(!s.ok())
-        {
-            ASKCOIN_RETURN false;
-        }
-        
         std::shared_ptr<rapidjson::Document> doc_ptr = std::make_shared<rapidjson::Document>();
         auto &doc = *doc_ptr;
-        const char *block_data_str = block_data.c_str();
-        doc.Parse(block_data_str);
+        s = m_committer.get_block(block_hash, doc);
         
-        if(doc.HasParseError())
+        if(!s.ok())
         {
             ASKCOIN_RETURN false;
         }
-
-        if(!doc.IsObject())
+        
+        if(doc.HasMember("pruned"))
         {
-            ASKCOIN_RETURN false;
+            CONSOLE_LOG_FATAL("block body was pruned and no snapshot above it could be loaded, block_id: %lu, block_hash: %s, please resync with an empty db", \
+                              cur_block_id, block_hash.c_str());
+            return false;
         }
         
         if(!doc.HasMember("data"))
@@ -3655,7 +4290,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
                 ASKCOIN_RETURN false;
             }
 
-            if(!verify_sign(pubkey, tx_id, tx_sign))
+            if(cur_block_id > trusted_id && !verify_sign(pubkey, tx_id, tx_sign))
             {
                 CONSOLE_LOG_FATAL("verify tx sign from leveldb failed, tx_id: %s", tx_id.c_str());
                 
@@ -3769,7 +4404,7 @@ bool Blockchain::start(std::string db_path, bool repair_db)
                     ASKCOIN_RETURN false;
                 }
                 
-                if(!verify_sign(referrer_pubkey, sign_hash, reg_sign))
+                if(cur_block_id > trusted_id && !verify_sign(referrer_pubkey, sign_hash, reg_sign))
                 {
                     ASKCOIN_RETURN false;
                 }
@@ -4347,431 +4982,2333 @@ bool Blockchain::start(std::string db_path, bool repair_db)
             ASKCOIN_RETURN false;
         }
 
-        if(!check_balance())
+        Merge_Export merge_export;
+        merge_export.m_block_id = m_merge_point->m_export_block_id;
+        merge_export.m_path = m_merge_point->m_export_path;
+        merge_export.m_start_usec = Timer::now_usec();
+        
+        if(!capture_merge_point(m_blocks[m_merge_point->m_export_block_hash], merge_export))
         {
-            CONSOLE_LOG_FATAL("check_balance failed");
-            ASKCOIN_RETURN false;
+            return false;
+        }
+
+        if(!write_merge_point(merge_export))
+        {
+            return false;
+        }
+        
+        CONSOLE_LOG_INFO("merge_point export block_id: %lu, block_hash: %s successfully", \
+                         m_merge_point->m_export_block_id, m_merge_point->m_export_block_hash.c_str());
+        return true;
+    }
+    
+    char hash_raw[32];
+    fly::base::base64_decode(m_cur_block->hash().c_str(), m_cur_block->hash().length(), hash_raw, 32);
+    std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
+    CONSOLE_LOG_INFO("load block finished, zero_bits: %u, cur_block_id: %lu, cur_block_hash: %s (hex: %s)", \
+                     m_cur_block->zero_bits(), m_cur_block->id(), m_cur_block->hash().c_str(), hex_hash.c_str());
+
+    if(!repair_height_index())
+    {
+        return false;
+    }
+    
+    if(m_fast_start)
+    {
+        std::shared_ptr<Block> top_block = m_cur_block;
+        
+        for(auto &p : m_blocks)
+        {
+            if(p.second->id() > top_block->id())
+            {
+                top_block = p.second;
+            }
         }
 
-        auto pos = std::string::npos;
+        // every block in leveldb has been verified now, either when it was committed or above
+        Store_Batch batch;
+        put_verified_marker(batch, top_block->id(), top_block->hash());
+        s = m_store->write(batch);
 
-        if((pos = m_merge_point->m_export_path.find_last_of('/')) != std::string::npos)
+        if(!s.ok())
         {
-            if(pos > 0)
+            CONSOLE_LOG_FATAL("write verified marker failed, reason: %s", s.to_string().c_str());
+            return false;
+        }
+    }
+    
+    m_timer_ctl.add_timer([this]() {
+            this->broadcast();
+        }, 10000);
+
+    m_timer_ctl.add_timer([this]() {
+            check_prune();
+        }, 1000);
+
+    m_timer_ctl.add_timer([this]() {
+            check_merge_export();
+        }, 1000);
+
+    m_migrate_timer_id = m_timer_ctl.add_timer([this]() {
+            if(migrate_block_records())
             {
-                auto export_dir = m_merge_point->m_export_path.substr(0, pos);
+                m_timer_ctl.del_timer(m_migrate_timer_id);
+            }
+        }, 1000);
 
-                if(fly::base::mkpath(export_dir) == -1)
-                {
-                    CONSOLE_LOG_FATAL("merge_point mkpath export_dir: %s failed, reason: %s", \
-                                      export_dir.c_str(), strerror(errno));
-                    ASKCOIN_RETURN false;
-                }
+    m_timer_ctl.add_timer([this]() {
+            uint64 utc_now = time(NULL);
+
+            if(m_last_mine_time + 5 < utc_now)
+            {
+                mine_tx();
+                m_last_mine_time = time(NULL);
             }
+        }, 1000);
+    
+    for(auto p : m_account_by_id)
+    {
+        auto account = p.second;
+        account->proc_history_expired(m_cur_block->id());
+    }
+    
+    if(!check_balance())
+    {
+        CONSOLE_LOG_FATAL("check_balance failed");
+
+        ASKCOIN_RETURN false;
+    }
+    
+    {
+        std::string peer_data;
+        s = m_committer.get("peer_score", &peer_data);
+        
+        if(!s.ok())
+        {
+            CONSOLE_LOG_FATAL("read peer score data from leveldb failed: %s", s.to_string().c_str());
+
+            return false;
         }
         
         rapidjson::Document doc;
-        doc.SetObject();
-        std::ofstream ofs(m_merge_point->m_export_path);
-        rapidjson::OStreamWrapper osw(ofs);
-        rapidjson::Writer<rapidjson::OStreamWrapper> writer(osw);
-        rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
-        rapidjson::Value accounts(rapidjson::kArrayType);
-        rapidjson::Value pow_arr(rapidjson::kArrayType);
-        std::string block_data;
-        s = m_db->Get(leveldb::ReadOptions(), m_merge_point->m_export_block_hash, &block_data);
+        const char *peer_data_str = peer_data.c_str();
+        CONSOLE_LOG_INFO("peer score data from leveldb: %s", peer_data_str);
+        doc.Parse(peer_data_str);
         
-        if(!s.ok())
+        if(doc.HasParseError())
         {
             ASKCOIN_RETURN false;
         }
 
-        rapidjson::Document doc_export_block;
-        const char *block_data_str = block_data.c_str();
-        doc_export_block.Parse(block_data_str);
-        
-        if(doc_export_block.HasParseError())
+        if(!doc.IsObject())
         {
             ASKCOIN_RETURN false;
         }
         
-        if(!doc_export_block.IsObject())
+        if(!doc.HasMember("peers"))
         {
             ASKCOIN_RETURN false;
         }
-        
-        doc_export_block["children"].Clear();
-        rapidjson::StringBuffer buffer;
+
+        if(!doc.HasMember("utc"))
         {
-            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-            doc_export_block.Accept(writer);
-        }
-        std::string export_block_data_str(buffer.GetString(), buffer.GetSize());
-        auto mp_block = m_blocks[m_merge_point->m_export_block_hash];
-        doc.AddMember("id", mp_block->id(), allocator);
-        doc.AddMember("utc", mp_block->utc(), allocator);
-        doc.AddMember("version", mp_block->version(), allocator);
-        doc.AddMember("zero_bits", mp_block->zero_bits(), allocator);
-        doc.AddMember("utc_diff", mp_block->utc_diff(), allocator);
-        doc.AddMember("hash", rapidjson::StringRef(mp_block->hash().c_str()), allocator);
-        doc.AddMember("detail", doc_export_block, allocator);
-        
-        for(int32 i = 0; i < 9; ++i)
+            ASKCOIN_RETURN false;
+        }
+
+        if(!doc["utc"].IsUint64())
         {
-            pow_arr.PushBack(mp_block->m_accum_pow.m_n32[i], allocator);
+            ASKCOIN_RETURN false;
         }
         
-        doc.AddMember("pow", pow_arr, allocator);
-        rapidjson::Value miners(rapidjson::kArrayType);
-        
-        for(auto &miner_pubkey : m_miner_pubkeys)
+        const rapidjson::Value &peers = doc["peers"];
+
+        if(!peers.IsArray())
+        {
+            ASKCOIN_RETURN false;
+        }
+    
+        for(rapidjson::Value::ConstValueIterator iter = peers.Begin(); iter != peers.End(); ++iter)
+        {
+            const rapidjson::Value &peer_info = *iter;
+
+            if(!peer_info.HasMember("host"))
+            {
+                ASKCOIN_RETURN false;
+            }
+
+            if(!peer_info.HasMember("port"))
+            {
+                ASKCOIN_RETURN false;
+            }
+
+            if(!peer_info.HasMember("score"))
+            {
+                ASKCOIN_RETURN false;
+            }
+            
+            std::shared_ptr<net::p2p::Peer_Score> peer_score(new net::p2p::Peer_Score(fly::net::Addr(peer_info["host"].GetString(), peer_info["port"].GetUint()), peer_info["score"].GetUint64()));
+            net::p2p::Node::instance()->add_peer_score(peer_score);
+        }
+    }
+    
+    // sized before any thread starts, the msg thread reads it through get_mine_stat
+    m_mine_stats.reset(new Mine_Stat[m_mine_thread_num]);
+    m_committer.start(m_store);
+    std::thread msg_thread(std::bind(&Blockchain::do_message, this));
+    m_msg_thread = std::move(msg_thread);
+
+    std::thread mine_thread(std::bind(&Blockchain::do_mine, this));
+    m_mine_thread = std::move(mine_thread);
+    CONSOLE_LOG_INFO("mine worker threads num: %u", m_mine_thread_num);
+
+    for(uint32 i = 0; i < m_mine_thread_num; ++i)
+    {
+        std::thread worker_thread(std::bind(&Blockchain::do_mine_worker, this, i));
+        m_mine_worker_threads.push_back(std::move(worker_thread));
+    }
+    
+    std::thread score_thread(std::bind(&Blockchain::do_score, this));
+    m_score_thread = std::move(score_thread);
+    
+    return true;
+}
+
+bool Blockchain::capture_merge_point(std::shared_ptr<Block> mp_block, Merge_Export &merge_export)
+{
+    if(mp_block->id() != merge_export.m_block_id)
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!check_balance())
+    {
+        CONSOLE_LOG_FATAL("merge_point export failed, check_balance failed");
+        return false;
+    }
+    
+    rapidjson::Document doc_export_block;
+    Store_Status s = m_committer.get_block(mp_block->hash(), doc_export_block);
+        
+    if(!s.ok())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(doc_export_block.HasMember("pruned"))
+    {
+        CONSOLE_LOG_FATAL("merge_point export failed, the body of block %lu was pruned", mp_block->id());
+        return false;
+    }
+    
+    doc_export_block["children"].Clear();
+    std::string peer_data;
+    s = m_committer.get("peer_score", &peer_data);
+        
+    if(!s.ok())
+    {
+        CONSOLE_LOG_FATAL("read peer score data from leveldb failed: %s", s.to_string().c_str());
+
+        return false;
+    }
+        
+    rapidjson::Document doc_peer;
+    const char *peer_data_str = peer_data.c_str();
+    doc_peer.Parse(peer_data_str);
+        
+    if(doc_peer.HasParseError())
+    {
+        ASKCOIN_RETURN false;
+    }
+        
+    if(!doc_peer.IsObject())
+    {
+        ASKCOIN_RETURN false;
+    }
+        
+    if(!doc_peer.HasMember("peers"))
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!doc_peer.HasMember("utc"))
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!doc_peer["utc"].IsUint64())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    const rapidjson::Value &peers = doc_peer["peers"];
+        
+    if(!peers.IsArray())
+    {
+        ASKCOIN_RETURN false;
+    }
+    
+    for(rapidjson::Value::ConstValueIterator iter = peers.Begin(); iter != peers.End(); ++iter)
+    {
+        const rapidjson::Value &peer_info = *iter;
+
+        if(!peer_info.HasMember("host"))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        if(!peer_info.HasMember("port"))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        if(!peer_info.HasMember("score"))
+        {
+            ASKCOIN_RETURN false;
+        }
+    }
+
+    // the blocks which tx_map and topics refer to, they are written before both of them
+    // so that the importer knows every block when it reaches the first reference.
+    std::map<uint64, std::shared_ptr<Block>> blocks;
+    uint32 tx_num = 0;
+    uint64 record_num = 0;
+    
+    for(auto &p : m_tx_map)
+    {
+        auto &block = p.second;
+
+        if(block->id() + 200 < mp_block->id() + 1)
+        {
+            continue;
+        }
+
+        blocks.insert(std::make_pair(block->id(), block));
+        ++tx_num;
+    }
+    
+    for(auto &topic : m_topic_list)
+    {
+        blocks.insert(std::make_pair(topic->m_block->id(), topic->m_block));
+
+        for(auto &reply : topic->m_reply_list)
+        {
+            blocks.insert(std::make_pair(reply->m_block->id(), reply->m_block));
+        }
+
+        record_num += topic->m_reply_list.size() + 1;
+    }
+
+    // objects of the state are changed in place by the next blocks, so everything the export
+    // needs is copied here in the compact snapshot encoding and turned into json by the writer.
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> json_writer(buffer);
+    doc_export_block.Accept(json_writer);
+    Snapshot_Writer writer;
+    writer.put_uint64(mp_block->id());
+    writer.put_uint64(mp_block->utc());
+    writer.put_uint32(mp_block->version());
+    writer.put_uint32(mp_block->zero_bits());
+    writer.put_uint64(mp_block->utc_diff());
+    writer.put_string(mp_block->hash());
+    writer.put_string(std::string(buffer.GetString(), buffer.GetSize()));
+    
+    for(int32 i = 0; i < 9; ++i)
+    {
+        writer.put_uint64(mp_block->m_accum_pow.m_n32[i]);
+    }
+
+    writer.put_string(peer_data);
+    writer.put_uint32(m_miner_pubkeys.size());
+    
+    for(auto &miner_pubkey : m_miner_pubkeys)
+    {
+        writer.put_string(miner_pubkey);
+    }
+
+    writer.put_uint32(m_account_by_id.size());
+    
+    for(auto &p : m_account_by_id)
+    {
+        auto &account = p.second;
+        writer.put_uint64(account->id());
+        writer.put_string(account->name());
+        writer.put_uint32(account->avatar());
+        writer.put_uint64(account->get_balance());
+        writer.put_string(account->pubkey());
+        writer.put_uint64(account->block_id());
+        writer.put_uint64(account->id() > 1 ? account->get_referrer()->id() : 0);
+    }
+
+    writer.put_uint32(blocks.size());
+    
+    for(auto &p : blocks)
+    {
+        auto &block = p.second;
+        writer.put_uint64(block->id());
+        writer.put_uint64(block->utc());
+        writer.put_uint32(block->version());
+        writer.put_uint32(block->zero_bits());
+        writer.put_string(block->hash());
+    }
+
+    writer.put_uint32(tx_num);
+    
+    for(auto &p : m_tx_map)
+    {
+        auto &block = p.second;
+
+        if(block->id() + 200 < mp_block->id() + 1)
+        {
+            continue;
+        }
+
+        writer.put_uint64(block->id());
+        writer.put_string(p.first);
+    }
+
+    writer.put_uint32(m_topic_list.size());
+    
+    for(auto &topic : m_topic_list)
+    {
+        writer.put_string(topic->key());
+        writer.put_string(topic->m_data);
+        writer.put_uint64(topic->get_balance());
+        writer.put_uint64(topic->get_total());
+        writer.put_uint64(topic->get_owner()->id());
+        writer.put_uint64(topic->m_block->id());
+        writer.put_uint32(topic->m_members.size());
+
+        for(auto &member : topic->m_members)
+        {
+            writer.put_uint64(member.second->id());
+        }
+
+        writer.put_uint32(topic->m_reply_list.size());
+        
+        for(auto &reply : topic->m_reply_list)
+        {
+            auto reply_to = reply->get_reply_to();
+            writer.put_string(reply->key());
+            writer.put_string(reply->m_data);
+            writer.put_uint64(reply->get_balance());
+            writer.put_uint32(reply->type());
+            writer.put_uint64(reply->get_owner()->id());
+            writer.put_string(reply_to ? reply_to->key() : "");
+            writer.put_uint64(reply->m_block->id());
+        }
+    }
+
+    record_num += m_miner_pubkeys.size() + m_account_by_id.size() + blocks.size() + tx_num;
+    merge_export.m_block_hash = mp_block->hash();
+    merge_export.m_data = writer.finish();
+    merge_export.m_record_num.store(record_num, std::memory_order_relaxed);
+    
+    return true;
+}
+
+bool Blockchain::write_merge_point(Merge_Export &merge_export)
+{
+    const std::string &export_path = merge_export.m_path;
+    auto pos = std::string::npos;
+
+    if((pos = export_path.find_last_of('/')) != std::string::npos)
+    {
+        if(pos > 0)
+        {
+            auto export_dir = export_path.substr(0, pos);
+
+            if(fly::base::mkpath(export_dir) == -1)
+            {
+                CONSOLE_LOG_FATAL("merge_point mkpath export_dir: %s failed, reason: %s", \
+                                  export_dir.c_str(), strerror(errno));
+                ASKCOIN_RETURN false;
+            }
+        }
+    }
+
+    Snapshot_Reader reader(merge_export.m_data);
+
+    if(!reader.verify())
+    {
+        ASKCOIN_RETURN false;
+    }
+    
+    Merge_Point_Writer mp_writer(export_path);
+
+    if(!mp_writer.good())
+    {
+        CONSOLE_LOG_FATAL("merge_point export failed, open %s failed, reason: %s", export_path.c_str(), strerror(errno));
+        return false;
+    }
+    
+    rapidjson::Writer<Merge_Point_Ostream> &writer = mp_writer.writer();
+    uint64 last_usec = Timer::now_usec();
+    uint32 num = 0;
+    auto copy_uint32 = [&](const char *key) -> bool {
+        uint32 value = 0;
+
+        if(!reader.get_uint32(value))
+        {
+            return false;
+        }
+
+        writer.Key(key);
+        writer.Uint(value);
+
+        return true;
+    };
+    auto copy_uint64 = [&](const char *key) -> bool {
+        uint64 value = 0;
+
+        if(!reader.get_uint64(value))
+        {
+            return false;
+        }
+
+        writer.Key(key);
+        writer.Uint64(value);
+
+        return true;
+    };
+    auto copy_string = [&](const char *key) -> bool {
+        std::string value;
+
+        if(!reader.get_string(value))
+        {
+            return false;
+        }
+
+        writer.Key(key);
+        writer.String(value.c_str(), value.length());
+
+        return true;
+    };
+    auto copy_json = [&](const char *key) -> bool {
+        std::string value;
+        rapidjson::Document doc;
+
+        if(!reader.get_string(value))
+        {
+            return false;
+        }
+
+        doc.Parse(value.c_str());
+
+        if(doc.HasParseError())
+        {
+            return false;
+        }
+
+        writer.Key(key);
+        doc.Accept(writer);
+
+        return true;
+    };
+
+    // returns false once the node is stopping, an unfinished file is of no use
+    auto progress = [&]() -> bool {
+        uint64 written_num = merge_export.m_written_num.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        if(written_num % 1000 != 0)
+        {
+            return true;
+        }
+
+        merge_export.m_bytes.store(mp_writer.bytes(), std::memory_order_relaxed);
+
+        if(m_stop.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        
+        uint64 now_usec = Timer::now_usec();
+
+        if(now_usec < last_usec + 2000000)
+        {
+            return true;
+        }
+
+        uint64 record_num = merge_export.m_record_num.load(std::memory_order_relaxed);
+        uint64 bytes = mp_writer.bytes();
+        last_usec = now_usec;
+        CONSOLE_LOG_INFO("merge_point export block_id: %lu, records: %lu / %lu (%lu%%), bytes: %lu, speed: %lu KB/s", \
+                         merge_export.m_block_id, written_num, record_num, record_num > 0 ? written_num * 100 / record_num : 100, \
+                         bytes, bytes / 1024 * 1000000 / std::max<uint64>(now_usec - merge_export.m_start_usec, 1));
+
+        return true;
+    };
+    auto write_all = [&]() -> bool {
+        if(!copy_uint64("id") || !copy_uint64("utc") || !copy_uint32("version") || !copy_uint32("zero_bits") \
+           || !copy_uint64("utc_diff") || !copy_string("hash") || !copy_json("detail"))
+        {
+            return false;
+        }
+
+        writer.Key("pow");
+        writer.StartArray();
+    
+        for(int32 i = 0; i < 9; ++i)
+        {
+            uint64 value = 0;
+
+            if(!reader.get_uint64(value))
+            {
+                return false;
+            }
+            
+            writer.Uint(value);
+        }
+
+        writer.EndArray();
+
+        // peer_score is written last, as the exporter has always done
+        std::string peer_data;
+
+        if(!reader.get_string(peer_data) || !reader.get_uint32(num))
+        {
+            return false;
+        }
+        
+        writer.Key("miners");
+        writer.StartArray();
+    
+        for(uint32 i = 0; i < num; ++i)
+        {
+            std::string miner_pubkey;
+
+            if(!reader.get_string(miner_pubkey))
+            {
+                return false;
+            }
+
+            writer.String(miner_pubkey.c_str(), miner_pubkey.length());
+
+            if(!progress())
+            {
+                return false;
+            }
+        }
+
+        writer.EndArray();
+        writer.Key("accounts");
+        writer.StartArray();
+
+        if(!reader.get_uint32(num))
+        {
+            return false;
+        }
+        
+        for(uint32 i = 0; i < num; ++i)
+        {
+            uint64 id = 0;
+            uint64 referrer_id = 0;
+            writer.StartObject();
+
+            if(!reader.get_uint64(id))
+            {
+                return false;
+            }
+
+            writer.Key("id");
+            writer.Uint64(id);
+            
+            if(!copy_string("name") || !copy_uint32("avatar") || !copy_uint64("balance") || !copy_string("pubkey") \
+               || !copy_uint64("block_id") || !reader.get_uint64(referrer_id))
+            {
+                return false;
+            }
+            
+            if(id > 1)
+            {
+                writer.Key("referrer");
+                writer.Uint64(referrer_id);
+            }
+
+            writer.EndObject();
+
+            if(!progress())
+            {
+                return false;
+            }
+        }
+
+        writer.EndArray();
+        writer.Key("blocks");
+        writer.StartArray();
+
+        if(!reader.get_uint32(num))
+        {
+            return false;
+        }
+        
+        for(uint32 i = 0; i < num; ++i)
+        {
+            writer.StartObject();
+
+            if(!copy_uint64("id") || !copy_uint64("utc") || !copy_uint32("version") || !copy_uint32("zero_bits") \
+               || !copy_string("hash"))
+            {
+                return false;
+            }
+
+            writer.EndObject();
+
+            if(!progress())
+            {
+                return false;
+            }
+        }
+
+        writer.EndArray();
+        writer.Key("tx_map");
+        writer.StartArray();
+
+        if(!reader.get_uint32(num))
+        {
+            return false;
+        }
+        
+        for(uint32 i = 0; i < num; ++i)
+        {
+            writer.StartObject();
+
+            if(!copy_uint64("block_id") || !copy_string("tx_id"))
+            {
+                return false;
+            }
+
+            writer.EndObject();
+
+            if(!progress())
+            {
+                return false;
+            }
+        }
+
+        writer.EndArray();
+        writer.Key("topics");
+        writer.StartArray();
+
+        if(!reader.get_uint32(num))
+        {
+            return false;
+        }
+        
+        for(uint32 i = 0; i < num; ++i)
+        {
+            uint32 member_num = 0;
+            uint32 reply_num = 0;
+            writer.StartObject();
+
+            if(!copy_string("key") || !copy_string("data") || !copy_uint64("balance") || !copy_uint64("total") \
+               || !copy_uint64("owner") || !copy_uint64("block_id") || !reader.get_uint32(member_num))
+            {
+                return false;
+            }
+
+            writer.Key("members");
+            writer.StartArray();
+
+            for(uint32 j = 0; j < member_num; ++j)
+            {
+                uint64 member_id = 0;
+
+                if(!reader.get_uint64(member_id))
+                {
+                    return false;
+                }
+
+                writer.Uint64(member_id);
+            }
+
+            writer.EndArray();
+
+            if(!reader.get_uint32(reply_num))
+            {
+                return false;
+            }
+            
+            writer.Key("replies");
+            writer.StartArray();
+        
+            for(uint32 j = 0; j < reply_num; ++j)
+            {
+                std::string reply_to;
+                writer.StartObject();
+
+                if(!copy_string("key") || !copy_string("data") || !copy_uint64("balance") || !copy_uint32("type") \
+                   || !copy_uint64("owner") || !reader.get_string(reply_to))
+                {
+                    return false;
+                }
+                
+                if(!reply_to.empty())
+                {
+                    writer.Key("reply_to");
+                    writer.String(reply_to.c_str(), reply_to.length());
+                }
+
+                if(!copy_uint64("block_id"))
+                {
+                    return false;
+                }
+                
+                writer.EndObject();
+
+                if(!progress())
+                {
+                    return false;
+                }
+            }
+
+            writer.EndArray();
+            writer.EndObject();
+
+            if(!progress())
+            {
+                return false;
+            }
+        }
+
+        writer.EndArray();
+        rapidjson::Document doc_peer;
+        doc_peer.Parse(peer_data.c_str());
+
+        if(doc_peer.HasParseError() || !reader.eof())
+        {
+            return false;
+        }
+        
+        writer.Key("peer_score");
+        doc_peer.Accept(writer);
+
+        return true;
+    };
+
+    if(!write_all())
+    {
+        remove(export_path.c_str());
+
+        if(m_stop.load(std::memory_order_relaxed))
+        {
+            CONSOLE_LOG_FATAL("merge_point export block_id: %lu stopped", merge_export.m_block_id);
+            return false;
+        }
+        
+        ASKCOIN_RETURN false;
+    }
+    
+    if(!mp_writer.finish())
+    {
+        CONSOLE_LOG_FATAL("merge_point export failed, write %s failed, reason: %s", export_path.c_str(), strerror(errno));
+        remove(export_path.c_str());
+        return false;
+    }
+
+    merge_export.m_bytes.store(mp_writer.bytes(), std::memory_order_relaxed);
+
+    return true;
+}
+
+void Blockchain::check_merge_export()
+{
+    if(!m_merge_export)
+    {
+        return;
+    }
+
+    Merge_Export &merge_export = *m_merge_export;
+    
+    if(merge_export.m_thread.joinable())
+    {
+        if(!merge_export.m_done.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        merge_export.m_thread.join();
+        uint64 block_id = merge_export.m_block_id;
+        uint64 bytes = merge_export.m_bytes.load(std::memory_order_relaxed);
+        uint64 cost_usec = std::max<uint64>(Timer::now_usec() - merge_export.m_start_usec, 1);
+        auto iter = m_block_by_id.find(block_id);
+
+        if(!merge_export.m_ok.load(std::memory_order_relaxed))
+        {
+            CONSOLE_LOG_FATAL("merge_point export block_id: %lu failed", block_id);
+        }
+        else if(iter == m_block_by_id.end() || iter->second->hash() != merge_export.m_block_hash)
+        {
+            // the file is consistent, but a merge point should be a block every node agrees on
+            remove(merge_export.m_path.c_str());
+            CONSOLE_LOG_FATAL("merge_point export block_id: %lu failed, block_hash: %s was rolled back", \
+                              block_id, merge_export.m_block_hash.c_str());
+        }
+        else
+        {
+            CONSOLE_LOG_INFO("merge_point export block_id: %lu, block_hash: %s to %s successfully, records: %lu, " \
+                             "bytes: %lu, cost: %lu ms, speed: %lu KB/s", block_id, merge_export.m_block_hash.c_str(), \
+                             merge_export.m_path.c_str(), merge_export.m_record_num.load(std::memory_order_relaxed), \
+                             bytes, cost_usec / 1000, bytes / 1024 * 1000000 / cost_usec);
+        }
+
+        m_merge_export.reset();
+
+        return;
+    }
+
+    uint64 cur_block_id = m_cur_block->id();
+    
+    if(cur_block_id < merge_export.m_block_id)
+    {
+        return;
+    }
+
+    // a switch may apply many blocks before the message loop looks again
+    if(cur_block_id > merge_export.m_block_id)
+    {
+        CONSOLE_LOG_FATAL("merge_point export block_id: %lu failed, the chain moved on to block_id: %lu before it could " \
+                          "be captured", merge_export.m_block_id, cur_block_id);
+        m_merge_export.reset();
+
+        return;
+    }
+
+    merge_export.m_start_usec = Timer::now_usec();
+    
+    if(!capture_merge_point(m_cur_block, merge_export))
+    {
+        CONSOLE_LOG_FATAL("merge_point export block_id: %lu failed", merge_export.m_block_id);
+        m_merge_export.reset();
+
+        return;
+    }
+
+    CONSOLE_LOG_INFO("merge_point export block_id: %lu, block_hash: %s captured, records: %lu, cost: %lu ms, writing to %s", \
+                     merge_export.m_block_id, merge_export.m_block_hash.c_str(), \
+                     merge_export.m_record_num.load(std::memory_order_relaxed), \
+                     (Timer::now_usec() - merge_export.m_start_usec) / 1000, merge_export.m_path.c_str());
+    merge_export.m_thread = std::thread([this, &merge_export]() {
+            merge_export.m_ok.store(write_merge_point(merge_export), std::memory_order_relaxed);
+            merge_export.m_done.store(true, std::memory_order_release);
+        });
+}
+
+bool Blockchain::check_balance()
+{
+    uint64 total_coin = 0;
+    
+    for(auto p : m_account_by_id)
+    {
+        auto account = p.second;
+        total_coin += account->get_balance();
+    }
+    
+    for(auto topic : m_topic_list)
+    {
+        total_coin += topic->get_balance();
+    }
+    
+    return total_coin == (uint64)1000000000000UL;
+}
+
+void Blockchain::get_snapshot_ids(std::vector<uint64> &ids)
+{
+    const std::string prefix = "snapshot_";
+    m_store->iterate_prefix(prefix, [&](const std::string &key, const std::string &value) -> bool {
+            std::string id_str = key.substr(prefix.length());
+            uint64 id = strtoull(id_str.c_str(), NULL, 10);
+
+            if(std::to_string(id) == id_str)
+            {
+                ids.push_back(id);
+            }
+
+            return true;
+        });
+
+    std::sort(ids.begin(), ids.end(), std::greater<uint64>());
+}
+
+bool Blockchain::save_snapshot()
+{
+    Snapshot_Writer writer;
+    uint64 block_id = m_cur_block->id();
+    auto put_history = [&](const std::list<std::shared_ptr<History>> &history_list) {
+        writer.put_uint32(history_list.size());
+
+        for(auto &history : history_list)
+        {
+            writer.put_uint32(history->m_type);
+            writer.put_uint64(history->m_change);
+            writer.put_uint64(history->m_target_id);
+            writer.put_uint32(history->m_target_avatar);
+            writer.put_string(history->m_target_name);
+            writer.put_uint64(history->m_block_id);
+            writer.put_string(history->m_block_hash);
+            writer.put_string(history->m_memo);
+            writer.put_uint64(history->m_utc);
+            writer.put_string(history->m_tx_id);
+        }
+    };
+
+    writer.put_uint32(SNAPSHOT_VERSION);
+    writer.put_uint64(block_id);
+    writer.put_string(m_cur_block->hash());
+    writer.put_uint64(m_cur_account_id);
+    writer.put_uint32(m_account_by_id.size());
+    
+    for(auto &p : m_account_by_id)
+    {
+        auto &account = p.second;
+        auto referrer = account->get_referrer();
+        writer.put_uint64(account->id());
+        writer.put_string(account->name());
+        writer.put_string(account->pubkey());
+        writer.put_uint32(account->avatar());
+        writer.put_uint64(account->block_id());
+        writer.put_uint64(account->get_balance());
+        writer.put_uint64(referrer ? referrer->id() : (uint64)-1);
+        put_history(account->m_history);
+        put_history(account->m_history_for_explorer);
+    }
+
+    writer.put_uint32(m_topic_list.size());
+    
+    for(auto &topic : m_topic_list)
+    {
+        writer.put_string(topic->key());
+        writer.put_string(topic->m_data);
+        writer.put_uint64(topic->m_block->id());
+        writer.put_uint64(topic->get_total());
+        writer.put_uint64(topic->get_balance());
+        writer.put_uint64(topic->get_owner()->id());
+        writer.put_uint32(topic->m_members.size());
+
+        for(auto &p : topic->m_members)
+        {
+            writer.put_string(p.first);
+            writer.put_uint64(p.second->id());
+        }
+
+        writer.put_uint32(topic->m_reply_list.size());
+
+        for(auto &reply : topic->m_reply_list)
+        {
+            auto reply_to = reply->get_reply_to();
+            writer.put_string(reply->key());
+            writer.put_uint32(reply->type());
+            writer.put_uint64(reply->m_block->id());
+            writer.put_string(reply->m_data);
+            writer.put_uint64(reply->get_balance());
+            writer.put_uint64(reply->get_owner()->id());
+            writer.put_string(reply_to ? reply_to->key() : "");
+        }
+    }
+
+    // topics owned and joined by every account, in the same order as m_account_by_id above
+    for(auto &p : m_account_by_id)
+    {
+        auto &account = p.second;
+        writer.put_uint32(account->m_topic_list.size());
+        
+        for(auto &topic : account->m_topic_list)
+        {
+            writer.put_string(topic->key());
+        }
+
+        writer.put_uint32(account->m_joined_topic_list.size());
+        
+        for(auto &topic : account->m_joined_topic_list)
+        {
+            writer.put_string(topic->key());
+        }
+    }
+
+    writer.put_uint32(m_tx_map.size());
+
+    for(auto &p : m_tx_map)
+    {
+        writer.put_string(p.first);
+        writer.put_uint64(p.second->id());
+    }
+
+    writer.put_uint32(m_miner_pubkeys.size());
+
+    for(auto &miner_pubkey : m_miner_pubkeys)
+    {
+        writer.put_string(miner_pubkey);
+    }
+    
+    const std::string &snapshot_data = writer.finish();
+    std::vector<uint64> snapshot_ids;
+    get_snapshot_ids(snapshot_ids);
+    std::unique_ptr<Store_Batch> batch(new Store_Batch);
+    batch->put("snapshot_" + std::to_string(block_id), snapshot_data);
+    uint32 keep_num = 1;
+    
+    for(auto id : snapshot_ids)
+    {
+        if(id == block_id)
+        {
+            continue;
+        }
+
+        if(++keep_num > SNAPSHOT_KEEP)
+        {
+            batch->del("snapshot_" + std::to_string(id));
+        }
+    }
+    
+    // queued behind the block it was taken at, so it never lands in leveldb before that block
+    m_committer.commit(std::move(batch));
+    m_last_snapshot_id = block_id;
+    LOG_INFO("save snapshot successfully, block_id: %lu, size: %lu", block_id, snapshot_data.length());
+    
+    return true;
+}
+
+bool Blockchain::load_snapshot(const std::string &snapshot_data, std::shared_ptr<Block> block)
+{
+    Snapshot_Reader reader(snapshot_data);
+
+    if(!reader.verify())
+    {
+        ASKCOIN_RETURN false;
+    }
+    
+    uint32 version = 0;
+    uint64 block_id = 0;
+    std::string block_hash;
+    uint64 cur_account_id = 0;
+    uint32 num = 0;
+
+    if(!reader.get_uint32(version) || version != SNAPSHOT_VERSION)
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!reader.get_uint64(block_id) || block_id != block->id())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!reader.get_string(block_hash) || block_hash != block->hash())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!reader.get_uint64(cur_account_id))
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    // everything is decoded into local containers first, the current state is
+    // only replaced after the whole snapshot is accepted.
+    std::map<uint64, std::shared_ptr<Account>> account_by_id;
+    std::unordered_map<std::string, std::shared_ptr<Account>> account_by_pubkey;
+    std::unordered_set<std::string> account_names;
+    std::list<std::pair<std::shared_ptr<Account>, uint64>> balances;
+    std::unordered_map<uint64, uint64> referrers;
+    std::unordered_map<std::string, std::shared_ptr<Topic>> topics;
+    std::list<std::shared_ptr<Topic>> topic_list;
+    std::unordered_map<std::string, std::shared_ptr<Block>> tx_map;
+    std::unordered_set<std::string> miner_pubkeys;
+    auto get_block = [&](uint64 id, std::shared_ptr<Block> &block) -> bool {
+        auto iter = m_block_by_id.find(id);
+
+        if(iter == m_block_by_id.end() || id > block_id)
+        {
+            return false;
+        }
+
+        block = iter->second;
+
+        return true;
+    };
+    auto get_account = [&](uint64 id, std::shared_ptr<Account> &account) -> bool {
+        auto iter = account_by_id.find(id);
+
+        if(iter == account_by_id.end())
+        {
+            return false;
+        }
+
+        account = iter->second;
+
+        return true;
+    };
+    auto get_history = [&](std::list<std::shared_ptr<History>> &history_list) -> bool {
+        uint32 num = 0;
+
+        if(!reader.get_uint32(num))
+        {
+            return false;
+        }
+
+        for(uint32 i = 0; i < num; ++i)
+        {
+            auto history = std::make_shared<History>();
+
+            if(!reader.get_uint32(history->m_type) || !reader.get_uint64(history->m_change) \
+               || !reader.get_uint64(history->m_target_id) || !reader.get_uint32(history->m_target_avatar) \
+               || !reader.get_string(history->m_target_name) || !reader.get_uint64(history->m_block_id) \
+               || !reader.get_string(history->m_block_hash) || !reader.get_string(history->m_memo) \
+               || !reader.get_uint64(history->m_utc) || !reader.get_string(history->m_tx_id))
+            {
+                return false;
+            }
+
+            history_list.push_back(history);
+        }
+
+        return true;
+    };
+
+    if(!reader.get_uint32(num))
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    for(uint32 i = 0; i < num; ++i)
+    {
+        uint64 id, account_block_id, balance, referrer_id;
+        uint32 avatar;
+        std::string name, pubkey;
+
+        if(!reader.get_uint64(id) || !reader.get_string(name) || !reader.get_string(pubkey) || !reader.get_uint32(avatar) \
+           || !reader.get_uint64(account_block_id) || !reader.get_uint64(balance) || !reader.get_uint64(referrer_id))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        auto account = std::make_shared<Account>(id, name, pubkey, avatar, account_block_id);
+
+        if(!get_history(account->m_history) || !get_history(account->m_history_for_explorer))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        if(!account_by_id.insert(std::make_pair(id, account)).second)
+        {
+            ASKCOIN_RETURN false;
+        }
+        
+        if(!account_names.insert(name).second)
+        {
+            ASKCOIN_RETURN false;
+        }
+        
+        if(id > 0)
+        {
+            if(!account_by_pubkey.insert(std::make_pair(pubkey, account)).second)
+            {
+                ASKCOIN_RETURN false;
+            }
+        }
+
+        if(referrer_id != (uint64)-1)
+        {
+            referrers[id] = referrer_id;
+        }
+        
+        balances.push_back(std::make_pair(account, balance));
+    }
+
+    if(account_by_id.find(0) == account_by_id.end())
+    {
+        ASKCOIN_RETURN false;
+    }
+    
+    for(auto &p : referrers)
+    {
+        std::shared_ptr<Account> referrer;
+
+        if(!get_account(p.second, referrer))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        account_by_id[p.first]->set_referrer(referrer);
+    }
+
+    if(!reader.get_uint32(num))
+    {
+        ASKCOIN_RETURN false;
+    }
+    
+    for(uint32 i = 0; i < num; ++i)
+    {
+        std::string key, data;
+        uint64 topic_block_id, total, balance, owner_id;
+        std::shared_ptr<Block> topic_block;
+        std::shared_ptr<Account> owner;
+        uint32 member_num, reply_num;
+
+        if(!reader.get_string(key) || !reader.get_string(data) || !reader.get_uint64(topic_block_id) \
+           || !reader.get_uint64(total) || !reader.get_uint64(balance) || !reader.get_uint64(owner_id))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        if(!get_block(topic_block_id, topic_block) || !get_account(owner_id, owner))
+        {
+            ASKCOIN_RETURN false;
+        }
+        
+        std::shared_ptr<Topic> topic(new Topic(key, data, topic_block, total));
+        topic->set_balance(balance);
+        topic->set_owner(owner);
+
+        if(!reader.get_uint32(member_num))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        for(uint32 j = 0; j < member_num; ++j)
+        {
+            std::string tx_id;
+            uint64 member_id;
+            std::shared_ptr<Account> member;
+            
+            if(!reader.get_string(tx_id) || !reader.get_uint64(member_id) || !get_account(member_id, member))
+            {
+                ASKCOIN_RETURN false;
+            }
+
+            topic->m_members.push_back(std::make_pair(tx_id, member));
+        }
+
+        if(!reader.get_uint32(reply_num))
+        {
+            ASKCOIN_RETURN false;
+        }
+        
+        for(uint32 j = 0; j < reply_num; ++j)
+        {
+            std::string reply_key, reply_data, reply_to_key;
+            uint32 type;
+            uint64 reply_block_id, reply_balance, reply_owner_id;
+            std::shared_ptr<Block> reply_block;
+            std::shared_ptr<Account> reply_owner;
+
+            if(!reader.get_string(reply_key) || !reader.get_uint32(type) || !reader.get_uint64(reply_block_id) \
+               || !reader.get_string(reply_data) || !reader.get_uint64(reply_balance) || !reader.get_uint64(reply_owner_id) \
+               || !reader.get_string(reply_to_key))
+            {
+                ASKCOIN_RETURN false;
+            }
+
+            if(!get_block(reply_block_id, reply_block) || !get_account(reply_owner_id, reply_owner))
+            {
+                ASKCOIN_RETURN false;
+            }
+            
+            std::shared_ptr<Reply> reply(new Reply(reply_key, type, reply_block, reply_data));
+            reply->set_owner(reply_owner);
+            reply->set_balance(reply_balance);
+
+            if(!reply_to_key.empty())
+            {
+                std::shared_ptr<Reply> reply_to;
+                
+                if(!topic->get_reply(reply_to_key, reply_to))
+                {
+                    ASKCOIN_RETURN false;
+                }
+
+                reply->set_reply_to(reply_to);
+            }
+
+            topic->m_reply_list.push_back(reply);
+        }
+        
+        if(!topics.insert(std::make_pair(key, topic)).second)
+        {
+            ASKCOIN_RETURN false;
+        }
+        
+        topic_list.push_back(topic);
+    }
+
+    for(auto &p : account_by_id)
+    {
+        auto &account = p.second;
+
+        for(uint32 k = 0; k < 2; ++k)
+        {
+            auto &account_topic_list = (k == 0 ? account->m_topic_list : account->m_joined_topic_list);
+
+            if(!reader.get_uint32(num))
+            {
+                ASKCOIN_RETURN false;
+            }
+            
+            for(uint32 i = 0; i < num; ++i)
+            {
+                std::string key;
+            
+                if(!reader.get_string(key))
+                {
+                    ASKCOIN_RETURN false;
+                }
+
+                auto iter = topics.find(key);
+            
+                if(iter == topics.end())
+                {
+                    ASKCOIN_RETURN false;
+                }
+
+                account_topic_list.push_back(iter->second);
+            }
+        }
+    }
+
+    if(!reader.get_uint32(num))
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    for(uint32 i = 0; i < num; ++i)
+    {
+        std::string tx_id;
+        uint64 tx_block_id;
+        std::shared_ptr<Block> tx_block;
+        
+        if(!reader.get_string(tx_id) || !reader.get_uint64(tx_block_id) || !get_block(tx_block_id, tx_block))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        if(!tx_map.insert(std::make_pair(tx_id, tx_block)).second)
+        {
+            ASKCOIN_RETURN false;
+        }
+    }
+
+    if(!reader.get_uint32(num))
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    for(uint32 i = 0; i < num; ++i)
+    {
+        std::string miner_pubkey;
+
+        if(!reader.get_string(miner_pubkey))
+        {
+            ASKCOIN_RETURN false;
+        }
+
+        miner_pubkeys.insert(miner_pubkey);
+    }
+    
+    if(!reader.eof())
+    {
+        ASKCOIN_RETURN false;
+    }
+    
+    m_account_by_rich.clear();
+    m_account_by_id = std::move(account_by_id);
+    m_account_by_pubkey = std::move(account_by_pubkey);
+    m_account_names = std::move(account_names);
+    m_reserve_fund_account = m_account_by_id[0];
+    m_cur_account_id = cur_account_id;
+    m_topics = std::move(topics);
+    m_topic_list = std::move(topic_list);
+    m_tx_map = std::move(tx_map);
+    m_import_tx_map.clear();
+    m_miner_pubkeys = std::move(miner_pubkeys);
+
+    for(auto &p : balances)
+    {
+        p.first->set_balance(p.second);
+    }
+    
+    return true;
+}
+
+void Blockchain::set_db_in_memory(bool in_memory)
+{
+    m_db_in_memory = in_memory;
+}
+
+void Blockchain::set_prune(bool enable, uint64 depth)
+{
+    m_prune_enable = enable;
+    m_prune_depth = depth;
+}
+
+void Blockchain::set_db_options(uint64 cache_size, uint32 bloom_bits, uint64 write_buffer_size, bool compression)
+{
+    m_db_cache_size = cache_size;
+    m_db_bloom_bits = bloom_bits;
+    m_db_write_buffer_size = write_buffer_size;
+    m_db_compression = compression;
+}
+
+void Blockchain::set_fast_start(bool enable, bool full_verify)
+{
+    m_fast_start = enable;
+    m_full_verify = full_verify;
+}
+
+bool Blockchain::load_verify_key(std::string key_path)
+{
+    std::ifstream ifs(key_path, std::ios::binary);
+
+    if(ifs)
+    {
+        std::string key((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+        if(key.length() != 32)
+        {
+            CONSOLE_LOG_FATAL("verify key %s is invalid, remove it and restart with --full-verify", key_path.c_str());
+            return false;
+        }
+
+        m_verify_key = key;
+        
+        return true;
+    }
+
+    // the key stays outside of the db directory, so a copied db is not trusted by accident
+    unsigned char key[32];
+    GetStrongRandBytes(key, 32);
+    int fd = open(key_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0600);
+
+    if(fd < 0)
+    {
+        CONSOLE_LOG_FATAL("create verify key %s failed", key_path.c_str());
+        return false;
+    }
+
+    bool ok = write(fd, key, 32) == 32;
+    close(fd);
+
+    if(!ok)
+    {
+        CONSOLE_LOG_FATAL("write verify key %s failed", key_path.c_str());
+        return false;
+    }
+
+    m_verify_key.assign((char*)key, 32);
+    CONSOLE_LOG_INFO("create verify key %s successfully", key_path.c_str());
+    
+    return true;
+}
+
+std::string Blockchain::verified_marker_mac(uint64 block_id, std::string block_hash)
+{
+    std::string msg = std::to_string(block_id) + ":" + block_hash;
+    unsigned char mac[CHMAC_SHA256::OUTPUT_SIZE];
+    CHMAC_SHA256((const unsigned char*)m_verify_key.data(), m_verify_key.length()).Write((const unsigned char*)msg.data(), msg.length()).Finalize(mac);
+    
+    return fly::base::base64_encode(mac, CHMAC_SHA256::OUTPUT_SIZE);
+}
+
+bool Blockchain::load_verified_marker(uint64 &block_id, std::string &block_hash)
+{
+    std::string marker_data;
+    Store_Status s = m_committer.get("verified_marker", &marker_data);
+    block_id = 0;
+    
+    if(s.is_not_found())
+    {
+        CONSOLE_LOG_INFO("verified marker doesn't exist, all blocks will be verified");
+        return true;
+    }
+
+    if(!s.ok())
+    {
+        CONSOLE_LOG_FATAL("read verified marker from leveldb failed, reason: %s", s.to_string().c_str());
+        return false;
+    }
+    
+    rapidjson::Document doc;
+    doc.Parse(marker_data.c_str());
+
+    if(doc.HasParseError() || !doc.IsObject())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!doc.HasMember("id") || !doc["id"].IsUint64())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!doc.HasMember("hash") || !doc["hash"].IsString())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    if(!doc.HasMember("mac") || !doc["mac"].IsString())
+    {
+        ASKCOIN_RETURN false;
+    }
+
+    uint64 id = doc["id"].GetUint64();
+    std::string hash = doc["hash"].GetString();
+
+    if(doc["mac"].GetString() != verified_marker_mac(id, hash))
+    {
+        CONSOLE_LOG_INFO("verified marker was not written with this verify key, all blocks will be verified");
+        return true;
+    }
+
+    block_id = id;
+    block_hash = hash;
+    m_verified_id = id;
+    
+    return true;
+}
+
+void Blockchain::put_verified_marker(Store_Batch &batch, uint64 block_id, std::string block_hash)
+{
+    if(!m_fast_start || block_id <= m_verified_id)
+    {
+        return;
+    }
+
+    std::string mac = verified_marker_mac(block_id, block_hash);
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
+    doc.AddMember("id", block_id, allocator);
+    doc.AddMember("hash", rapidjson::StringRef(block_hash.c_str()), allocator);
+    doc.AddMember("mac", rapidjson::StringRef(mac.c_str()), allocator);
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    doc.Accept(writer);
+    batch.put("verified_marker", std::string(buffer.GetString(), buffer.GetSize()));
+    m_verified_id = block_id;
+}
+
+std::string Blockchain::child_edge_key(std::string parent_key, std::string child_hash)
+{
+    return "c:" + parent_key + ":" + child_hash;
+}
+
+void Blockchain::get_children(const rapidjson::Value &doc, std::string block_key, std::vector<std::string> &children_hashes)
+{
+    // records written before the child edges keep their children inline
+    const rapidjson::Value &children = doc["children"];
+
+    for(rapidjson::Value::ConstValueIterator iter = children.Begin(); iter != children.End(); ++iter)
+    {
+        children_hashes.push_back(iter->GetString());
+    }
+
+    get_child_edges(block_key, children_hashes);
+}
+
+void Blockchain::get_children(const Block_Record::Header &header, std::string block_key, std::vector<std::string> &children_hashes)
+{
+    for(auto &child : header.m_children)
+    {
+        children_hashes.push_back(fly::base::base64_encode(child.data(), child.length()));
+    }
+
+    get_child_edges(block_key, children_hashes);
+}
+
+void Blockchain::get_child_edges(std::string block_key, std::vector<std::string> &children_hashes)
+{
+    std::string prefix = child_edge_key(block_key, "");
+    m_store->iterate_prefix(prefix, [&](const std::string &key, const std::string &value) -> bool {
+            children_hashes.push_back(key.substr(prefix.length()));
+
+            return true;
+        });
+}
+
+bool Blockchain::migrate_block_records()
+{
+    // the scan waits for the queued batches and the result is queued behind them, so a
+    // record which the pruners rewrote or deleted meanwhile is never written back.
+    std::unique_ptr<Store_Batch> batch(new Store_Batch);
+    uint32 num = 0;
+    bool finished = true;
+    m_committer.iterate(m_migrate_key, [&](const std::string &key, const std::string &value) -> bool {
+            if(key == m_migrate_key)
+            {
+                return true;
+            }
+
+            if(num == BLOCK_RECORD_MIGRATE_NUM)
+            {
+                finished = false;
+
+                return false;
+            }
+
+            m_migrate_key = key;
+        
+            // only the records keyed by block hash, the genesis record "0" stays json
+            if(key.length() != 44 || Block_Record::is_current(value))
+            {
+                return true;
+            }
+        
+            rapidjson::Document doc;
+
+            if(!Block_Record::decode(value, doc) || !doc.IsObject() || !doc.HasMember("children"))
+            {
+                return true;
+            }
+
+            std::string record;
+            Block_Record::encode(doc, record);
+
+            // a block which does not fit the current layout stays in the tagged encoding
+            if(!Block_Record::is_current(record) && !Block_Record::is_json(value))
+            {
+                return true;
+            }
+
+            batch->put(key, record);
+            ++num;
+
+            return true;
+        });
+    
+    if(num > 0)
+    {
+        m_committer.commit(std::move(batch));
+        m_migrate_num += num;
+    }
+
+    if(finished)
+    {
+        LOG_INFO("migrate block records finished, %lu old records were converted to the current version", m_migrate_num);
+    }
+    
+    return finished;
+}
+
+bool Blockchain::prune_forks(Prune_Job &prune_job)
+{
+    uint64 tip_id = m_cur_block->id();
+
+    if(tip_id <= FORK_PRUNE_DEPTH)
+    {
+        return true;
+    }
+    
+    // the branch we may still switch to is never touched
+    std::unordered_set<Block*> keep;
+
+    for(auto block = m_most_difficult_block; block && !block->m_in_main_chain; block = block->get_parent())
+    {
+        keep.insert(block.get());
+    }
+
+    // a side block can only win by rolling the main chain back to where its branch
+    // forked off, which is impossible once the fork is FORK_PRUNE_DEPTH behind the tip.
+    std::unordered_map<Block*, uint64> fork_ids;
+    std::vector<std::shared_ptr<Block>> &dead_blocks = prune_job.m_dead_blocks;
+    
+    for(auto &p : m_blocks)
+    {
+        auto &block = p.second;
+
+        if(block->m_in_main_chain || keep.find(block.get()) != keep.end())
+        {
+            continue;
+        }
+
+        std::vector<Block*> path;
+        std::shared_ptr<Block> iter_block = block;
+        uint64 fork_id = 0;
+        
+        while(true)
+        {
+            if(!iter_block)
+            {
+                fork_id = tip_id;
+                break;
+            }
+            
+            if(iter_block->m_in_main_chain)
+            {
+                fork_id = iter_block->id();
+                break;
+            }
+
+            auto iter = fork_ids.find(iter_block.get());
+
+            if(iter != fork_ids.end())
+            {
+                fork_id = iter->second;
+                break;
+            }
+
+            path.push_back(iter_block.get());
+            iter_block = iter_block->get_parent();
+        }
+
+        for(auto b : path)
+        {
+            fork_ids[b] = fork_id;
+        }
+        
+        if(fork_id + FORK_PRUNE_DEPTH < tip_id)
+        {
+            dead_blocks.push_back(block);
+        }
+    }
+
+    if(dead_blocks.empty())
+    {
+        return true;
+    }
+    
+    // children go before their parents, if the process stops between two runs no
+    // record is left behind which the loader can not reach any more.
+    std::sort(dead_blocks.begin(), dead_blocks.end(), [](const std::shared_ptr<Block> &a, const std::shared_ptr<Block> &b) {
+            return a->id() > b->id();
+        });
+
+    bool finished = true;
+    
+    if(dead_blocks.size() > FORK_PRUNE_NUM)
+    {
+        dead_blocks.resize(FORK_PRUNE_NUM);
+        finished = false;
+    }
+
+    for(auto &block : dead_blocks)
+    {
+        std::shared_ptr<Block> parent = block->get_parent();
+        Prune_Job::Fork_Block fork_block;
+        fork_block.m_hash = block->hash();
+        fork_block.m_parent_key = block->id() == 1 ? "0" : parent->hash();
+        fork_block.m_parent_in_main_chain = parent->m_in_main_chain;
+        prune_job.m_fork_blocks.push_back(fork_block);
+    }
+    
+    return finished;
+}
+
+void Blockchain::build_prune_batch(Prune_Job &prune_job)
+{
+    std::unique_ptr<Store_Batch> batch(new Store_Batch);
+    std::map<std::string, std::shared_ptr<rapidjson::Document>> parent_docs;
+    uint64 bytes = 0;
+    uint64 key_num = 0;
+    
+    for(auto &fork_block : prune_job.m_fork_blocks)
+    {
+        const std::string &block_hash = fork_block.m_hash;
+        const std::string &parent_key = fork_block.m_parent_key;
+        std::string edge_key = child_edge_key(parent_key, block_hash);
+        std::string data;
+        Store_Status s = m_committer.get(edge_key, &data);
+
+        if(s.ok())
         {
-            miners.PushBack(rapidjson::StringRef(miner_pubkey.c_str()), allocator);
+            batch->del(edge_key);
+            bytes += edge_key.length();
+            ++key_num;
         }
         
-        doc.AddMember("miners", miners, allocator);
+        s = m_committer.get(block_hash, &data);
         
-        for(auto p : m_account_by_id)
+        if(s.ok())
         {
-            rapidjson::Value obj(rapidjson::kObjectType);
-            auto account = p.second;
-            obj.AddMember("id", account->id(), allocator);
-            obj.AddMember("name", rapidjson::StringRef(account->name().c_str()), allocator);
-            obj.AddMember("avatar", account->avatar(), allocator);
-            obj.AddMember("balance", account->get_balance(), allocator);
-            obj.AddMember("pubkey", rapidjson::StringRef(account->pubkey().c_str()), allocator);
-            obj.AddMember("block_id", account->block_id(), allocator);
-
-            if(account->id() > 1)
-            {
-                auto referrer = account->get_referrer();
-                obj.AddMember("referrer", referrer->id(), allocator);
-            }
-            
-            accounts.PushBack(obj, allocator);
+            batch->del(block_hash);
+            bytes += block_hash.length() + data.length();
+            ++key_num;
         }
 
-        doc.AddMember("accounts", accounts, allocator);
-        rapidjson::Value tx_map(rapidjson::kArrayType);
-        std::unordered_map<std::string, std::shared_ptr<Block>> blocks;
-        
-        for(auto &p : m_tx_map)
+        // records written before the child edges list their children inline, the
+        // parent which stays must not name a child the loader can not read.
+        if(fork_block.m_parent_in_main_chain && parent_docs.find(parent_key) == parent_docs.end())
         {
-            auto &block = p.second;
-
-            if(block->id() + 200 < m_merge_point->m_export_block_id + 1)
+            std::shared_ptr<rapidjson::Document> doc = std::make_shared<rapidjson::Document>();
+            s = m_committer.get_block(parent_key, *doc);
+            
+            if(s.ok() && doc->HasMember("children") && (*doc)["children"].Size() > 0)
             {
-                continue;
+                parent_docs[parent_key] = doc;
             }
-            
-            const std::string& block_hash = block->hash();
-            
-            if(blocks.find(block_hash) == blocks.end())
+            else
             {
-                blocks.insert(std::make_pair(block_hash, block));
+                parent_docs[parent_key] = nullptr;
             }
-
-            const std::string& tx_id = p.first;
-            rapidjson::Value obj(rapidjson::kObjectType);
-            obj.AddMember("block_id", block->id(), allocator);
-            obj.AddMember("tx_id", rapidjson::StringRef(tx_id.c_str()), allocator);
-            tx_map.PushBack(obj, allocator);
         }
-        
-        doc.AddMember("tx_map", tx_map, allocator);
-        rapidjson::Value topics(rapidjson::kArrayType);
-        
-        for(auto &topic : m_topic_list)
+
+        auto iter = parent_docs.find(parent_key);
+
+        if(iter != parent_docs.end() && iter->second)
         {
-            rapidjson::Value obj(rapidjson::kObjectType);
-            obj.AddMember("key", rapidjson::StringRef(topic->key().c_str()), allocator);
-            obj.AddMember("data", rapidjson::StringRef(topic->m_data.c_str()), allocator);
-            obj.AddMember("balance", topic->get_balance(), allocator);
-            obj.AddMember("total", topic->get_total(), allocator);
-            obj.AddMember("owner", topic->get_owner()->id(), allocator);
-            auto &block = topic->m_block;
-            const std::string& block_hash = block->hash();
-            
-            if(blocks.find(block_hash) == blocks.end())
-            {
-                blocks.insert(std::make_pair(block_hash, block));
-            }
-            
-            obj.AddMember("block_id", block->id(), allocator);
-            rapidjson::Value members(rapidjson::kArrayType);
+            rapidjson::Value &children = (*iter->second)["children"];
 
-            for(auto member : topic->m_members)
-            {
-                members.PushBack(member.second->id(), allocator);
-            }
-            
-            obj.AddMember("members", members, allocator);
-            rapidjson::Value replies(rapidjson::kArrayType);
-            
-            for(auto &reply : topic->m_reply_list)
+            for(rapidjson::Value::ValueIterator iter_1 = children.Begin(); iter_1 != children.End(); ++iter_1)
             {
-                rapidjson::Value obj(rapidjson::kObjectType);
-                obj.AddMember("key", rapidjson::StringRef(reply->key().c_str()), allocator);
-                obj.AddMember("data", rapidjson::StringRef(reply->m_data.c_str()), allocator);
-                obj.AddMember("balance", reply->get_balance(), allocator);
-                obj.AddMember("type", reply->type(), allocator);
-                obj.AddMember("owner", reply->get_owner()->id(), allocator);
-                auto reply_to = reply->get_reply_to();
-                
-                if(reply_to)
-                {
-                    obj.AddMember("reply_to", rapidjson::StringRef(reply_to->key().c_str()), allocator);
-                }
-                
-                auto &block = reply->m_block;
-                const std::string& block_hash = block->hash();
-                
-                if(blocks.find(block_hash) == blocks.end())
+                if(block_hash == iter_1->GetString())
                 {
-                    blocks.insert(std::make_pair(block_hash, block));
+                    children.Erase(iter_1);
+                    break;
                 }
-                
-                obj.AddMember("block_id", block->id(), allocator);
-                replies.PushBack(obj, allocator);
             }
-            
-            obj.AddMember("replies", replies, allocator);
-            topics.PushBack(obj, allocator);
         }
         
-        doc.AddMember("topics", topics, allocator);
-        rapidjson::Value block_arr(rapidjson::kArrayType);
-        
-        for(auto &p : blocks)
+        prune_job.m_erased_keys.push_back(block_hash);
+    }
+
+    for(auto &p : parent_docs)
+    {
+        if(!p.second)
         {
-            auto block = p.second;
-            rapidjson::Value block_obj(rapidjson::kObjectType);
-            block_obj.AddMember("id", block->id(), allocator);
-            block_obj.AddMember("utc", block->utc(), allocator);
-            block_obj.AddMember("version", block->version(), allocator);
-            block_obj.AddMember("zero_bits", block->zero_bits(), allocator);
-            block_obj.AddMember("hash", rapidjson::StringRef(block->hash().c_str()), allocator);
-            block_arr.PushBack(block_obj, allocator);
+            continue;
         }
+
+        std::string record;
         
-        doc.AddMember("blocks", block_arr, allocator);
-        std::string peer_data;
-        s = m_db->Get(leveldb::ReadOptions(), "peer_score", &peer_data);
-        
+        if(p.first == "0")
+        {
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            p.second->Accept(writer);
+            record.assign(buffer.GetString(), buffer.GetSize());
+        }
+        else
+        {
+            Block_Record::encode(*p.second, record);
+        }
+
+        batch->put(p.first, record);
+        prune_job.m_erased_keys.push_back(p.first);
+    }
+
+    prune_job.m_fork_bytes = bytes;
+    prune_job.m_fork_key_num = key_num;
+    bytes = 0;
+    
+    for(auto &body_block : prune_job.m_body_blocks)
+    {
+        const std::string &block_hash = body_block.m_hash;
+        std::string data;
+        Store_Status s = m_committer.get(block_hash, &data);
+
         if(!s.ok())
         {
-            CONSOLE_LOG_FATAL("read peer score data from leveldb failed: %s", s.ToString().c_str());
+            LOG_ERROR("prune bodies, leveldb read failed, block_hash: %s, reason: %s", block_hash.c_str(), s.to_string().c_str());
+            break;
+        }
 
-            return false;
+        // a parent rewritten above is in the batch already, the header keeps its children
+        rapidjson::Document doc_1;
+        auto iter = parent_docs.find(block_hash);
+        rapidjson::Document &doc = iter != parent_docs.end() && iter->second ? *iter->second : doc_1;
+        
+        if((&doc == &doc_1 && !Block_Record::decode(data, doc_1)) || !doc.IsObject() || !doc.HasMember("data") \
+           || !doc.HasMember("children"))
+        {
+            LOG_ERROR("prune bodies, decode block record failed, block_hash: %s", block_hash.c_str());
+            break;
         }
         
-        rapidjson::Document doc_peer;
-        const char *peer_data_str = peer_data.c_str();
-        doc_peer.Parse(peer_data_str);
+        prune_job.m_pruned_id = body_block.m_id;
         
-        if(doc_peer.HasParseError())
+        if(doc.HasMember("pruned"))
         {
-            ASKCOIN_RETURN false;
+            continue;
         }
         
-        if(!doc_peer.IsObject())
+        // what the loader needs to rebuild the tree and the accumulated pow. the pow and the
+        // signature cover tx_ids and nonce, so the loader trusts a header like a verified block.
+        rapidjson::Document header;
+        header.SetObject();
+        rapidjson::Document::AllocatorType &allocator = header.GetAllocator();
+        const rapidjson::Value &data_node = doc["data"];
+        rapidjson::Value header_data(rapidjson::kObjectType);
+        
+        for(const char *name : {"id", "utc", "version", "zero_bits", "pre_hash", "miner"})
         {
-            ASKCOIN_RETURN false;
+            header_data.AddMember(rapidjson::StringRef(name), rapidjson::Value(data_node[name], allocator), allocator);
         }
         
-        if(!doc_peer.HasMember("peers"))
+        header.AddMember("hash", rapidjson::Value(doc["hash"], allocator), allocator);
+        header.AddMember("sign", rapidjson::Value(doc["sign"], allocator), allocator);
+        header.AddMember("data", header_data, allocator);
+        header.AddMember("tx_num", body_block.m_tx_num, allocator);
+        header.AddMember("pruned", true, allocator);
+        header.AddMember("children", rapidjson::Value(doc["children"], allocator), allocator);
+        std::string record;
+        Block_Record::encode(header, record);
+        batch->put(block_hash, record);
+        prune_job.m_erased_keys.push_back(block_hash);
+
+        if(data.length() > record.length())
         {
-            ASKCOIN_RETURN false;
+            bytes += data.length() - record.length();
         }
+    }
+
+    prune_job.m_batch = std::move(batch);
+    prune_job.m_body_bytes = bytes;
+}
 
-        if(!doc_peer.HasMember("utc"))
+void Blockchain::check_prune()
+{
+    if(m_prune_job)
+    {
+        Prune_Job &prune_job = *m_prune_job;
+        
+        if(!prune_job.m_done.load(std::memory_order_acquire))
         {
-            ASKCOIN_RETURN false;
+            return;
         }
 
-        if(!doc_peer["utc"].IsUint64())
+        prune_job.m_thread.join();
+        Block_Cache *block_cache = Block_Cache::instance();
+
+        for(auto &block : prune_job.m_dead_blocks)
         {
-            ASKCOIN_RETURN false;
+            m_blocks.erase(block->hash());
         }
 
-        const rapidjson::Value &peers = doc_peer["peers"];
-        
-        if(!peers.IsArray())
+        // the cache is dropped together with the commit, a reader which cached the old
+        // record while the thread was busy does not keep it.
+        for(auto &key : prune_job.m_erased_keys)
         {
-            ASKCOIN_RETURN false;
+            block_cache->erase(key);
         }
-    
-        for(rapidjson::Value::ConstValueIterator iter = peers.Begin(); iter != peers.End(); ++iter)
-        {
-            const rapidjson::Value &peer_info = *iter;
 
-            if(!peer_info.HasMember("host"))
-            {
-                ASKCOIN_RETURN false;
-            }
+        if(!prune_job.m_batch->empty())
+        {
+            m_committer.commit(std::move(prune_job.m_batch));
+        }
 
-            if(!peer_info.HasMember("port"))
-            {
-                ASKCOIN_RETURN false;
-            }
+        uint64 block_num = prune_job.m_dead_blocks.size();
 
-            if(!peer_info.HasMember("score"))
-            {
-                ASKCOIN_RETURN false;
-            }
+        if(block_num > 0)
+        {
+            m_pruned_block_num += block_num;
+            m_pruned_bytes += prune_job.m_fork_bytes;
+            LOG_INFO("prune forks, %lu blocks, %lu keys, %lu bytes were reclaimed, total: %lu blocks, %lu bytes", block_num, \
+                     prune_job.m_fork_key_num, prune_job.m_fork_bytes, m_pruned_block_num, m_pruned_bytes);
         }
 
-        doc.AddMember("peer_score", doc_peer, allocator);
-        rapidjson::StringBuffer buffer_sha1;
-        rapidjson::Writer<rapidjson::StringBuffer> writer_sha1(buffer_sha1);
-        doc.Accept(writer_sha1);
-        char buf[20] = {0};
+        bool body_finished = prune_job.m_body_finished;
+        
+        if(prune_job.m_pruned_id > m_pruned_block_id)
+        {
+            m_pruned_body_bytes += prune_job.m_body_bytes;
+            LOG_INFO("prune bodies, block %lu ~ %lu, %lu bytes were reclaimed, total: %lu bytes", m_pruned_block_id + 1, \
+                     prune_job.m_pruned_id, prune_job.m_body_bytes, m_pruned_body_bytes);
+            m_pruned_block_id = prune_job.m_pruned_id;
 
-        if(!fly::base::sha1(buffer_sha1.GetString(), buffer_sha1.GetSize(), buf, 20))
+            // a block which could not be read is tried again by the next regular run
+            body_finished = body_finished || m_pruned_block_id < prune_job.m_body_blocks.back().m_id;
+        }
+        else if(!prune_job.m_body_blocks.empty())
         {
-            ASKCOIN_RETURN false;
+            body_finished = true;
         }
+        
+        // a big backlog is worked off a bit at a time, a few seconds apart
+        m_next_prune_time = time(NULL) + (prune_job.m_finished && body_finished ? 600 : 5);
+        m_prune_job.reset();
 
-        std::string sha1_b64 = fly::base::base64_encode(buf, 20);
-        doc.AddMember("sha1", rapidjson::StringRef(sha1_b64.c_str()), allocator);
-        doc.Accept(writer);
-        CONSOLE_LOG_INFO("merge_point export block_id: %lu, block_hash: %s successfully", \
-                         m_merge_point->m_export_block_id, m_merge_point->m_export_block_hash.c_str());
+        return;
+    }
+    
+    uint64 utc_now = time(NULL);
+
+    if(m_next_prune_time > utc_now)
+    {
+        return;
+    }
+
+    // picking the blocks only looks at the tree in memory, the records are read by the thread
+    std::unique_ptr<Prune_Job> prune_job(new Prune_Job);
+    prune_job->m_finished = prune_forks(*prune_job);
+    prune_job->m_body_finished = prune_bodies(*prune_job);
+
+    if(prune_job->m_dead_blocks.empty() && prune_job->m_body_blocks.empty())
+    {
+        m_next_prune_time = utc_now + (prune_job->m_finished && prune_job->m_body_finished ? 600 : 5);
+
+        return;
+    }
+
+    m_prune_job = std::move(prune_job);
+    Prune_Job &job = *m_prune_job;
+    job.m_thread = std::thread([this, &job]() {
+            build_prune_batch(job);
+            job.m_done.store(true, std::memory_order_release);
+        });
+}
+
+bool Blockchain::prune_bodies(Prune_Job &prune_job)
+{
+    if(!m_prune_enable)
+    {
         return true;
     }
     
-    char hash_raw[32];
-    fly::base::base64_decode(m_cur_block->hash().c_str(), m_cur_block->hash().length(), hash_raw, 32);
-    std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
-    CONSOLE_LOG_INFO("load block finished, zero_bits: %u, cur_block_id: %lu, cur_block_hash: %s (hex: %s)", \
-                     m_cur_block->zero_bits(), m_cur_block->id(), m_cur_block->hash().c_str(), hex_hash.c_str());
-    m_timer_ctl.add_timer([this]() {
-            this->broadcast();
-        }, 10000);
+    uint64 tip_id = m_cur_block->id();
 
-    m_timer_ctl.add_timer([this]() {
-            uint64 utc_now = time(NULL);
+    if(tip_id <= m_prune_depth)
+    {
+        return true;
+    }
 
-            if(m_last_mine_time + 5 < utc_now)
-            {
-                mine_tx();
-                m_last_mine_time = time(NULL);
-            }
-        }, 1000);
+    // a restart loads the same snapshot as start() does and replays the blocks after it, which
+    // expires the txs of the TOPIC_LIFE_TIME + 1 blocks before the snapshot, so they stay as well.
+    std::vector<uint64> snapshot_ids;
+    get_snapshot_ids(snapshot_ids);
+    uint64 snapshot_id = 0;
     
-    for(auto p : m_account_by_id)
+    for(auto id : snapshot_ids)
     {
-        auto account = p.second;
-        account->proc_history_expired(m_cur_block->id());
+        if(id + 2 * TOPIC_LIFE_TIME > tip_id)
+        {
+            continue;
+        }
+
+        if(m_merge_point->m_import_block_id > 0 && id < m_merge_point->m_import_block_id + 2 * TOPIC_LIFE_TIME)
+        {
+            continue;
+        }
+
+        if(m_merge_point->m_export_block_id > 0 && id >= m_merge_point->m_export_block_id)
+        {
+            continue;
+        }
+
+        snapshot_id = id;
+        break;
+    }
+
+    if(snapshot_id <= TOPIC_LIFE_TIME + 1)
+    {
+        return true;
     }
     
-    if(!check_balance())
+    uint64 start_id = std::max(m_pruned_block_id, m_merge_point->m_import_block_id) + 1;
+    uint64 end_id = std::min(tip_id - m_prune_depth, snapshot_id - TOPIC_LIFE_TIME - 1);
+
+    if(start_id > end_id)
     {
-        CONSOLE_LOG_FATAL("check_balance failed");
+        return true;
+    }
 
-        ASKCOIN_RETURN false;
+    bool finished = true;
+    
+    if(end_id - start_id + 1 > BODY_PRUNE_NUM)
+    {
+        end_id = start_id + BODY_PRUNE_NUM - 1;
+        finished = false;
     }
     
+    for(uint64 id = start_id; id <= end_id; ++id)
     {
-        std::string peer_data;
-        s = m_db->Get(leveldb::ReadOptions(), "peer_score", &peer_data);
-        
-        if(!s.ok())
+        auto iter = m_block_by_id.find(id);
+
+        if(iter == m_block_by_id.end())
         {
-            CONSOLE_LOG_FATAL("read peer score data from leveldb failed: %s", s.ToString().c_str());
+            LOG_ERROR("prune bodies, main chain block not found, block_id: %lu", id);
 
-            return false;
+            // tried again by the next regular run
+            return true;
         }
+
+        Prune_Job::Body_Block body_block;
+        body_block.m_id = id;
+        body_block.m_hash = iter->second->hash();
+        body_block.m_tx_num = iter->second->m_tx_num;
+        prune_job.m_body_blocks.push_back(body_block);
+    }
+    
+    return finished;
+}
+
+bool Blockchain::get_block_doc(const std::string &block_hash, std::shared_ptr<const rapidjson::Document> &doc)
+{
+    Block_Cache *block_cache = Block_Cache::instance();
+
+    if(block_cache->get(block_hash, doc))
+    {
+        return true;
+    }
+    
+    std::shared_ptr<rapidjson::Document> doc_1 = std::make_shared<rapidjson::Document>();
+    Store_Status s = m_committer.get_block(block_hash, *doc_1);
+    
+    if(!s.ok())
+    {
+        LOG_ERROR("get_block_doc, leveldb read failed, block_hash: %s, reason: %s", block_hash.c_str(), s.to_string().c_str());
         
-        rapidjson::Document doc;
-        const char *peer_data_str = peer_data.c_str();
-        CONSOLE_LOG_INFO("peer score data from leveldb: %s", peer_data_str);
-        doc.Parse(peer_data_str);
-        
-        if(doc.HasParseError())
-        {
-            ASKCOIN_RETURN false;
-        }
+        return false;
+    }
+
+    block_cache->put(block_hash, doc_1, sizeof(rapidjson::Document) + doc_1->GetAllocator().Capacity());
+    doc = doc_1;
+    
+    return true;
+}
+
+bool Blockchain::get_block_header(const std::string &block_hash, Block_Record::Header &header)
+{
+    // a cached document is used as it is, otherwise the record is read without one
+    std::shared_ptr<const rapidjson::Document> doc;
+
+    if(Block_Cache::instance()->get(block_hash, doc))
+    {
+        return Block_Record::header_from_doc(*doc, header);
+    }
+
+    Store_Status s = m_committer.get_block_header(block_hash, header);
+
+    if(!s.ok())
+    {
+        LOG_ERROR("get_block_header, leveldb read failed, block_hash: %s, reason: %s", block_hash.c_str(), s.to_string().c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+bool Blockchain::get_block_txs(const std::string &block_hash, Block_Record::Header &header, std::vector<Block_Record::Tx> &txs)
+{
+    std::shared_ptr<const rapidjson::Document> doc;
+
+    if(Block_Cache::instance()->get(block_hash, doc))
+    {
+        return Block_Record::header_from_doc(*doc, header) && Block_Record::txs_from_doc(*doc, txs);
+    }
+
+    Store_Status s = m_committer.get_block(block_hash, header, txs);
+
+    if(!s.ok())
+    {
+        LOG_ERROR("get_block_txs, leveldb read failed, block_hash: %s, reason: %s", block_hash.c_str(), s.to_string().c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+std::string Blockchain::height_key(uint64 block_id)
+{
+    // big-endian, so the main chain is stored in id order
+    char buf[10] = {'h', ':'};
+
+    for(uint32 i = 0; i < 8; ++i)
+    {
+        buf[2 + i] = (char)(block_id >> ((7 - i) * 8));
+    }
+
+    return std::string(buf, 10);
+}
 
-        if(!doc.IsObject())
-        {
-            ASKCOIN_RETURN false;
-        }
-        
-        if(!doc.HasMember("peers"))
-        {
-            ASKCOIN_RETURN false;
-        }
+void Blockchain::write_height_index()
+{
+    m_committer.commit(std::unique_ptr<Store_Batch>(new Store_Batch(m_height_batch)));
+    m_height_batch.clear();
+}
 
-        if(!doc.HasMember("utc"))
-        {
-            ASKCOIN_RETURN false;
-        }
+bool Blockchain::repair_height_index()
+{
+    Store_Batch batch;
+    uint64 cur_block_id = m_cur_block->id();
+    uint64 next_id = 0;
+    uint64 repair_num = 0;
+    std::string prefix = "h:";
 
-        if(!doc["utc"].IsUint64())
+    auto put_range = [&](uint64 end_id) {
+        for(; next_id < end_id && next_id <= cur_block_id; ++next_id)
         {
-            ASKCOIN_RETURN false;
-        }
-        
-        const rapidjson::Value &peers = doc["peers"];
+            auto iter_1 = m_block_by_id.find(next_id);
 
-        if(!peers.IsArray())
-        {
-            ASKCOIN_RETURN false;
+            if(iter_1 != m_block_by_id.end())
+            {
+                batch.put(height_key(next_id), iter_1->second->hash());
+                ++repair_num;
+            }
         }
+    };
     
-        for(rapidjson::Value::ConstValueIterator iter = peers.Begin(); iter != peers.End(); ++iter)
-        {
-            const rapidjson::Value &peer_info = *iter;
-
-            if(!peer_info.HasMember("host"))
+    // one sequential pass, the index may lag behind the chain if the process died inside a switch
+    m_store->iterate_prefix(prefix, [&](const std::string &key, const std::string &value) -> bool {
+            if(key.size() != 10)
             {
-                ASKCOIN_RETURN false;
+                batch.del(key);
+                ++repair_num;
+
+                return true;
             }
 
-            if(!peer_info.HasMember("port"))
+            uint64 block_id = 0;
+
+            for(uint32 i = 0; i < 8; ++i)
             {
-                ASKCOIN_RETURN false;
+                block_id = (block_id << 8) | (uint8)key[2 + i];
             }
 
-            if(!peer_info.HasMember("score"))
+            put_range(block_id);
+            auto iter_1 = m_block_by_id.find(block_id);
+        
+            if(iter_1 == m_block_by_id.end() || block_id > cur_block_id)
             {
-                ASKCOIN_RETURN false;
+                batch.del(key);
+                ++repair_num;
+            }
+            else if(value != iter_1->second->hash())
+            {
+                batch.put(key, iter_1->second->hash());
+                ++repair_num;
             }
-            
-            std::shared_ptr<net::p2p::Peer_Score> peer_score(new net::p2p::Peer_Score(fly::net::Addr(peer_info["host"].GetString(), peer_info["port"].GetUint()), peer_info["score"].GetUint64()));
-            net::p2p::Node::instance()->add_peer_score(peer_score);
-        }
-    }
-    
-    std::thread msg_thread(std::bind(&Blockchain::do_message, this));
-    m_msg_thread = std::move(msg_thread);
 
-    std::thread mine_thread(std::bind(&Blockchain::do_mine, this));
-    m_mine_thread = std::move(mine_thread);
-    
-    std::thread score_thread(std::bind(&Blockchain::do_score, this));
-    m_score_thread = std::move(score_thread);
-    
-    return true;
-}
+            next_id = block_id + 1;
 
-bool Blockchain::check_balance()
-{
-    uint64 total_coin = 0;
+            return true;
+        });
+
+    put_range(cur_block_id + 1);
     
-    for(auto p : m_account_by_id)
+    if(repair_num == 0)
     {
-        auto account = p.second;
-        total_coin += account->get_balance();
+        return true;
     }
     
-    for(auto topic : m_topic_list)
+    Store_Status s = m_store->write(batch);
+    
+    if(!s.ok())
     {
-        total_coin += topic->get_balance();
+        CONSOLE_LOG_FATAL("repair height index failed, reason: %s", s.to_string().c_str());
+        return false;
     }
+
+    CONSOLE_LOG_INFO("repair height index finished, %lu entries were written", repair_num);
     
-    return total_coin == (uint64)1000000000000UL;
+    return true;
+}
+
+void Blockchain::get_main_chain_hashes(uint64 start_id, uint64 end_id, std::vector<std::string> &block_hashes)
+{
+    std::string end_key = height_key(end_id);
+    uint64 block_id = start_id;
+
+    // stops at the first hole, the caller sees a contiguous range starting at start_id
+    m_store->iterate(height_key(start_id), [&](const std::string &key, const std::string &value) -> bool {
+            if(key.compare(end_key) > 0 || key != height_key(block_id))
+            {
+                return false;
+            }
+
+            block_hashes.push_back(value);
+            ++block_id;
+
+            return true;
+        });
 }
 
 void Blockchain::mine_tx()
@@ -5351,6 +7888,7 @@ void Blockchain::mine_tx()
     m_mine_cur_block_utc = m_cur_block->utc();
     m_mine_zero_bits = zero_bits;
     lock.unlock();
+    m_remine_usec.store(Timer::now_usec(), std::memory_order_relaxed);
     m_need_remine.store(true, std::memory_order_release);
 }
 
@@ -6472,71 +9010,36 @@ void Blockchain::mined_new_block(std::shared_ptr<rapidjson::Document> doc_ptr)
     }
 
     m_miner_pubkeys.insert(miner_pubkey);
-    std::string block_data;
-    leveldb::Status s;
-
-    if(block_id == 1)
-    {
-        s = m_db->Get(leveldb::ReadOptions(), "0", &block_data);
-    }
-    else
-    {
-        s = m_db->Get(leveldb::ReadOptions(), pre_hash, &block_data);
-    }
-    
-    if(!s.ok())
-    {
-        ASKCOIN_EXIT(EXIT_FAILURE);
-    }
-    
-    rapidjson::Document doc_parent;
-    const char *block_data_str = block_data.c_str();
-    doc_parent.Parse(block_data_str);
-            
-    if(doc_parent.HasParseError())
-    {
-        ASKCOIN_EXIT(EXIT_FAILURE);
-    }
-
-    if(!doc_parent.IsObject())
-    {
-        ASKCOIN_EXIT(EXIT_FAILURE);
-    }
-
-    if(!doc_parent.HasMember("children"))
-    {
-        ASKCOIN_EXIT(EXIT_FAILURE);
-    }
-            
-    rapidjson::Value &children = doc_parent["children"];
-
-    if(!children.IsArray())
-    {
-        ASKCOIN_EXIT(EXIT_FAILURE);
-    }
-    
-    bool exist_in_children = false;
+    Store_Status s;
+    std::string edge_key = child_edge_key(block_id == 1 ? "0" : pre_hash, block_hash);
+    bool exist_in_children = true;
     bool exist_block_hash = true;
     
-    for(rapidjson::Value::ConstValueIterator iter = children.Begin(); iter != children.End(); ++iter)
     {
-        if(block_hash == iter->GetString())
+        std::string edge_data;
+        Store_Status s = m_committer.get(edge_key, &edge_data);
+
+        if(!s.ok())
         {
-            exist_in_children = true;
-            LOG_DEBUG_INFO("exist_in_children = true, block_hash: %s, pre_hash: %s", block_hash.c_str(), pre_hash.c_str());
-            break;
+            if(!s.is_not_found())
+            {
+                CONSOLE_LOG_FATAL("read from leveldb failed, key: %s, reason: %s", edge_key.c_str(), s.to_string().c_str());
+                ASKCOIN_EXIT(EXIT_FAILURE);
+            }
+
+            exist_in_children = false;
         }
     }
-            
+    
     {
         std::string block_data;
-        leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
+        Store_Status s = m_committer.get(block_hash, &block_data);
             
         if(!s.ok())
         {
-            if(!s.IsNotFound())
+            if(!s.is_not_found())
             {
-                CONSOLE_LOG_FATAL("read from leveldb failed, hash: %s, reason: %s", block_hash.c_str(), s.ToString().c_str());
+                CONSOLE_LOG_FATAL("read from leveldb failed, hash: %s, reason: %s", block_hash.c_str(), s.to_string().c_str());
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
                     
@@ -6551,39 +9054,19 @@ void Blockchain::mined_new_block(std::shared_ptr<rapidjson::Document> doc_ptr)
 
     rapidjson::Value children_arr(rapidjson::kArrayType);
     doc.AddMember("children", children_arr, doc.GetAllocator());
-    rapidjson::StringBuffer buffer_1;
-    rapidjson::Writer<rapidjson::StringBuffer> writer_1(buffer_1);
-    doc.Accept(writer_1);
-    leveldb::WriteBatch batch;
-    batch.Put(block_hash, leveldb::Slice(buffer_1.GetString(), buffer_1.GetSize()));
-    children.PushBack(rapidjson::StringRef(block_hash.c_str()), doc_parent.GetAllocator());
-    rapidjson::StringBuffer buffer_2;
-    rapidjson::Writer<rapidjson::StringBuffer> writer_2(buffer_2);
-    doc_parent.Accept(writer_2);
-    
-    if(block_id == 1)
-    {
-        batch.Put("0", leveldb::Slice(buffer_2.GetString(), buffer_2.GetSize()));
-    }
-    else
-    {
-        batch.Put(pre_hash, leveldb::Slice(buffer_2.GetString(), buffer_2.GetSize()));
-    }
+    std::unique_ptr<Store_Batch> batch(new Store_Batch);
+    Block_Store::put_block(*batch, block_hash, doc);
+    batch->put(edge_key, std::string());
     
     char hash_raw[32];
     fly::base::base64_decode(block_hash.c_str(), block_hash.length(), hash_raw, 32);
     std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
     LOG_DEBUG_INFO("mined_new_block, zero_bits: %u, block_id: %lu, block_hash: %s (hex: %s), start write to leveldb", \
                    zero_bits, block_id, block_hash.c_str(), hex_hash.c_str());
-    s = m_db->Write(leveldb::WriteOptions(), &batch);
-    
-    if(!s.ok())
-    {
-        LOG_FATAL("writebatch failed, block_hash: %s, pre_hash: %s", block_hash.c_str(), pre_hash.c_str());
-        ASKCOIN_EXIT(EXIT_FAILURE);
-    }
-
-    LOG_INFO("mined_new_block, zero_bits: %u, block_id: %lu, block_hash: %s (hex: %s), write to leveldb completely", \
+    put_verified_marker(*batch, block_id, block_hash);
+    batch->put(height_key(block_id), block_hash);
+    m_committer.commit(std::move(batch));
+    LOG_INFO("mined_new_block, zero_bits: %u, block_id: %lu, block_hash: %s (hex: %s), queued to leveldb", \
              zero_bits, block_id, block_hash.c_str(), hex_hash.c_str());
     m_blocks.insert(std::make_pair(block_hash, cur_block));
     m_block_by_id.insert(std::make_pair(block_id, cur_block));
@@ -7481,30 +9964,14 @@ void Blockchain::switch_to_most_difficult()
             ASKCOIN_EXIT(EXIT_FAILURE);
         }
         
-        std::string block_data;
         std::string block_hash = iter_block->hash();
-        leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
+        rapidjson::Document doc;
+        Store_Status s = m_committer.get_block(block_hash, doc);
         
         if(!s.ok())
         {
             LOG_FATAL("switch_to_most_difficult, leveldb read failed, block_id: %lu, block_hash: %s, reason: %s", \
-                      cur_block_id, block_hash.c_str(), s.ToString().c_str());
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
-
-        rapidjson::Document doc;
-        const char *block_data_str = block_data.c_str();
-        doc.Parse(block_data_str);
-        
-        if(doc.HasParseError())
-        {
-            LOG_FATAL("switch_to_most_difficult, parse block data failed, block_id: %lu, block_hash: %s, reason: %s", \
-                      cur_block_id, block_hash.c_str(), GetParseError_En(doc.GetParseError()));
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
-
-        if(!doc.IsObject())
-        {
+                      cur_block_id, block_hash.c_str(), s.to_string().c_str());
             ASKCOIN_EXIT(EXIT_FAILURE);
         }
         
@@ -8288,7 +10755,10 @@ void Blockchain::switch_to_most_difficult()
         m_miner_pubkeys.insert(miner->pubkey());
         m_block_changed = true;
         m_block_by_id.insert(std::make_pair(cur_block_id, iter_block));
+        m_height_batch.put(height_key(cur_block_id), block_hash);
     }
+
+    write_height_index();
 }
 
 uint64 Blockchain::switch_chain(std::shared_ptr<Pending_Detail_Request> request)
@@ -8476,34 +10946,17 @@ uint64 Blockchain::switch_chain(std::shared_ptr<Pending_Detail_Request> request)
             ASKCOIN_EXIT(EXIT_FAILURE);
         }
         
-        std::string block_data;
         std::string block_hash = iter_block->hash();
-        leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
+        rapidjson::Document doc;
+        Store_Status s = m_committer.get_block(block_hash, doc);
         
         if(!s.ok())
         {
             LOG_FATAL("switch chain, leveldb read failed, block_id: %lu, block_hash: %s, reason: %s", \
-                      cur_block_id, block_hash.c_str(), s.ToString().c_str());
+                      cur_block_id, block_hash.c_str(), s.to_string().c_str());
             
             ASKCOIN_EXIT(EXIT_FAILURE);
         }
-
-        rapidjson::Document doc;
-        const char *block_data_str = block_data.c_str();
-        doc.Parse(block_data_str);
-        
-        if(doc.HasParseError())
-        {
-            LOG_FATAL("swich chain, parse block data failed, block_id: %lu, block_hash: %s, reason: %s", \
-                      cur_block_id, block_hash.c_str(), GetParseError_En(doc.GetParseError()));
-
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
-
-        if(!doc.IsObject())
-        {
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
         
         if(!doc.HasMember("data"))
         {
@@ -9285,7 +11738,10 @@ uint64 Blockchain::switch_chain(std::shared_ptr<Pending_Detail_Request> request)
         m_miner_pubkeys.insert(miner->pubkey());
         m_block_changed = true;
         m_block_by_id.insert(std::make_pair(cur_block_id, iter_block));
+        m_height_batch.put(height_key(cur_block_id), block_hash);
     }
+
+    write_height_index();
     
     return pending_start;
 }
@@ -9306,41 +11762,19 @@ void Blockchain::rollback(uint64 block_id)
             }
         }
         
-        std::string block_data;
         std::string block_hash = m_cur_block->hash();
-        leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
-        
-        if(!s.ok())
-        {
-            LOG_FATAL("rollback, leveldb read failed, block_id: %lu, block_hash: %s, reason: %s", \
-                      cur_block_id, block_hash.c_str(), s.ToString().c_str());
-            
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
-        
-        rapidjson::Document doc;
-        const char *block_data_str = block_data.c_str();
-        doc.Parse(block_data_str);
-        
-        if(doc.HasParseError())
-        {
-            LOG_FATAL("rollback, parse block data failed, block_id: %lu, block_hash: %s, reason: %s", \
-                      cur_block_id, block_hash.c_str(), GetParseError_En(doc.GetParseError()));
-
-            ASKCOIN_EXIT(EXIT_FAILURE);
-        }
+        Block_Record::Header header;
+        std::vector<Block_Record::Tx> txs;
 
-        if(!doc.IsObject())
+        if(!get_block_txs(block_hash, header, txs))
         {
+            LOG_FATAL("rollback, read block failed, block_id: %lu, block_hash: %s", cur_block_id, block_hash.c_str());
             ASKCOIN_EXIT(EXIT_FAILURE);
         }
         
-        const rapidjson::Value &data = doc["data"];
-        const rapidjson::Value &tx_ids = data["tx_ids"];
-        const rapidjson::Value &tx = doc["tx"];
-        int32 tx_num = tx_ids.Size();
+        int32 tx_num = header.m_tx_ids.size();
         
-        if(tx.Size() != tx_num)
+        if(txs.size() != tx_num)
         {
             ASKCOIN_EXIT(EXIT_FAILURE);
         }
@@ -9372,12 +11806,9 @@ void Blockchain::rollback(uint64 block_id)
         
         for(int32 i = tx_num - 1; i >= 0; --i)
         {
-            std::string tx_id = tx_ids[i].GetString();
-            const rapidjson::Value &tx_node = tx[i];
-            const rapidjson::Value &data = tx_node["data"];
-            rapidjson::StringBuffer buffer;
-            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-            data.Accept(writer);
+            std::string tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
+            const Block_Record::Tx &tx = txs[i];
+            std::string data_str = tx.data_json();
             
             //base64 44 bytes length
             if(tx_id.length() != 44)
@@ -9385,7 +11816,7 @@ void Blockchain::rollback(uint64 block_id)
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
 
-            std::string tx_id_verify = coin_hash_b64(buffer.GetString(), buffer.GetSize());
+            std::string tx_id_verify = coin_hash_b64(data_str.data(), data_str.length());
             
             if(tx_id != tx_id_verify)
             {
@@ -9395,7 +11826,7 @@ void Blockchain::rollback(uint64 block_id)
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
             
-            std::string pubkey = data["pubkey"].GetString();
+            std::string pubkey = tx.m_pubkey;
             
             if(pubkey.length() != 88)
             {
@@ -9403,13 +11834,12 @@ void Blockchain::rollback(uint64 block_id)
             }
 
             m_tx_map.erase(tx_id);
-            uint32 tx_type = data["type"].GetUint();
+            uint32 tx_type = tx.m_type;
             
             if(tx_type == 1) // register account
             {
-                const rapidjson::Value &sign_data = data["sign_data"];
-                std::string register_name = sign_data["name"].GetString();
-                std::string referrer_pubkey = sign_data["referrer"].GetString();
+                std::string register_name = tx.m_name;
+                std::string referrer_pubkey = tx.m_referrer;
                 std::shared_ptr<Account> referrer;
                 get_account(referrer_pubkey, referrer);
                 std::shared_ptr<Account> referrer_referrer = referrer->get_referrer();
@@ -9463,8 +11893,8 @@ void Blockchain::rollback(uint64 block_id)
                 
                 if(tx_type == 2) // send coin
                 {
-                    uint64 amount = data["amount"].GetUint64();
-                    std::string receiver_pubkey = data["receiver"].GetString();
+                    uint64 amount = tx.m_amount;
+                    std::string receiver_pubkey = tx.m_receiver;
                     std::shared_ptr<Account> receiver;
                     get_account(receiver_pubkey, receiver);
                     account->add_balance(amount);
@@ -9476,7 +11906,7 @@ void Blockchain::rollback(uint64 block_id)
                 }
                 else if(tx_type == 3) // new topic
                 {
-                    uint64 reward = data["reward"].GetUint64();
+                    uint64 reward = tx.m_reward;
                     account->add_balance(reward);
                     account->m_topic_list.pop_back();
                     m_topic_list.pop_back();
@@ -9486,7 +11916,7 @@ void Blockchain::rollback(uint64 block_id)
                 }
                 else if(tx_type == 4) // reply
                 {
-                    std::string topic_key = data["topic_key"].GetString();
+                    std::string topic_key = tx.m_topic_key;
                     std::shared_ptr<Topic> topic;
                     get_topic(topic_key, topic);
                     topic->m_reply_list.pop_back();
@@ -9504,11 +11934,11 @@ void Blockchain::rollback(uint64 block_id)
                 }
                 else if(tx_type == 5) // reward
                 {
-                    std::string topic_key = data["topic_key"].GetString();
+                    std::string topic_key = tx.m_topic_key;
                     std::shared_ptr<Topic> topic;
                     get_topic(topic_key, topic);
-                    uint64 amount = data["amount"].GetUint64();
-                    std::string reply_to_key = data["reply_to"].GetString();
+                    uint64 amount = tx.m_amount;
+                    std::string reply_to_key = tx.m_reply_to;
                     std::shared_ptr<Reply> reply_to;
                     topic->get_reply(reply_to_key, reply_to);
                     topic->add_balance(amount);
@@ -9561,6 +11991,7 @@ void Blockchain::rollback(uint64 block_id)
 
         m_cur_block->m_in_main_chain = false;
         m_block_by_id.erase(cur_block_id);
+        m_height_batch.del(height_key(cur_block_id));
         m_cur_block = m_cur_block->get_parent();
         cur_block_id  = m_cur_block->id();
     }
@@ -9617,31 +12048,13 @@ void Blockchain::rollback(uint64 block_id)
             {
                 iter_block = block_list.front();
                 uint64 cur_block_id = iter_block->id();
-                std::string block_data;
                 std::string block_hash = iter_block->hash();
-                leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
-                
-                if(!s.ok())
-                {
-                    LOG_FATAL("rollback, leveldb read failed, block_id: %lu, block_hash: %s, reason: %s", cur_block_id, block_hash.c_str(), s.ToString().c_str());
-
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-            
-                rapidjson::Document doc;
-                const char *block_data_str = block_data.c_str();
-                doc.Parse(block_data_str);
-        
-                if(doc.HasParseError())
-                {
-                    LOG_FATAL("rollback, parse block data failed, block_id: %lu, block_hash: %s, reason: %s", cur_block_id, block_hash.c_str(), \
-                              GetParseError_En(doc.GetParseError()));
-
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
+                Block_Record::Header header;
+                std::vector<Block_Record::Tx> txs;
 
-                if(!doc.IsObject())
+                if(!get_block_txs(block_hash, header, txs))
                 {
+                    LOG_FATAL("rollback, read block failed, block_id: %lu, block_hash: %s", cur_block_id, block_hash.c_str());
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
                 
@@ -9658,24 +12071,18 @@ void Blockchain::rollback(uint64 block_id)
                 auto &topic_list = rollback_topics[cur_block_id];
                 auto &tx_pair = rollback_txs[cur_block_id];
                 tx_pair.first = iter_block;
-                const rapidjson::Value &data = doc["data"];
-                const rapidjson::Value &tx_ids = data["tx_ids"];
-                const rapidjson::Value &tx = doc["tx"];
-                uint32 tx_num = tx_ids.Size();
+                uint32 tx_num = header.m_tx_ids.size();
                 
-                if(tx.Size() != tx_num)
+                if(txs.size() != tx_num)
                 {
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
                 
                 for(uint32 i = 0; i < tx_num; ++i)
                 {
-                    std::string tx_id = tx_ids[i].GetString();
-                    const rapidjson::Value &tx_node = tx[i];
-                    const rapidjson::Value &data = tx_node["data"];
-                    rapidjson::StringBuffer buffer;
-                    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                    data.Accept(writer);
+                    std::string tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
+                    const Block_Record::Tx &tx = txs[i];
+                    std::string data_str = tx.data_json();
                 
                     //base64 44 bytes length
                     if(tx_id.length() != 44)
@@ -9683,7 +12090,7 @@ void Blockchain::rollback(uint64 block_id)
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
                 
-                    std::string tx_id_verify = coin_hash_b64(buffer.GetString(), buffer.GetSize());
+                    std::string tx_id_verify = coin_hash_b64(data_str.data(), data_str.length());
             
                     if(tx_id != tx_id_verify)
                     {
@@ -9694,8 +12101,8 @@ void Blockchain::rollback(uint64 block_id)
                     }
 
                     tx_pair.second.push_front(tx_id);
-                    std::string pubkey = data["pubkey"].GetString();
-                    uint32 tx_type = data["type"].GetUint();
+                    std::string pubkey = tx.m_pubkey;
+                    uint32 tx_type = tx.m_type;
                 
                     if(tx_type == 1 || tx_type == 2)
                     {
@@ -9707,8 +12114,8 @@ void Blockchain::rollback(uint64 block_id)
                 
                     if(tx_type == 3) // new topic
                     {
-                        uint64 reward = data["reward"].GetUint64();
-                        std::string topic_data = data["topic"].GetString();
+                        uint64 reward = tx.m_reward;
+                        std::string topic_data = tx.m_topic;
                         std::shared_ptr<Topic> topic(new Topic(tx_id, topic_data, iter_block, reward));
                         topic->set_owner(account);
                         topic_list.push_front(topic);
@@ -9716,7 +12123,7 @@ void Blockchain::rollback(uint64 block_id)
                     }
                     else if(tx_type == 4) // reply
                     {
-                        std::string topic_key = data["topic_key"].GetString();
+                        std::string topic_key = tx.m_topic_key;
                         auto iter = topics.find(topic_key);
                     
                         if(iter == topics.end())
@@ -9725,14 +12132,14 @@ void Blockchain::rollback(uint64 block_id)
                         }
                     
                         std::shared_ptr<Topic> topic = iter->second;
-                        std::string reply_data = data["reply"].GetString();
+                        std::string reply_data = tx.m_reply;
                         std::shared_ptr<Reply> reply(new Reply(tx_id, 0, iter_block, reply_data));
                         reply->set_owner(account);
                         topic->m_reply_list.push_back(reply);
                     
-                        if(data.HasMember("reply_to"))
+                        if(!tx.m_reply_to.empty())
                         {
-                            std::string reply_to_key = data["reply_to"].GetString();
+                            std::string reply_to_key = tx.m_reply_to;
                             std::shared_ptr<Reply> reply_to;
                             topic->get_reply(reply_to_key, reply_to);
                             reply->set_reply_to(reply_to);
@@ -9745,7 +12152,7 @@ void Blockchain::rollback(uint64 block_id)
                     }
                     else if(tx_type == 5) // reward
                     {
-                        std::string topic_key = data["topic_key"].GetString();
+                        std::string topic_key = tx.m_topic_key;
                         auto iter = topics.find(topic_key);
                     
                         if(iter == topics.end())
@@ -9756,8 +12163,8 @@ void Blockchain::rollback(uint64 block_id)
                         std::shared_ptr<Topic> topic = iter->second;
                         std::shared_ptr<Reply> reply(new Reply(tx_id, 1, iter_block, ""));
                         reply->set_owner(account);
-                        uint64 amount = data["amount"].GetUint64();
-                        std::string reply_to_key = data["reply_to"].GetString();
+                        uint64 amount = tx.m_amount;
+                        std::string reply_to_key = tx.m_reply_to;
                         std::shared_ptr<Reply> reply_to;
                         topic->get_reply(reply_to_key, reply_to);
                         reply->set_reply_to(reply_to);
@@ -9779,52 +12186,28 @@ void Blockchain::rollback(uint64 block_id)
             {
                 iter_block = block_list.front();
                 uint64 cur_block_id = iter_block->id();
-                std::string block_data;
                 std::string block_hash = iter_block->hash();
-                leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
-                
-                if(!s.ok())
-                {
-                    LOG_FATAL("rollback, leveldb read failed, block_id: %lu, block_hash: %s, reason: %s", cur_block_id, block_hash.c_str(), s.ToString().c_str());
+                Block_Record::Header header;
+                std::vector<Block_Record::Tx> txs;
 
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-            
-                rapidjson::Document doc;
-                const char *block_data_str = block_data.c_str();
-                doc.Parse(block_data_str);
-        
-                if(doc.HasParseError())
-                {
-                    LOG_FATAL("rollback, parse block data failed, block_id: %lu, block_hash: %s, reason: %s", cur_block_id, block_hash.c_str(), \
-                              GetParseError_En(doc.GetParseError()));
-
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-
-                if(!doc.IsObject())
+                if(!get_block_txs(block_hash, header, txs))
                 {
+                    LOG_FATAL("rollback, read block failed, block_id: %lu, block_hash: %s", cur_block_id, block_hash.c_str());
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
                 
-                const rapidjson::Value &data = doc["data"];
-                const rapidjson::Value &tx_ids = data["tx_ids"];
-                const rapidjson::Value &tx = doc["tx"];
-                uint32 tx_num = tx_ids.Size();
+                uint32 tx_num = header.m_tx_ids.size();
                 
-                if(tx.Size() != tx_num)
+                if(txs.size() != tx_num)
                 {
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
 
                 for(uint32 i = 0; i < tx_num; ++i)
                 {
-                    std::string tx_id = tx_ids[i].GetString();
-                    const rapidjson::Value &tx_node = tx[i];
-                    const rapidjson::Value &data = tx_node["data"];
-                    rapidjson::StringBuffer buffer;
-                    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                    data.Accept(writer);
+                    std::string tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
+                    const Block_Record::Tx &tx = txs[i];
+                    std::string data_str = tx.data_json();
                 
                     //base64 44 bytes length
                     if(tx_id.length() != 44)
@@ -9832,7 +12215,7 @@ void Blockchain::rollback(uint64 block_id)
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
                 
-                    std::string tx_id_verify = coin_hash_b64(buffer.GetString(), buffer.GetSize());
+                    std::string tx_id_verify = coin_hash_b64(data_str.data(), data_str.length());
             
                     if(tx_id != tx_id_verify)
                     {
@@ -9842,8 +12225,8 @@ void Blockchain::rollback(uint64 block_id)
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
                 
-                    std::string pubkey = data["pubkey"].GetString();
-                    uint32 tx_type = data["type"].GetUint();
+                    std::string pubkey = tx.m_pubkey;
+                    uint32 tx_type = tx.m_type;
                 
                     if(tx_type == 1 || tx_type == 2 || tx_type == 3)
                     {
@@ -9855,7 +12238,7 @@ void Blockchain::rollback(uint64 block_id)
                 
                     if(tx_type == 4) // reply
                     {
-                        std::string topic_key = data["topic_key"].GetString();
+                        std::string topic_key = tx.m_topic_key;
                         auto iter = topics.find(topic_key);
                     
                         if(iter == topics.end())
@@ -9864,14 +12247,14 @@ void Blockchain::rollback(uint64 block_id)
                         }
                     
                         std::shared_ptr<Topic> topic = iter->second;
-                        std::string reply_data = data["reply"].GetString();
+                        std::string reply_data = tx.m_reply;
                         std::shared_ptr<Reply> reply(new Reply(tx_id, 0, iter_block, reply_data));
                         reply->set_owner(account);
                         topic->m_reply_list.push_back(reply);
                     
-                        if(data.HasMember("reply_to"))
+                        if(!tx.m_reply_to.empty())
                         {
-                            std::string reply_to_key = data["reply_to"].GetString();
+                            std::string reply_to_key = tx.m_reply_to;
                             std::shared_ptr<Reply> reply_to;
                             topic->get_reply(reply_to_key, reply_to);
                             reply->set_reply_to(reply_to);
@@ -9884,7 +12267,7 @@ void Blockchain::rollback(uint64 block_id)
                     }
                     else if(tx_type == 5) // reward
                     {
-                        std::string topic_key = data["topic_key"].GetString();
+                        std::string topic_key = tx.m_topic_key;
                         auto iter = topics.find(topic_key);
                     
                         if(iter == topics.end())
@@ -9895,8 +12278,8 @@ void Blockchain::rollback(uint64 block_id)
                         std::shared_ptr<Topic> topic = iter->second;
                         std::shared_ptr<Reply> reply(new Reply(tx_id, 1, iter_block, ""));
                         reply->set_owner(account);
-                        uint64 amount = data["amount"].GetUint64();
-                        std::string reply_to_key = data["reply_to"].GetString();
+                        uint64 amount = tx.m_amount;
+                        std::string reply_to_key = tx.m_reply_to;
                         std::shared_ptr<Reply> reply_to;
                         topic->get_reply(reply_to_key, reply_to);
                         reply->set_reply_to(reply_to);
@@ -9917,41 +12300,19 @@ void Blockchain::rollback(uint64 block_id)
         
         while(cur_block_id > target_block_id)
         {
-            std::string block_data;
             std::string block_hash = m_cur_block->hash();
-            leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
-            
-            if(!s.ok())
-            {
-                LOG_FATAL("rollback, leveldb read failed, block_id: %lu, block_hash: %s, reason: %s", \
-                          cur_block_id, block_hash.c_str(), s.ToString().c_str());
-
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-        
-            rapidjson::Document doc;
-            const char *block_data_str = block_data.c_str();
-            doc.Parse(block_data_str);
-        
-            if(doc.HasParseError())
-            {
-                LOG_FATAL("rollback, parse block data failed, block_id: %lu, block_hash: %s, reason: %s", \
-                          cur_block_id, block_hash.c_str(), GetParseError_En(doc.GetParseError()));
-
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
+            Block_Record::Header header;
+            std::vector<Block_Record::Tx> txs;
 
-            if(!doc.IsObject())
+            if(!get_block_txs(block_hash, header, txs))
             {
+                LOG_FATAL("rollback, read block failed, block_id: %lu, block_hash: %s", cur_block_id, block_hash.c_str());
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
             
-            const rapidjson::Value &data = doc["data"];
-            const rapidjson::Value &tx_ids = data["tx_ids"];
-            const rapidjson::Value &tx = doc["tx"];
-            int32 tx_num = tx_ids.Size();
+            int32 tx_num = header.m_tx_ids.size();
         
-            if(tx.Size() != tx_num)
+            if(txs.size() != tx_num)
             {
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
@@ -9983,12 +12344,9 @@ void Blockchain::rollback(uint64 block_id)
             
             for(int32 i = tx_num - 1; i >= 0; --i)
             {
-                std::string tx_id = tx_ids[i].GetString();
-                const rapidjson::Value &tx_node = tx[i];
-                const rapidjson::Value &data = tx_node["data"];
-                rapidjson::StringBuffer buffer;
-                rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                data.Accept(writer);
+                std::string tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
+                const Block_Record::Tx &tx = txs[i];
+                std::string data_str = tx.data_json();
             
                 //base64 44 bytes length
                 if(tx_id.length() != 44)
@@ -9996,7 +12354,7 @@ void Blockchain::rollback(uint64 block_id)
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
 
-                std::string tx_id_verify = coin_hash_b64(buffer.GetString(), buffer.GetSize());
+                std::string tx_id_verify = coin_hash_b64(data_str.data(), data_str.length());
             
                 if(tx_id != tx_id_verify)
                 {
@@ -10006,7 +12364,7 @@ void Blockchain::rollback(uint64 block_id)
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
             
-                std::string pubkey = data["pubkey"].GetString();
+                std::string pubkey = tx.m_pubkey;
             
                 if(pubkey.length() != 88)
                 {
@@ -10014,13 +12372,12 @@ void Blockchain::rollback(uint64 block_id)
                 }
 
                 m_tx_map.erase(tx_id);
-                uint32 tx_type = data["type"].GetUint();
+                uint32 tx_type = tx.m_type;
             
                 if(tx_type == 1) // register account
                 {
-                    const rapidjson::Value &sign_data = data["sign_data"];
-                    std::string register_name = sign_data["name"].GetString();
-                    std::string referrer_pubkey = sign_data["referrer"].GetString();
+                    std::string register_name = tx.m_name;
+                    std::string referrer_pubkey = tx.m_referrer;
                     std::shared_ptr<Account> referrer;
                     get_account(referrer_pubkey, referrer);
                     std::shared_ptr<Account> referrer_referrer = referrer->get_referrer();
@@ -10074,8 +12431,8 @@ void Blockchain::rollback(uint64 block_id)
                 
                     if(tx_type == 2) // send coin
                     {
-                        uint64 amount = data["amount"].GetUint64();
-                        std::string receiver_pubkey = data["receiver"].GetString();
+                        uint64 amount = tx.m_amount;
+                        std::string receiver_pubkey = tx.m_receiver;
                         std::shared_ptr<Account> receiver;
                         get_account(receiver_pubkey, receiver);
                         account->add_balance(amount);
@@ -10087,7 +12444,7 @@ void Blockchain::rollback(uint64 block_id)
                     }
                     else if(tx_type == 3) // new topic
                     {
-                        uint64 reward = data["reward"].GetUint64();
+                        uint64 reward = tx.m_reward;
                         account->add_balance(reward);
                         account->m_topic_list.pop_back();
                         m_topic_list.pop_back();
@@ -10097,7 +12454,7 @@ void Blockchain::rollback(uint64 block_id)
                     }
                     else if(tx_type == 4) // reply
                     {
-                        std::string topic_key = data["topic_key"].GetString();
+                        std::string topic_key = tx.m_topic_key;
                         std::shared_ptr<Topic> topic;
                         get_topic(topic_key, topic);
                         topic->m_reply_list.pop_back();
@@ -10115,11 +12472,11 @@ void Blockchain::rollback(uint64 block_id)
                     }
                     else if(tx_type == 5) // reward
                     {
-                        std::string topic_key = data["topic_key"].GetString();
+                        std::string topic_key = tx.m_topic_key;
                         std::shared_ptr<Topic> topic;
                         get_topic(topic_key, topic);
-                        uint64 amount = data["amount"].GetUint64();
-                        std::string reply_to_key = data["reply_to"].GetString();
+                        uint64 amount = tx.m_amount;
+                        std::string reply_to_key = tx.m_reply_to;
                         std::shared_ptr<Reply> reply_to;
                         topic->get_reply(reply_to_key, reply_to);
                         topic->add_balance(amount);
@@ -10172,6 +12529,7 @@ void Blockchain::rollback(uint64 block_id)
 
             m_cur_block->m_in_main_chain = false;
             m_block_by_id.erase(cur_block_id);
+            m_height_batch.del(height_key(cur_block_id));
             m_cur_block = m_cur_block->get_parent();
             cur_block_id  = m_cur_block->id();
         }
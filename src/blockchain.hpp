@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <thread>
 #include "leveldb/db.h"
+#include "leveldb/write_batch.h"
 #include "fly/base/singleton.hpp"
 #include "fly/base/lock_queue.hpp"
 #include "fly/net/message.hpp"
@@ -19,6 +20,9 @@
 #include "timer.hpp"
 #include "tx/tx.hpp"
 #include "command.hpp"
+#include "block_store.hpp"
+#include "block_record.hpp"
+#include "db_committer.hpp"
 
 using fly::net::Json;
 using fly::net::Wsock;
@@ -33,6 +37,13 @@ using fly::net::Wsock;
 
 #define ASKCOIN_TRACE LOG_DEBUG_INFO("trace at function: %s", __FUNCTION__)
 const uint32 TOPIC_LIFE_TIME = 4320;
+const uint32 SNAPSHOT_INTERVAL = TOPIC_LIFE_TIME;
+const uint32 SNAPSHOT_KEEP = 4;
+const uint32 BLOCK_RECORD_MIGRATE_NUM = 1000;
+const uint32 FORK_PRUNE_DEPTH = 2 * TOPIC_LIFE_TIME;
+const uint32 FORK_PRUNE_NUM = 1000;
+const uint32 BODY_PRUNE_MIN_DEPTH = 4 * TOPIC_LIFE_TIME;
+const uint32 BODY_PRUNE_NUM = 1000;
 
 namespace net {
 namespace p2p {
@@ -48,10 +59,16 @@ public:
     Blockchain();
     ~Blockchain();
     bool start(std::string db_path, bool repair_db);
+    void set_fast_start(bool enable, bool full_verify);
+    void set_db_in_memory(bool in_memory);
+    void set_prune(bool enable, uint64 depth);
+    void set_db_options(uint64 cache_size, uint32 bloom_bits, uint64 write_buffer_size, bool compression);
     bool get_account(std::string pubkey, std::shared_ptr<Account> &account);
     std::string sign(std::string privk_b64, std::string hash_b64);
     bool verify_sign(std::string pubk_b64, std::string hash_b64, std::string sign_b64);
+    static bool check_sign(const std::string &pubk_b64, const std::string &hash_b64, const std::string &sign_b64);
     static bool verify_hash(std::string block_hash, std::string block_data, uint32 zero_bits);
+    static uint32 verify_hash(const std::string block_hash[], const std::string block_data[], const uint32 zero_bits[], uint32 num);
     static bool hash_pow(char hash_arr[32], uint32 zero_bits);
     bool is_base64_char(std::string b64);
     bool account_name_exist(std::string name);
@@ -65,6 +82,9 @@ public:
     void push_command(std::shared_ptr<Command> cmd);
     void do_message();
     void do_mine();
+    void do_mine_worker(uint32 worker_id);
+    void set_mine_thread_num(uint32 num);
+    void get_mine_stat(rapidjson::Value &stat, rapidjson::Document::AllocatorType &allocator);
     void do_score();
     void stop();
     void broadcast();
@@ -105,6 +125,81 @@ public:
         std::string m_password;
     };
     
+    struct Mine_Job
+    {
+        uint64 m_mine_id = 0;
+        uint64 m_cur_block_id = 0;
+        uint64 m_cur_block_utc = 0;
+        uint32 m_zero_bits = 0;
+        std::string m_cur_block_hash;
+        std::string m_miner_key;
+        std::list<std::shared_ptr<tx::Tx>> m_mined_txs;
+        std::atomic<bool> m_found{false};
+        std::atomic<bool> m_first_hash{false};
+        uint64 m_remine_usec = 0;
+    };
+
+    // a merge point export, the state at m_block_id is copied into m_data on the
+    // message thread and written to m_path by m_thread while the node goes on
+    struct Merge_Export
+    {
+        uint64 m_block_id = 0;
+        std::string m_block_hash;
+        std::string m_path;
+        std::string m_data;
+        std::thread m_thread;
+        std::atomic<bool> m_done{false};
+        std::atomic<bool> m_ok{false};
+        std::atomic<uint64> m_record_num{0};
+        std::atomic<uint64> m_written_num{0};
+        std::atomic<uint64> m_bytes{0};
+        uint64 m_start_usec = 0;
+    };
+    
+    // a run of the pruners. the message thread picks the dead blocks and the bodies, m_thread
+    // reads their records and builds m_batch, then the message thread commits it and drops them
+    struct Prune_Job
+    {
+        struct Fork_Block
+        {
+            std::string m_hash;
+            std::string m_parent_key;
+            bool m_parent_in_main_chain;
+        };
+
+        struct Body_Block
+        {
+            uint64 m_id;
+            std::string m_hash;
+            uint32 m_tx_num;
+        };
+        
+        std::vector<std::shared_ptr<Block>> m_dead_blocks;
+        std::vector<Fork_Block> m_fork_blocks;
+        bool m_finished = true;
+        std::vector<Body_Block> m_body_blocks;
+        bool m_body_finished = true;
+
+        // the last body pruned by m_batch, 0 if none
+        uint64 m_pruned_id = 0;
+        uint64 m_body_bytes = 0;
+        std::unique_ptr<Store_Batch> m_batch;
+
+        // the keys deleted or rewritten by m_batch, the block cache drops them
+        std::vector<std::string> m_erased_keys;
+        uint64 m_fork_bytes = 0;
+        uint64 m_fork_key_num = 0;
+        std::thread m_thread;
+        std::atomic<bool> m_done{false};
+    };
+    
+    // counters of one mine worker thread
+    struct Mine_Stat
+    {
+        std::atomic<uint64> m_hashes{0};
+        std::atomic<uint64> m_hash_rate{0};
+    };
+    
     std::shared_ptr<Merge_Point> m_merge_point;
     std::shared_ptr<Exchange_Account> m_exchange_account;
     
@@ -114,6 +209,8 @@ private:
     void punish_brief_req(std::shared_ptr<Pending_Brief_Request> req, bool punish_peer = true);
     void punish_detail_req(std::shared_ptr<Pending_Detail_Request> request, bool punish_peer = true);
     void do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &message);
+    void pre_verify(std::list<std::unique_ptr<fly::net::Message<Json>>> &peer_messages, \
+                    std::list<std::unique_ptr<fly::net::Message<Wsock>>> &wsock_messages);
     void do_brief_chain(std::shared_ptr<Pending_Chain> chain);
     void finish_brief(std::shared_ptr<Pending_Brief_Request> request);
     void finish_detail(std::shared_ptr<Pending_Detail_Request> request);
@@ -132,13 +229,41 @@ private:
     void mine_tx();
     void do_command(std::shared_ptr<Command> cmd);
     void mined_new_block(std::shared_ptr<rapidjson::Document> doc_ptr);
+    void get_snapshot_ids(std::vector<uint64> &ids);
+    static std::string child_edge_key(std::string parent_key, std::string child_hash);
+    void get_children(const rapidjson::Value &doc, std::string block_key, std::vector<std::string> &children_hashes);
+    void get_children(const Block_Record::Header &header, std::string block_key, std::vector<std::string> &children_hashes);
+    void get_child_edges(std::string block_key, std::vector<std::string> &children_hashes);
+    bool migrate_block_records();
+    bool prune_forks(Prune_Job &prune_job);
+    void build_prune_batch(Prune_Job &prune_job);
+    void check_prune();
+    bool prune_bodies(Prune_Job &prune_job);
+    bool get_block_doc(const std::string &block_hash, std::shared_ptr<const rapidjson::Document> &doc);
+    bool get_block_header(const std::string &block_hash, Block_Record::Header &header);
+    bool get_block_txs(const std::string &block_hash, Block_Record::Header &header, std::vector<Block_Record::Tx> &txs);
+    static std::string height_key(uint64 block_id);
+    void write_height_index();
+    bool repair_height_index();
+    void get_main_chain_hashes(uint64 start_id, uint64 end_id, std::vector<std::string> &block_hashes);
+    bool load_verify_key(std::string key_path);
+    std::string verified_marker_mac(uint64 block_id, std::string block_hash);
+    bool load_verified_marker(uint64 &block_id, std::string &block_hash);
+    void put_verified_marker(Store_Batch &batch, uint64 block_id, std::string block_hash);
+    bool save_snapshot();
+    bool load_snapshot(const std::string &snapshot_data, std::shared_ptr<Block> block);
+    bool capture_merge_point(std::shared_ptr<Block> mp_block, Merge_Export &merge_export);
+    bool write_merge_point(Merge_Export &merge_export);
+    void check_merge_export();
     std::atomic<bool> m_stop{false};
     std::thread m_msg_thread;
     std::thread m_mine_thread;
     std::thread m_score_thread;
+    std::vector<std::thread> m_mine_worker_threads;
     bool check_balance();
     uint64 m_cur_account_id = 0;
-    leveldb::DB *m_db;
+    Block_Store *m_store = NULL;
+    Db_Committer m_committer;
     bool m_block_changed = true;
     std::shared_ptr<Block> m_cur_block;
     std::shared_ptr<Block> m_most_difficult_block;
@@ -182,7 +307,20 @@ private:
     std::string m_miner_pubkey;
     uint64 m_mine_cur_block_utc;
     uint32 m_mine_zero_bits;
+    uint32 m_mine_thread_num = 1;
+    std::shared_ptr<Mine_Job> m_mine_job;
+    std::atomic<uint64> m_mine_job_seq {0};
+    std::unique_ptr<Mine_Stat[]> m_mine_stats;
+    std::atomic<uint64> m_remine_usec {0};
+    std::atomic<uint64> m_remine_latency_usec {0};
+    std::atomic<uint64> m_remine_latency_total_usec {0};
+    std::atomic<uint64> m_remine_latency_cnt {0};
+    std::atomic<uint64> m_stale_share_cnt {0};
+    std::list<uint64> m_remine_msecs;
     std::unordered_set<std::string> m_uv_tx_ids;
+
+    // signatures checked ahead on Verify_Pool by pre_verify, keyed by pubkey + hash + sign
+    std::unordered_set<std::string> m_verified_signs;
     
     struct Tx_Comp
     {
@@ -201,6 +339,40 @@ private:
     std::shared_ptr<rapidjson::Document> m_broadcast_doc;
     std::string m_lock_password;
     bool m_is_locked = false;
+    uint64 m_last_snapshot_id = 0;
+    std::string m_migrate_key;
+    uint64 m_migrate_num = 0;
+    uint64 m_migrate_timer_id = 0;
+    uint64 m_next_prune_time = 0;
+    uint64 m_pruned_block_num = 0;
+    uint64 m_pruned_bytes = 0;
+
+    // the run of the pruner whose records are read by its thread, at most one at a time
+    std::unique_ptr<Prune_Job> m_prune_job;
+
+    // main chain blocks 1 ... m_pruned_block_id only keep a header record, their bodies are gone
+    bool m_prune_enable = false;
+    uint64 m_prune_depth = BODY_PRUNE_MIN_DEPTH;
+    uint64 m_pruned_block_id = 0;
+    uint64 m_pruned_body_bytes = 0;
+
+    // the merge_export command, armed until the tip reaches the block, then written by its thread
+    std::unique_ptr<Merge_Export> m_merge_export;
+
+    // "h:<big-endian id>" -> hash of the main chain, collected by rollback and the
+    // switches and written once at the end of the switch
+    Store_Batch m_height_batch;
+    bool m_db_in_memory = false;
+    uint64 m_db_cache_size = 8 * 1024 * 1024;
+    uint32 m_db_bloom_bits = 10;
+    uint64 m_db_write_buffer_size = 4 * 1024 * 1024;
+    bool m_db_compression = true;
+    leveldb::Cache *m_db_cache = NULL;
+    const leveldb::FilterPolicy *m_db_filter = NULL;
+    bool m_fast_start = false;
+    bool m_full_verify = false;
+    std::string m_verify_key;
+    uint64 m_verified_id = 0;
 };
 
 #endif
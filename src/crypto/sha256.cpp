@@ -9,14 +9,25 @@
 #include <string.h>
 #include <atomic>
 
+#include <algorithm>
+#include <vector>
+
 #if defined(__x86_64__) || defined(__amd64__)
-#if defined(USE_ASM)
 #include <cpuid.h>
+#if defined(USE_ASM)
 namespace sha256_sse4
 {
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 }
 #endif
+namespace sha256_shani
+{
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
+}
+namespace sha256_avx2
+{
+void Transform_8way(uint32_t* s, const unsigned char* const* chunks);
+}
 #endif
 
 // Internal implementation code.
@@ -174,21 +185,178 @@ bool SelfTest(TransformType tr) {
 
 TransformType Transform = sha256::Transform;
 
+typedef void (*Transform8Type)(uint32_t*, const unsigned char* const*);
+
+Transform8Type Transform8 = nullptr;
+
+void SHA256DScalar(unsigned char* out, const unsigned char* in, size_t len, const CSHA256::Midstate* midstate)
+{
+    CSHA256 sha;
+    unsigned char buf[CSHA256::OUTPUT_SIZE];
+    if (midstate) sha.Restore(*midstate);
+    sha.Write(in, len).Finalize(buf);
+    sha.Reset().Write(buf, CSHA256::OUTPUT_SIZE).Finalize(out);
+}
+
+/** Double SHA-256 of up to 8 messages, one per lane of Transform8. */
+void SHA256D8(unsigned char* out[8], const unsigned char* const in[8], const size_t len[8], size_t num, const CSHA256::Midstate* midstate)
+{
+    static const unsigned char zero_chunk[64] = {0};
+    static const uint32_t init[8] = {0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul};
+    const uint32_t* start = midstate ? midstate->s : init;
+    uint64_t prefix = midstate ? midstate->bytes : 0;
+    uint32_t s[64];
+    unsigned char tail[8][128];
+    unsigned char first[8][64];
+    size_t full[8] = {0}, total[8] = {0}, max_blocks = 0;
+    const unsigned char* chunks[8];
+
+    for (size_t l = 0; l < 8; ++l) {
+        for (int w = 0; w < 8; ++w) s[w * 8 + l] = start[w];
+        if (l >= num) continue;
+        size_t rem = len[l] % 64;
+        full[l] = len[l] / 64;
+        total[l] = full[l] + (rem + 9 > 64 ? 2 : 1);
+        memset(tail[l], 0, sizeof(tail[l]));
+        memcpy(tail[l], in[l] + full[l] * 64, rem);
+        tail[l][rem] = 0x80;
+        WriteBE64(tail[l] + (total[l] - full[l]) * 64 - 8, (prefix + len[l]) << 3);
+        max_blocks = std::max(max_blocks, total[l]);
+    }
+
+    for (size_t r = 0; r < max_blocks; ++r) {
+        for (size_t l = 0; l < 8; ++l) {
+            chunks[l] = r < full[l] ? in[l] + r * 64 : r < total[l] ? tail[l] + (r - full[l]) * 64 : zero_chunk;
+        }
+        Transform8(s, chunks);
+        for (size_t l = 0; l < num; ++l) {
+            if (r + 1 != total[l]) continue;
+            for (int w = 0; w < 8; ++w) WriteBE32(first[l] + w * 4, s[w * 8 + l]);
+        }
+    }
+
+    // second hash, each lane is one block holding the 32 byte digest
+    for (size_t l = 0; l < 8; ++l) {
+        for (int w = 0; w < 8; ++w) s[w * 8 + l] = init[w];
+        chunks[l] = zero_chunk;
+        if (l >= num) continue;
+        memset(first[l] + 32, 0, 32);
+        first[l][32] = 0x80;
+        WriteBE64(first[l] + 56, 256);
+        chunks[l] = first[l];
+    }
+    Transform8(s, chunks);
+    for (size_t l = 0; l < num; ++l) {
+        for (int w = 0; w < 8; ++w) WriteBE32(out[l] + w * 4, s[w * 8 + l]);
+    }
+}
+
+bool SelfTestMulti() {
+    unsigned char data[300];
+    const unsigned char* in[11];
+    size_t len[11];
+    unsigned char out[11 * 32], expect[11 * 32];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = i * 7 + 3;
+    for (size_t i = 0; i < 11; ++i) {
+        in[i] = data + i;
+        len[i] = i * 27;
+        SHA256DScalar(expect + i * 32, in[i], len[i], nullptr);
+    }
+    SHA256DMulti(out, in, len, 11);
+    if (memcmp(out, expect, sizeof(out))) return false;
+    // continue from a midstate taken at a block boundary
+    CSHA256::Midstate midstate;
+    CSHA256().Write(data, 128).Save(midstate);
+    for (size_t i = 0; i < 11; ++i) {
+        unsigned char buf[CSHA256::OUTPUT_SIZE];
+        CSHA256 sha;
+        sha.Write(data, 128).Write(in[i], len[i]).Finalize(buf);
+        sha.Reset().Write(buf, CSHA256::OUTPUT_SIZE).Finalize(expect + i * 32);
+    }
+    SHA256DMulti(out, in, len, 11, &midstate);
+    return memcmp(out, expect, sizeof(out)) == 0;
+}
+
 } // namespace
 
 std::string SHA256AutoDetect()
 {
-#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__))
+    std::string ret = "standard";
+#if defined(__x86_64__) || defined(__amd64__)
     uint32_t eax, ebx, ecx, edx;
-    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx >> 19) & 1) {
+    bool have_sse4 = false, have_shani = false;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        have_sse4 = (ecx >> 19) & 1;
+    }
+    if (have_sse4 && __get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        have_shani = (ebx >> 29) & 1;
+    }
+
+    if (have_shani) {
+        Transform = sha256_shani::Transform;
+        ret = "shani";
+    }
+#if defined(USE_ASM)
+    else if (have_sse4) {
         Transform = sha256_sse4::Transform;
-        assert(SelfTest(Transform));
-        return "sse4";
+        ret = "sse4";
+    }
+#endif
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        Transform8 = sha256_avx2::Transform_8way;
+        assert(SelfTestMulti());
+        if (have_shani) {
+            // one SHA-NI stream outruns 8 AVX2 lanes, keep SHA256DMulti on it
+            Transform8 = nullptr;
+        } else {
+            ret += ",avx2(8way)";
+        }
     }
 #endif
 
     assert(SelfTest(Transform));
-    return "standard";
+    return ret;
+}
+
+void SHA256DMulti(unsigned char* out, const unsigned char* const* in, const size_t* len, size_t num, const CSHA256::Midstate* midstate)
+{
+    size_t done = 0;
+
+    // a midstate with buffered bytes can't be continued lane-wise
+    if (Transform8 && (midstate == nullptr || midstate->bytes % 64 == 0)) {
+        // group messages of similar length, lanes of a group run for as many blocks as the longest one
+        std::vector<size_t> order(num);
+        for (size_t i = 0; i < num; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return len[a] < len[b]; });
+
+        for (; num - done >= 2; done += std::min<size_t>(8, num - done)) {
+            size_t n = std::min<size_t>(8, num - done);
+            unsigned char* lane_out[8];
+            const unsigned char* lane_in[8];
+            size_t lane_len[8];
+            for (size_t l = 0; l < n; ++l) {
+                size_t i = order[done + l];
+                lane_out[l] = out + i * 32;
+                lane_in[l] = in[i];
+                lane_len[l] = len[i];
+            }
+            SHA256D8(lane_out, lane_in, lane_len, n, midstate);
+        }
+
+        if (done < num) {
+            size_t i = order[done];
+            SHA256DScalar(out + i * 32, in[i], len[i], midstate);
+        }
+
+        return;
+    }
+
+    for (; done < num; ++done) {
+        SHA256DScalar(out + done * 32, in[done], len[done], midstate);
+    }
 }
 
 ////// SHA-256
@@ -247,3 +415,18 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+void CSHA256::Save(Midstate& state) const
+{
+    memcpy(state.s, s, sizeof(s));
+    memcpy(state.buf, buf, bytes % 64);
+    state.bytes = bytes;
+}
+
+CSHA256& CSHA256::Restore(const Midstate& state)
+{
+    memcpy(s, state.s, sizeof(s));
+    memcpy(buf, state.buf, state.bytes % 64);
+    bytes = state.bytes;
+    return *this;
+}
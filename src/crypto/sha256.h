@@ -20,10 +20,20 @@ private:
 public:
     static const size_t OUTPUT_SIZE = 32;
 
+    /** Saved hasher state, so a common prefix only has to be compressed once. */
+    struct Midstate
+    {
+        uint32_t s[8];
+        unsigned char buf[64];
+        uint64_t bytes;
+    };
+
     CSHA256();
     CSHA256& Write(const unsigned char* data, size_t len);
     void Finalize(unsigned char hash[OUTPUT_SIZE]);
     CSHA256& Reset();
+    void Save(Midstate& state) const;
+    CSHA256& Restore(const Midstate& state);
 };
 
 /** Autodetect the best available SHA256 implementation.
@@ -31,4 +41,11 @@ public:
  */
 std::string SHA256AutoDetect();
 
+/** Compute the double SHA-256 of num independent messages into out (num * 32 bytes),
+ *  using the 8-way AVX2 backend when it is available.
+ *  If midstate is not null, every message continues from it, so in[i] only holds the
+ *  data after the saved prefix.
+ */
+void SHA256DMulti(unsigned char* out, const unsigned char* const* in, const size_t* len, size_t num, const CSHA256::Midstate* midstate = nullptr);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -0,0 +1,219 @@
+#include "fly/base/logger.hpp"
+#include "db_committer.hpp"
+
+Db_Committer::Db_Committer()
+{
+}
+
+Db_Committer::~Db_Committer()
+{
+    stop();
+}
+
+void Db_Committer::add_overlay(const Store_Batch &batch, uint64 seq)
+{
+    for(auto &op : batch.ops())
+    {
+        Pending_Value &pv = m_overlay[op.m_key];
+        pv.m_seq = seq;
+        pv.m_deleted = op.m_deleted;
+        pv.m_value = op.m_value;
+    }
+}
+
+void Db_Committer::start(Block_Store *store)
+{
+    m_store = store;
+    m_thread = std::thread(std::bind(&Db_Committer::do_commit, this));
+}
+
+void Db_Committer::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop = true;
+        m_not_empty.notify_one();
+    }
+
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+uint64 Db_Committer::commit(std::unique_ptr<Store_Batch> batch)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // if the committer falls this far behind, the message thread waits for it
+    // rather than letting the queue and the overlay grow without bound.
+    m_committed.wait(lock, [&] {
+            return m_batches.size() < MAX_PENDING_NUM || !m_thread.joinable();
+        });
+    
+    uint64 seq = ++m_queued_seq;
+    add_overlay(*batch, seq);
+
+    if(!m_thread.joinable())
+    {
+        // not started, or already stopped: write in place
+        Store_Status s = m_store->write(*batch);
+
+        if(!s.ok())
+        {
+            LOG_FATAL("db committer write failed, seq: %lu, reason: %s", seq, s.to_string().c_str());
+            exit(EXIT_FAILURE);
+        }
+
+        m_overlay.clear();
+        m_committed_seq = seq;
+        
+        return seq;
+    }
+    
+    m_batches.push_back(std::make_pair(seq, std::move(batch)));
+    m_not_empty.notify_one();
+
+    return seq;
+}
+
+void Db_Committer::wait(uint64 seq)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_committed.wait(lock, [&] {
+            return m_committed_seq >= seq;
+        });
+}
+
+void Db_Committer::wait_all()
+{
+    uint64 seq = 0;
+    
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        seq = m_queued_seq;
+    }
+
+    wait(seq);
+}
+
+Store_Status Db_Committer::get(const std::string &key, std::string *value)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto iter = m_overlay.find(key);
+
+        if(iter != m_overlay.end())
+        {
+            if(iter->second.m_deleted)
+            {
+                return Store_Status::not_found(key);
+            }
+
+            *value = iter->second.m_value;
+
+            return Store_Status();
+        }
+    }
+
+    return m_store->get(key, value);
+}
+
+Store_Status Db_Committer::write(const Store_Batch &batch)
+{
+    commit(std::unique_ptr<Store_Batch>(new Store_Batch(batch)));
+
+    return Store_Status();
+}
+
+Store_Status Db_Committer::iterate(const std::string &start, Visitor visitor)
+{
+    wait_all();
+
+    return m_store->iterate(start, visitor);
+}
+
+bool Db_Committer::get_property(const std::string &name, std::string *value)
+{
+    return m_store->get_property(name, value);
+}
+
+uint64 Db_Committer::approximate_size(const std::string &start, const std::string &limit)
+{
+    return m_store->approximate_size(start, limit);
+}
+
+uint64 Db_Committer::pending_num()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    return m_batches.size();
+}
+
+void Db_Committer::do_commit()
+{
+    while(true)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_not_empty.wait(lock, [&] {
+                return m_stop || !m_batches.empty();
+            });
+
+        if(m_batches.empty())
+        {
+            return;
+        }
+        
+        std::deque<std::pair<uint64, std::unique_ptr<Store_Batch>>> batches;
+
+        while(!m_batches.empty() && batches.size() < MAX_GROUP_NUM)
+        {
+            batches.push_back(std::move(m_batches.front()));
+            m_batches.pop_front();
+        }
+        
+        lock.unlock();
+        uint64 seq = batches.back().first;
+        Store_Status s;
+
+        if(batches.size() == 1)
+        {
+            s = m_store->write(*batches.front().second);
+        }
+        else
+        {
+            // consecutive blocks during sync, one write for all of them
+            Store_Batch group;
+            
+            for(auto &p : batches)
+            {
+                group.append(*p.second);
+            }
+
+            s = m_store->write(group);
+        }
+        
+        if(!s.ok())
+        {
+            LOG_FATAL("db committer write failed, seq: %lu, reason: %s", seq, s.to_string().c_str());
+            exit(EXIT_FAILURE);
+        }
+
+        lock.lock();
+        
+        for(auto iter = m_overlay.begin(); iter != m_overlay.end();)
+        {
+            if(iter->second.m_seq <= seq)
+            {
+                iter = m_overlay.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+        
+        m_committed_seq = seq;
+        m_committed.notify_all();
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef DB_COMMITTER
+#define DB_COMMITTER
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <condition_variable>
+#include "block_store.hpp"
+#include "fly/base/common.hpp"
+
+// writes batches to the block store on its own thread in the order they were
+// queued, so a compaction stall does not hold up the message thread. batches
+// queued while a write is in progress are merged into the next write. until a
+// batch is written, get() answers its keys from the queued data, so the caller
+// sees its own writes at once. wait() is the durability barrier for callers
+// which must not acknowledge anything before it is in the store. it is a
+// Block_Store itself, so the block and meta calls read through the queue too.
+class Db_Committer : public Block_Store
+{
+public:
+    Db_Committer();
+    ~Db_Committer();
+    void start(Block_Store *store);
+    
+    // writes everything queued and stops the thread
+    void stop();
+
+    // queues the batch and returns its sequence number
+    uint64 commit(std::unique_ptr<Store_Batch> batch);
+
+    // blocks until the batch with the sequence number and all before it are written
+    void wait(uint64 seq);
+    void wait_all();
+    uint64 pending_num();
+    Store_Status get(const std::string &key, std::string *value) override;
+
+    // queues a copy of the batch, like commit
+    Store_Status write(const Store_Batch &batch) override;
+
+    // waits until the queue is written, then iterates the store
+    Store_Status iterate(const std::string &start, Visitor visitor) override;
+    bool get_property(const std::string &name, std::string *value) override;
+    uint64 approximate_size(const std::string &start, const std::string &limit) override;
+
+private:
+    struct Pending_Value
+    {
+        uint64 m_seq;
+        bool m_deleted;
+        std::string m_value;
+    };
+    
+    void add_overlay(const Store_Batch &batch, uint64 seq);
+    void do_commit();
+    const uint32 MAX_PENDING_NUM = 1024;
+    const uint32 MAX_GROUP_NUM = 64;
+    Block_Store *m_store = NULL;
+    std::thread m_thread;
+    std::deque<std::pair<uint64, std::unique_ptr<Store_Batch>>> m_batches;
+    std::unordered_map<std::string, Pending_Value> m_overlay;
+    std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_committed;
+    uint64 m_queued_seq = 0;
+    uint64 m_committed_seq = 0;
+    bool m_stop = false;
+};
+
+#endif
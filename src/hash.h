@@ -39,6 +39,17 @@ public:
         sha.Reset();
         return *this;
     }
+
+    /** Save the state of the inner hasher after the data written so far. */
+    void Save(CSHA256::Midstate& state) const {
+        sha.Save(state);
+    }
+
+    /** Continue from a state previously returned by Save. */
+    CHash256& Restore(const CSHA256::Midstate& state) {
+        sha.Restore(state);
+        return *this;
+    }
 };
 
 /** A hasher class for Bitcoin's 160-bit hash (SHA-256 + RIPEMD-160). */
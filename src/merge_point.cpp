@@ -0,0 +1,409 @@
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include "rapidjson/filereadstream.h"
+#include "rapidjson/error/en.h"
+#include "merge_point.hpp"
+
+namespace
+{
+
+const uint32 BUF_SIZE = 64 * 1024;
+
+bool is_base64_char(const std::string &b64)
+{
+    for(auto c : b64)
+    {
+        if(!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '='))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void skip_space(rapidjson::FileReadStream &is)
+{
+    while(is.Peek() == ' ' || is.Peek() == '\n' || is.Peek() == '\r' || is.Peek() == '\t')
+    {
+        is.Take();
+    }
+}
+
+}
+
+Merge_Point_Ostream::Merge_Point_Ostream(FILE *fp)
+    : m_fp(fp)
+{
+    m_buf.reserve(BUF_SIZE);
+}
+
+void Merge_Point_Ostream::Put(char c)
+{
+    m_buf.push_back(c);
+
+    if(m_buf.length() >= BUF_SIZE)
+    {
+        Flush();
+    }
+}
+
+void Merge_Point_Ostream::Flush()
+{
+    if(m_buf.empty())
+    {
+        return;
+    }
+
+    if(m_hash)
+    {
+        m_sha1.Write((const unsigned char*)m_buf.data(), m_buf.length());
+    }
+
+    if(m_fp != NULL && fwrite(m_buf.data(), 1, m_buf.length(), m_fp) != m_buf.length())
+    {
+        m_good = false;
+    }
+
+    m_bytes += m_buf.length();
+    m_buf.clear();
+}
+
+std::string Merge_Point_Ostream::finish_sha1(const std::string &suffix)
+{
+    Flush();
+    m_sha1.Write((const unsigned char*)suffix.data(), suffix.length());
+    unsigned char buf[CSHA1::OUTPUT_SIZE];
+    m_sha1.Finalize(buf);
+    m_hash = false;
+
+    return fly::base::base64_encode((const char*)buf, CSHA1::OUTPUT_SIZE);
+}
+
+uint64 Merge_Point_Ostream::bytes() const
+{
+    return m_bytes + m_buf.length();
+}
+
+bool Merge_Point_Ostream::good() const
+{
+    return m_good;
+}
+
+Merge_Point_Writer::Merge_Point_Writer(const std::string &path)
+    : m_fp(fopen(path.c_str(), "wb")), m_os(m_fp), m_writer(m_os)
+{
+    if(m_fp != NULL)
+    {
+        m_writer.StartObject();
+    }
+}
+
+Merge_Point_Writer::~Merge_Point_Writer()
+{
+    if(m_fp != NULL)
+    {
+        fclose(m_fp);
+    }
+}
+
+bool Merge_Point_Writer::good() const
+{
+    return m_fp != NULL && m_os.good();
+}
+
+rapidjson::Writer<Merge_Point_Ostream>& Merge_Point_Writer::writer()
+{
+    return m_writer;
+}
+
+bool Merge_Point_Writer::finish()
+{
+    if(m_fp == NULL)
+    {
+        return false;
+    }
+
+    // the hashed form ends where the object would end without the sha1 member
+    std::string sha1_b64 = m_os.finish_sha1("}");
+    m_writer.Key("sha1");
+    m_writer.String(sha1_b64.c_str(), sha1_b64.length());
+    m_writer.EndObject();
+    m_os.Flush();
+    bool ok = m_os.good() && fflush(m_fp) == 0;
+
+    if(fclose(m_fp) != 0)
+    {
+        ok = false;
+    }
+
+    m_fp = NULL;
+
+    return ok;
+}
+
+uint64 Merge_Point_Writer::bytes() const
+{
+    return m_os.bytes();
+}
+
+Merge_Point_Reader::Merge_Point_Reader(const std::string &path, const std::set<std::string> &array_names)
+    : m_path(path), m_array_names(array_names)
+{
+}
+
+bool Merge_Point_Reader::read(Callback cb)
+{
+    m_names.clear();
+    m_error.clear();
+    FILE *fp = fopen(m_path.c_str(), "rb");
+
+    if(fp == NULL)
+    {
+        m_error = std::string("open failed, ") + strerror(errno);
+
+        return false;
+    }
+
+    std::unique_ptr<char[]> buf(new char[BUF_SIZE]);
+    rapidjson::FileReadStream is(fp, buf.get(), BUF_SIZE);
+
+    // the values are written back in compact form to check the sha1, like the exporter did
+    Merge_Point_Ostream os(NULL);
+    rapidjson::Writer<Merge_Point_Ostream> writer(os);
+    std::string sha1_b64;
+
+    auto parse = [&](rapidjson::Document &doc, const std::string &name) -> bool {
+        doc.ParseStream<rapidjson::kParseStopWhenDoneFlag>(is);
+
+        if(doc.HasParseError())
+        {
+            m_error = std::string(GetParseError_En(doc.GetParseError())) + " at offset " + std::to_string(doc.GetErrorOffset());
+
+            if(!name.empty())
+            {
+                m_error += " in " + name;
+            }
+
+            return false;
+        }
+
+        return true;
+    };
+
+    auto read_object = [&]() -> bool {
+        skip_space(is);
+
+        if(is.Take() != '{')
+        {
+            m_error = "the top value should be an object";
+            return false;
+        }
+
+        writer.StartObject();
+        skip_space(is);
+
+        if(is.Peek() == '}')
+        {
+            is.Take();
+            writer.EndObject();
+
+            return true;
+        }
+
+        while(true)
+        {
+            rapidjson::Document key;
+
+            if(!parse(key, ""))
+            {
+                return false;
+            }
+
+            if(!key.IsString())
+            {
+                m_error = "member name should be string";
+                return false;
+            }
+
+            std::string name(key.GetString(), key.GetStringLength());
+            skip_space(is);
+
+            if(is.Take() != ':')
+            {
+                m_error = "':' expected after " + name;
+                return false;
+            }
+
+            m_names.insert(name);
+
+            if(name == "sha1")
+            {
+                rapidjson::Document value;
+
+                if(!parse(value, name))
+                {
+                    return false;
+                }
+
+                if(!value.IsString())
+                {
+                    m_error = "sha1 field should be string";
+                    return false;
+                }
+
+                sha1_b64.assign(value.GetString(), value.GetStringLength());
+
+                if(!is_base64_char(sha1_b64))
+                {
+                    m_error = "sha1 field is invalid";
+                    return false;
+                }
+
+                if(sha1_b64.length() != 28)
+                {
+                    m_error = "length of sha1 field is invalid";
+                    return false;
+                }
+            }
+            else if(m_array_names.find(name) != m_array_names.end())
+            {
+                writer.Key(name.c_str(), name.length());
+                skip_space(is);
+
+                if(is.Take() != '[')
+                {
+                    m_error = name + " field should be array";
+                    return false;
+                }
+
+                writer.StartArray();
+                skip_space(is);
+
+                if(is.Peek() == ']')
+                {
+                    is.Take();
+                }
+                else
+                {
+                    while(true)
+                    {
+                        rapidjson::Document value;
+
+                        if(!parse(value, name))
+                        {
+                            return false;
+                        }
+
+                        value.Accept(writer);
+
+                        if(!cb(name, value))
+                        {
+                            return false;
+                        }
+
+                        skip_space(is);
+                        char c = is.Take();
+
+                        if(c == ']')
+                        {
+                            break;
+                        }
+
+                        if(c != ',')
+                        {
+                            m_error = "',' or ']' expected in " + name;
+                            return false;
+                        }
+                    }
+                }
+
+                writer.EndArray();
+            }
+            else
+            {
+                writer.Key(name.c_str(), name.length());
+                rapidjson::Document value;
+
+                if(!parse(value, name))
+                {
+                    return false;
+                }
+
+                value.Accept(writer);
+
+                if(!cb(name, value))
+                {
+                    return false;
+                }
+            }
+
+            skip_space(is);
+            char c = is.Take();
+
+            if(c == '}')
+            {
+                break;
+            }
+
+            if(c != ',')
+            {
+                m_error = "',' or '}' expected after " + name;
+                return false;
+            }
+        }
+
+        writer.EndObject();
+        skip_space(is);
+
+        if(is.Peek() != '\0')
+        {
+            m_error = "unexpected data after the top object";
+            return false;
+        }
+
+        return true;
+    };
+
+    bool ok = read_object();
+    fclose(fp);
+
+    if(!ok)
+    {
+        return false;
+    }
+
+    if(m_names.find("sha1") == m_names.end())
+    {
+        m_error = "sha1 field not found";
+
+        return false;
+    }
+
+    if(os.finish_sha1("") != sha1_b64)
+    {
+        m_error = "data of import file is invalid";
+
+        return false;
+    }
+
+    return true;
+}
+
+bool Merge_Point_Reader::verify()
+{
+    return read([](const std::string &name, rapidjson::Document &value) -> bool {
+            return true;
+        });
+}
+
+bool Merge_Point_Reader::has_member(const std::string &name) const
+{
+    return m_names.find(name) != m_names.end();
+}
+
+const std::string& Merge_Point_Reader::error() const
+{
+    return m_error;
+}
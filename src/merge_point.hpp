@@ -0,0 +1,87 @@
+#ifndef MERGE_POINT
+#define MERGE_POINT
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <functional>
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "crypto/sha1.h"
+#include "fly/base/common.hpp"
+
+// a merge point file is one json object, its last member "sha1" is the base64 sha1 of the
+// compact form of the object without that member. Merge_Point_Writer and Merge_Point_Reader
+// go through it one member or one array element at a time, so neither of them holds the
+// whole state as a dom and the memory used does not grow with the number of accounts.
+
+// output stream of rapidjson::Writer, hashes the compact json and writes it to fp if any
+class Merge_Point_Ostream
+{
+public:
+    typedef char Ch;
+    Merge_Point_Ostream(FILE *fp);
+    void Put(char c);
+    void Flush();
+
+    // sha1 of everything put so far followed by suffix, what is put afterwards is not hashed
+    std::string finish_sha1(const std::string &suffix);
+    uint64 bytes() const;
+    bool good() const;
+
+private:
+    FILE *m_fp;
+    CSHA1 m_sha1;
+    bool m_hash = true;
+    bool m_good = true;
+    std::string m_buf;
+    uint64 m_bytes = 0;
+};
+
+class Merge_Point_Writer
+{
+public:
+    Merge_Point_Writer(const std::string &path);
+    ~Merge_Point_Writer();
+    bool good() const;
+
+    // the caller writes the members of the top object, StartObject is already done
+    rapidjson::Writer<Merge_Point_Ostream>& writer();
+
+    // appends the sha1 member, closes the top object and the file
+    bool finish();
+    uint64 bytes() const;
+
+private:
+    FILE *m_fp;
+    Merge_Point_Ostream m_os;
+    rapidjson::Writer<Merge_Point_Ostream> m_writer;
+};
+
+class Merge_Point_Reader
+{
+public:
+    // called with every member of the top object except sha1, the members named in
+    // array_names are passed one element at a time. returning false stops the reading.
+    typedef std::function<bool(const std::string &name, rapidjson::Document &value)> Callback;
+    Merge_Point_Reader(const std::string &path, const std::set<std::string> &array_names);
+
+    // one pass over the file, fails if it is malformed or its sha1 does not match. the
+    // sha1 is only known at the end, so a caller which applies the values runs verify first.
+    bool read(Callback cb);
+
+    // a pass which only checks the file and its sha1
+    bool verify();
+    bool has_member(const std::string &name) const;
+
+    // empty if the callback stopped the reading
+    const std::string& error() const;
+
+private:
+    std::string m_path;
+    std::set<std::string> m_array_names;
+    std::set<std::string> m_names;
+    std::string m_error;
+};
+
+#endif
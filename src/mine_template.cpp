@@ -0,0 +1,137 @@
+#include <cstring>
+#include <vector>
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "mine_template.hpp"
+
+static uint32 u64_to_str(uint64 val, char *out)
+{
+    char tmp[20];
+    uint32 len = 0;
+    
+    do
+    {
+        tmp[len++] = '0' + val % 10;
+        val /= 10;
+    } while(val > 0);
+
+    for(uint32 i = 0; i < len; ++i)
+    {
+        out[i] = tmp[len - 1 - i];
+    }
+    
+    return len;
+}
+
+Mine_Template::Mine_Template()
+{
+}
+
+Mine_Template::~Mine_Template()
+{
+}
+
+bool Mine_Template::init(const rapidjson::Value &data)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    data.Accept(writer);
+    m_buf.assign(buffer.GetString(), buffer.GetSize());
+    
+    // all string fields before nonce are base64, so the key names can't appear inside them
+    std::string::size_type utc_pos = m_buf.find("\"utc\":");
+
+    if(utc_pos == std::string::npos)
+    {
+        return false;
+    }
+
+    utc_pos += 6;
+    std::string::size_type utc_end = m_buf.find(',', utc_pos);
+
+    if(utc_end == std::string::npos)
+    {
+        return false;
+    }
+    
+    std::string::size_type nonce_pos = m_buf.rfind("\"nonce\":[");
+
+    if(nonce_pos == std::string::npos || nonce_pos < utc_end)
+    {
+        return false;
+    }
+    
+    nonce_pos += 9;
+    
+    if(m_buf.back() != '}')
+    {
+        return false;
+    }
+    
+    m_utc_pos = utc_pos;
+    m_utc_len = utc_end - utc_pos;
+    m_nonce_pos = nonce_pos;
+    m_size = m_buf.size();
+    save_prefix();
+    
+    return true;
+}
+
+void Mine_Template::save_prefix()
+{
+    m_prefix_len = m_nonce_pos / 64 * 64;
+    CSHA256 sha;
+    sha.Write((const unsigned char*)m_buf.data(), m_prefix_len);
+    sha.Save(m_prefix_state);
+}
+
+void Mine_Template::hash(const std::string tails[], uint32 num, char *h_256) const
+{
+    std::vector<const unsigned char*> in(num);
+    std::vector<size_t> len(num);
+
+    for(uint32 i = 0; i < num; ++i)
+    {
+        in[i] = (const unsigned char*)tails[i].data();
+        len[i] = tails[i].size();
+    }
+    
+    SHA256DMulti((unsigned char*)h_256, &in[0], &len[0], num, &m_prefix_state);
+}
+
+void Mine_Template::set_utc(uint64 utc)
+{
+    char digits[20];
+    uint32 len = u64_to_str(utc, digits);
+
+    if(len == m_utc_len)
+    {
+        memcpy(&m_buf[m_utc_pos], digits, len);
+    }
+    else
+    {
+        m_buf.replace(m_utc_pos, m_utc_len, digits, len);
+        m_nonce_pos = m_nonce_pos + len - m_utc_len;
+        m_size = m_size + len - m_utc_len;
+        m_utc_len = len;
+    }
+    
+    save_prefix();
+}
+
+void Mine_Template::set_nonce(uint64 n0, uint64 n1, uint64 n2, uint64 n3)
+{
+    char tail[4 * 21 + 2];
+    uint32 len = u64_to_str(n0, tail);
+    tail[len++] = ',';
+    len += u64_to_str(n1, tail + len);
+    tail[len++] = ',';
+    len += u64_to_str(n2, tail + len);
+    tail[len++] = ',';
+    len += u64_to_str(n3, tail + len);
+    tail[len++] = ']';
+    tail[len++] = '}';
+    m_buf.resize(m_nonce_pos);
+    m_buf.append(tail, len);
+    m_size = m_buf.size();
+}
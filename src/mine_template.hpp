@@ -0,0 +1,53 @@
+#ifndef MINE_TEMPLATE
+#define MINE_TEMPLATE
+
+#include <string>
+#include "fly/base/common.hpp"
+#include "rapidjson/document.h"
+#include "crypto/sha256.h"
+
+// serialized block header used by the miner. the header data is written once
+// by rapidjson::Writer, afterwards only the digits of utc and nonce are patched,
+// so the buffer always stays byte-identical to what Writer would produce.
+class Mine_Template
+{
+public:
+    Mine_Template();
+    ~Mine_Template();
+    bool init(const rapidjson::Value &data);
+    void set_utc(uint64 utc);
+    void set_nonce(uint64 n0, uint64 n1, uint64 n2, uint64 n3);
+
+    // the bytes of buf() after the 64-byte blocks which precede the nonce
+    std::string tail() const
+    {
+        return m_buf.substr(m_prefix_len);
+    }
+    
+    // coin_hash of the header prefix followed by each of the num tails into h_256
+    // (num * 32 bytes). the prefix is compressed only once per utc.
+    void hash(const std::string tails[], uint32 num, char *h_256) const;
+
+    // bytes appended after size() by the caller are dropped by the next set_nonce
+    std::string& buf()
+    {
+        return m_buf;
+    }
+    
+    uint32 size() const
+    {
+        return m_size;
+    }
+    
+private:
+    void save_prefix();
+    std::string m_buf;
+    CSHA256::Midstate m_prefix_state;
+    uint32 m_prefix_len = 0;
+    uint32 m_size = 0;
+    uint32 m_utc_pos = 0;
+    uint32 m_utc_len = 0;
+    uint32 m_nonce_pos = 0;
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "net/p2p/node.hpp"
 #include "net/p2p/message.hpp"
 #include "blockchain.hpp"
+#include "block_record.hpp"
 #include "version.hpp"
 #include "tx/tx.hpp"
 #include "utilstrencodings.h"
@@ -143,6 +144,9 @@ void Wsock_Node::dispatch(std::unique_ptr<fly::net::Message<Wsock>> message)
             doc.AddMember("msg_id", msg_id, allocator);
             doc.AddMember("utc", time(NULL), allocator);
             doc.AddMember("version", ASKCOIN_VERSION, allocator);
+            rapidjson::Value mine_stat;
+            Blockchain::instance()->get_mine_stat(mine_stat, allocator);
+            doc.AddMember("mine", mine_stat, allocator);
             connection->send(doc);
         }
         else
@@ -1674,76 +1678,22 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
             doc.AddMember("miner_pubkey", rapidjson::StringRef(iter_block->miner_pubkey().c_str()), allocator);
             rapidjson::Value tx_list(rapidjson::kArrayType);
             
-            if(iter_block->m_tx_num > 0)
+            // a pruned block only has its header left, the page comes without the tx list
+            if(iter_block->m_tx_num > 0 && iter_block->id() > m_pruned_block_id)
             {
-                std::string block_data;
-                leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
-                
-                if(!s.ok())
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-                
-                rapidjson::Document doc_1;
-                const char *block_data_str = block_data.c_str();
-                doc_1.Parse(block_data_str);
-                
-                if(doc_1.HasParseError())
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
+                Block_Record::Header header;
 
-                if(!doc_1.IsObject())
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-        
-                if(!doc_1.HasMember("data"))
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-
-                if(!doc_1.HasMember("tx"))
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-
-                const rapidjson::Value &data = doc_1["data"];
-        
-                if(!data.IsObject())
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-        
-                if(!data.HasMember("tx_ids"))
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-        
-                const rapidjson::Value &tx_ids = data["tx_ids"];
-                const rapidjson::Value &tx = doc_1["tx"];
-        
-                if(!tx_ids.IsArray())
+                if(!get_block_header(iter_block->hash(), header) || header.m_pruned)
                 {
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
 
-                if(!tx.IsArray())
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
-        
-                uint32 tx_num = tx_ids.Size();
+                uint32 tx_num = header.m_tx_ids.size();
 
                 if(tx_num > 2000)
                 {
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
-        
-                if(tx.Size() != tx_num)
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
 
                 if(tx_num != iter_block->m_tx_num)
                 {
@@ -1752,7 +1702,7 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                 
                 for(uint32 i = 0; i < tx_num; ++i)
                 {
-                    std::string tx_id = tx_ids[i].GetString();
+                    std::string tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
                     tx_list.PushBack(rapidjson::Value(tx_id.c_str(), allocator), allocator);
                 }
             }
@@ -1819,6 +1769,11 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                 }
             }
 
+            if(iter_block->id() <= m_pruned_block_id)
+            {
+                ASKCOIN_RETURN;
+            }
+
             rapidjson::Document doc;
             doc.SetObject();
             rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
@@ -1830,22 +1785,14 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
             
             if(iter_block->m_tx_num > 0)
             {
-                std::string block_data;
-                leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
+                std::shared_ptr<const rapidjson::Document> doc_ptr;
                 
-                if(!s.ok())
+                if(!get_block_doc(iter_block->hash(), doc_ptr))
                 {
                     ASKCOIN_EXIT(EXIT_FAILURE);
                 }
 
-                rapidjson::Document doc_1;
-                const char *block_data_str = block_data.c_str();
-                doc_1.Parse(block_data_str);
-        
-                if(doc_1.HasParseError())
-                {
-                    ASKCOIN_EXIT(EXIT_FAILURE);
-                }
+                const rapidjson::Document &doc_1 = *doc_ptr;
 
                 if(!doc_1.IsObject())
                 {
@@ -2266,74 +2213,19 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
 
                 if(iter_block->m_tx_num > 0)
                 {
-                    std::string block_data;
-                    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
-                
-                    if(!s.ok())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-                
-                    rapidjson::Document doc_1;
-                    const char *block_data_str = block_data.c_str();
-                    doc_1.Parse(block_data_str);
-                
-                    if(doc_1.HasParseError())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
+                    Block_Record::Header header;
 
-                    if(!doc_1.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    if(!doc_1.HasMember("data"))
+                    if(!get_block_header(iter_block->hash(), header) || header.m_pruned)
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
 
-                    if(!doc_1.HasMember("tx"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    const rapidjson::Value &data = doc_1["data"];
-        
-                    if(!data.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    if(!data.HasMember("tx_ids"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    const rapidjson::Value &tx_ids = data["tx_ids"];
-                    const rapidjson::Value &tx = doc_1["tx"];
-        
-                    if(!tx_ids.IsArray())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!tx.IsArray())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    uint32 tx_num = tx_ids.Size();
+                    uint32 tx_num = header.m_tx_ids.size();
 
                     if(tx_num > 2000)
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
-        
-                    if(tx.Size() != tx_num)
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
 
                     if(tx_num != iter_block->m_tx_num)
                     {
@@ -2342,7 +2234,7 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                 
                     for(uint32 i = 0; i < tx_num; ++i)
                     {
-                        std::string tx_id = tx_ids[i].GetString();
+                        std::string tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
                         tx_list.PushBack(rapidjson::Value(tx_id.c_str(), allocator), allocator);
                     }
                 }
@@ -2558,24 +2450,10 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                     auto iter_block = iter->second;
                     uint64 cur_block_id = iter_block->id();
                     const std::string& block_hash = iter_block->hash();
-                    std::string block_data;
-                    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
-                    
-                    if(!s.ok())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-                    
                     rapidjson::Document doc;
-                    const char *block_data_str = block_data.c_str();
-                    doc.Parse(block_data_str);
+                    Store_Status s = m_committer.get_block(block_hash, doc);
                     
-                    if(doc.HasParseError())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!doc.IsObject())
+                    if(!s.ok())
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
@@ -2999,6 +2877,9 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
             }
             else if(cmd == net::api::EXCHANGE_LIST_DEPOSIT)
             {
+                // an exchange credits what it is told here, the blocks must be in leveldb before the answer
+                m_committer.wait_all();
+                
                 if(!doc.HasMember("required_confirms"))
                 {
                     connection->close();
@@ -3053,6 +2934,12 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                         ASKCOIN_RETURN;
                     }
                 }
+
+                if(block_id_need <= m_pruned_block_id)
+                {
+                    connection->close();
+                    ASKCOIN_RETURN;
+                }
                 
                 auto iter = m_account_by_id.find(wsock_node->m_exchange_account_id);
                 
@@ -3066,37 +2953,18 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                 uint64 iter_block_id = block_id_need;
                 rapidjson::Value deposits(rapidjson::kArrayType);
 
-                while(iter_block_id <= cur_block_id)
+                std::vector<std::string> block_hashes;
+                get_main_chain_hashes(block_id_need, cur_block_id, block_hashes);
+                
+                for(const std::string &block_hash : block_hashes)
                 {
-                    auto iter_1 = m_block_by_id.find(iter_block_id);
-                    
-                    if(iter_1 == m_block_by_id.end())
-                    {
-                        break;
-                    }
-                    
-                    std::shared_ptr<Block> iter_block = iter_1->second;
-                    std::string block_data;
-                    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
+                    rapidjson::Document doc_1;
+                    Store_Status s = m_committer.get_block(block_hash, doc_1);
                     
                     if(!s.ok())
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
-                    
-                    rapidjson::Document doc_1;
-                    const char *block_data_str = block_data.c_str();
-                    doc_1.Parse(block_data_str);
-        
-                    if(doc_1.HasParseError())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!doc_1.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
         
                     if(!doc_1.HasMember("data"))
                     {
@@ -3241,7 +3109,7 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                         deposit.AddMember("tx_id", rapidjson::Value(tx_id.c_str(), allocator), allocator);
                         deposit.AddMember("confirms", confirm_num, allocator);
                         deposit.AddMember("sender_id", account->id(), allocator);
-                        deposit.AddMember("block_hash", rapidjson::StringRef(iter_block->hash().c_str()), allocator);
+                        deposit.AddMember("block_hash", rapidjson::Value(block_hash.c_str(), allocator), allocator);
                         
                         if(confirm_num == required_confirms)
                         {
@@ -3271,6 +3139,8 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
             }
             else if(cmd == net::api::EXCHANGE_LIST_WITHDRAW)
             {
+                m_committer.wait_all();
+                
                 if(!doc.HasMember("required_confirms"))
                 {
                     connection->close();
@@ -3326,6 +3196,12 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                     }
                 }
 
+                if(block_id_need <= m_pruned_block_id)
+                {
+                    connection->close();
+                    ASKCOIN_RETURN;
+                }
+
                 auto iter = m_account_by_id.find(wsock_node->m_exchange_account_id);
                 
                 if(iter == m_account_by_id.end())
@@ -3338,37 +3214,18 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                 uint64 iter_block_id = block_id_need;
                 rapidjson::Value withdraws(rapidjson::kArrayType);
 
-                while(iter_block_id <= cur_block_id)
+                std::vector<std::string> block_hashes;
+                get_main_chain_hashes(block_id_need, cur_block_id, block_hashes);
+                
+                for(const std::string &block_hash : block_hashes)
                 {
-                    auto iter_1 = m_block_by_id.find(iter_block_id);
-                    
-                    if(iter_1 == m_block_by_id.end())
-                    {
-                        break;
-                    }
-                    
-                    std::shared_ptr<Block> iter_block = iter_1->second;
-                    std::string block_data;
-                    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
+                    rapidjson::Document doc_1;
+                    Store_Status s = m_committer.get_block(block_hash, doc_1);
                     
                     if(!s.ok())
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
-                    
-                    rapidjson::Document doc_1;
-                    const char *block_data_str = block_data.c_str();
-                    doc_1.Parse(block_data_str);
-        
-                    if(doc_1.HasParseError())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!doc_1.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
         
                     if(!doc_1.HasMember("data"))
                     {
@@ -3512,7 +3369,7 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                         withdraw.AddMember("tx_id", rapidjson::Value(tx_id.c_str(), allocator), allocator);
                         withdraw.AddMember("confirms", confirm_num, allocator);
                         withdraw.AddMember("receiver_id", receiver->id(), allocator);
-                        withdraw.AddMember("block_hash", rapidjson::StringRef(iter_block->hash().c_str()), allocator);
+                        withdraw.AddMember("block_hash", rapidjson::Value(block_hash.c_str(), allocator), allocator);
                         
                         if(confirm_num == required_confirms)
                         {
@@ -3542,6 +3399,8 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
             }
             else if(cmd == net::api::EXCHANGE_DEPOSIT_TX_PROBE)
             {
+                m_committer.wait_all();
+                
                 if(!doc.HasMember("block_hash"))
                 {
                     connection->close();
@@ -3779,78 +3638,23 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                     }
                     
                     std::shared_ptr<Block> iter_block = m_block_by_id[iter_block_id];
-                    std::string block_data;
-                    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
-                    
-                    if(!s.ok())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    rapidjson::Document doc_1;
-                    const char *block_data_str = block_data.c_str();
-                    doc_1.Parse(block_data_str);
-        
-                    if(doc_1.HasParseError())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!doc_1.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    if(!doc_1.HasMember("data"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
+                    Block_Record::Header header;
 
-                    if(!doc_1.HasMember("tx"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    const rapidjson::Value &data = doc_1["data"];
-        
-                    if(!data.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    if(!data.HasMember("tx_ids"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    const rapidjson::Value &tx_ids = data["tx_ids"];
-                    const rapidjson::Value &tx = doc_1["tx"];
-        
-                    if(!tx_ids.IsArray())
+                    if(!get_block_header(iter_block->hash(), header) || header.m_pruned)
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
 
-                    if(!tx.IsArray())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    uint32 tx_num = tx_ids.Size();
+                    uint32 tx_num = header.m_tx_ids.size();
 
                     if(tx_num > 2000)
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
-        
-                    if(tx.Size() != tx_num)
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
                 
                     for(uint32 i = 0; i < tx_num; ++i)
                     {
-                        std::string _tx_id = tx_ids[i].GetString();
+                        std::string _tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
 
                         if(_tx_id == tx_id)
                         {
@@ -3870,6 +3674,8 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
             }
             else if(cmd == net::api::EXCHANGE_WITHDRAW_TX_PROBE)
             {
+                m_committer.wait_all();
+                
                 if(!doc.HasMember("block_id"))
                 {
                     connection->close();
@@ -4060,78 +3866,23 @@ void Blockchain::do_wsock_message(std::unique_ptr<fly::net::Message<Wsock>> &mes
                     }
                     
                     std::shared_ptr<Block> iter_block = m_block_by_id[iter_block_id];
-                    std::string block_data;
-                    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), iter_block->hash(), &block_data);
-                    
-                    if(!s.ok())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
+                    Block_Record::Header header;
 
-                    rapidjson::Document doc_1;
-                    const char *block_data_str = block_data.c_str();
-                    doc_1.Parse(block_data_str);
-        
-                    if(doc_1.HasParseError())
+                    if(!get_block_header(iter_block->hash(), header) || header.m_pruned)
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
 
-                    if(!doc_1.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    if(!doc_1.HasMember("data"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!doc_1.HasMember("tx"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    const rapidjson::Value &data = doc_1["data"];
-        
-                    if(!data.IsObject())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    if(!data.HasMember("tx_ids"))
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    const rapidjson::Value &tx_ids = data["tx_ids"];
-                    const rapidjson::Value &tx = doc_1["tx"];
-        
-                    if(!tx_ids.IsArray())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-
-                    if(!tx.IsArray())
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
-        
-                    uint32 tx_num = tx_ids.Size();
+                    uint32 tx_num = header.m_tx_ids.size();
 
                     if(tx_num > 2000)
                     {
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
-        
-                    if(tx.Size() != tx_num)
-                    {
-                        ASKCOIN_EXIT(EXIT_FAILURE);
-                    }
                 
                     for(uint32 i = 0; i < tx_num; ++i)
                     {
-                        std::string _tx_id = tx_ids[i].GetString();
+                        std::string _tx_id = fly::base::base64_encode(header.m_tx_ids[i].data(), header.m_tx_ids[i].length());
 
                         if(_tx_id == tx_id)
                         {
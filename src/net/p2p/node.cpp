@@ -9,6 +9,8 @@
 #include "message.hpp"
 #include "version.hpp"
 #include "blockchain.hpp"
+#include "block_record.hpp"
+#include "verify_pool.hpp"
 #include "utilstrencodings.h"
 
 using namespace std::placeholders;
@@ -1868,45 +1870,28 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
                 }
             }
             
-            std::string block_data;
-            leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
+            Block_Record::Header header;
             
-            if(!s.ok())
+            if(!get_block_header(block_hash, header))
             {
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
             
-            rapidjson::Document doc;
-            const char *block_data_str = block_data.c_str();
-            doc.Parse(block_data_str);
-            
-            if(doc.HasParseError())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-
-            if(!doc.IsObject())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            rapidjson::Value &hash_node = doc["hash"];
-            std::string block_hash_db = hash_node.GetString();
+            std::string block_hash_db = fly::base::base64_encode(header.m_hash.data(), header.m_hash.length());
             
             if(block_hash != block_hash_db)
             {
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
             
-            rapidjson::Value &sign_node = doc["sign"];
-            rapidjson::Value &data = doc["data"];
+            std::string block_sign = fly::base::base64_encode(header.m_sign.data(), header.m_sign.length());
             rapidjson::Document doc_rsp;
             doc_rsp.SetObject();
             rapidjson::Document::AllocatorType &allocator = doc_rsp.GetAllocator();
             doc_rsp.AddMember("msg_type", net::p2p::MSG_BLOCK, allocator);
             doc_rsp.AddMember("msg_cmd", net::p2p::BLOCK_BROADCAST, allocator);
-            doc_rsp.AddMember("hash", hash_node, allocator);
-            doc_rsp.AddMember("sign", sign_node, allocator);
+            doc_rsp.AddMember("hash", rapidjson::Value(block_hash.c_str(), allocator), allocator);
+            doc_rsp.AddMember("sign", rapidjson::Value(block_sign.c_str(), allocator), allocator);
             rapidjson::Value pow_arr(rapidjson::kArrayType);
     
             for(int32 i = 0; i < 9; ++i)
@@ -1915,6 +1900,8 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
             }
             
             doc_rsp.AddMember("pow", pow_arr, allocator);
+            rapidjson::Value data;
+            header.data_value(data, allocator);
             doc_rsp.AddMember("data", data, allocator);
             doc_rsp.AddMember("ratio", ratio, allocator);
             connection->send(doc_rsp);
@@ -1981,39 +1968,24 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
             }
             
             doc_rsp.AddMember("result", 1, allocator);
-            std::string block_data;
-            leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
+            Block_Record::Header header;
             
-            if(!s.ok())
+            if(!get_block_header(block_hash, header))
             {
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
             
-            rapidjson::Document doc;
-            const char *block_data_str = block_data.c_str();
-            doc.Parse(block_data_str);
-            
-            if(doc.HasParseError())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-
-            if(!doc.IsObject())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            rapidjson::Value &hash_node = doc["hash"];
-            std::string block_hash_db = hash_node.GetString();
+            std::string block_hash_db = fly::base::base64_encode(header.m_hash.data(), header.m_hash.length());
             
             if(block_hash != block_hash_db)
             {
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
             
-            rapidjson::Value &sign_node = doc["sign"];
-            rapidjson::Value &data = doc["data"];
-            doc_rsp.AddMember("sign", sign_node, allocator);
+            std::string block_sign = fly::base::base64_encode(header.m_sign.data(), header.m_sign.length());
+            rapidjson::Value data;
+            header.data_value(data, allocator);
+            doc_rsp.AddMember("sign", rapidjson::Value(block_sign.c_str(), allocator), allocator);
             doc_rsp.AddMember("data", data, allocator);
             connection->send(doc_rsp);
         }
@@ -2475,30 +2447,23 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
                     ASKCOIN_RETURN;
                 }
             }
-            
-            std::string block_data;
-            leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
-            
-            if(!s.ok())
+
+            // only the header is left, the peer times out and asks another one
+            if(iter->second->m_in_main_chain && block_id <= m_pruned_block_id)
             {
-                ASKCOIN_EXIT(EXIT_FAILURE);
+                LOG_DEBUG_INFO("block detail is not available, the body was pruned, block_id: %lu, block_hash: %s", block_id, block_hash.c_str());
+                ASKCOIN_RETURN;
             }
             
-            rapidjson::Document doc;
-            const char *block_data_str = block_data.c_str();
-            doc.Parse(block_data_str);
+            std::shared_ptr<const rapidjson::Document> doc_ptr;
             
-            if(doc.HasParseError())
+            if(!get_block_doc(block_hash, doc_ptr))
             {
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
 
-            if(!doc.IsObject())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            rapidjson::Value &hash_node = doc["hash"];
+            const rapidjson::Document &doc = *doc_ptr;
+            const rapidjson::Value &hash_node = doc["hash"];
             std::string block_hash_db = hash_node.GetString();
             
             if(block_hash != block_hash_db)
@@ -2506,19 +2471,20 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
                 ASKCOIN_EXIT(EXIT_FAILURE);
             }
 
-            rapidjson::Value &sign_node = doc["sign"];
-            rapidjson::Value &data = doc["data"];
-            rapidjson::Value &tx_node = doc["tx"];
+            const rapidjson::Value &sign_node = doc["sign"];
+            const rapidjson::Value &data = doc["data"];
+            const rapidjson::Value &tx_node = doc["tx"];
             {
+                // the cached document is shared, so its members are copied instead of moved
                 rapidjson::Document doc;
                 doc.SetObject();
                 rapidjson::Document::AllocatorType &allocator = doc.GetAllocator();
                 doc.AddMember("msg_type", net::p2p::MSG_BLOCK, allocator);
                 doc.AddMember("msg_cmd", net::p2p::BLOCK_DETAIL_RSP, allocator);
-                doc.AddMember("hash", hash_node, allocator);
-                doc.AddMember("sign", sign_node, allocator);
-                doc.AddMember("data", data, allocator);
-                doc.AddMember("tx", tx_node, allocator);
+                doc.AddMember("hash", rapidjson::Value(hash_node, allocator), allocator);
+                doc.AddMember("sign", rapidjson::Value(sign_node, allocator), allocator);
+                doc.AddMember("data", rapidjson::Value(data, allocator), allocator);
+                doc.AddMember("tx", rapidjson::Value(tx_node, allocator), allocator);
                 connection->send(doc);
             }
         }
@@ -2686,6 +2652,56 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
                 ASKCOIN_RETURN;
             }
 
+            // hash the data of all txs at once, so that the multi-buffer sha256 can be used,
+            // malformed txs are left empty here and rejected in the loop below.
+            std::vector<std::string> tx_datas(tx_num);
+            std::vector<const char*> tx_data_ptrs(tx_num);
+            std::vector<uint32> tx_data_sizes(tx_num);
+            std::vector<char> tx_hashes(tx_num * 32 + 1);
+            
+            for(uint32 i = 0; i < tx_num; ++i)
+            {
+                const rapidjson::Value &tx_node = tx[i];
+                
+                if(tx_node.IsObject() && tx_node.HasMember("data") && tx_node["data"].IsObject())
+                {
+                    rapidjson::StringBuffer buffer;
+                    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+                    tx_node["data"].Accept(writer);
+                    tx_datas[i].assign(buffer.GetString(), buffer.GetSize());
+                }
+
+                tx_data_ptrs[i] = tx_datas[i].data();
+                tx_data_sizes[i] = tx_datas[i].size();
+            }
+
+            if(tx_num > 0)
+            {
+                coin_hash_multi(&tx_data_ptrs[0], &tx_data_sizes[0], tx_num, &tx_hashes[0]);
+            }
+
+            // check the signatures of all txs on Verify_Pool, malformed txs are skipped here
+            // and rejected in the loop below.
+            std::vector<char> tx_sign_ok(tx_num);
+            Verify_Pool::instance()->run(Verify_Pool::LANE_SIGN, tx_num, [&](uint32 i) {
+                    const rapidjson::Value &tx_node = tx[i];
+                    
+                    if(tx_datas[i].empty() || !tx_node.HasMember("sign") || !tx_node["sign"].IsString())
+                    {
+                        return;
+                    }
+
+                    const rapidjson::Value &data = tx_node["data"];
+
+                    if(!data.HasMember("pubkey") || !data["pubkey"].IsString())
+                    {
+                        return;
+                    }
+                    
+                    std::string tx_id = fly::base::base64_encode(&tx_hashes[i * 32], 32);
+                    tx_sign_ok[i] = check_sign(data["pubkey"].GetString(), tx_id, tx_node["sign"].GetString());
+                });
+            
             for(uint32 i = 0; i < tx_num; ++i)
             {
                 std::string tx_id = tx_ids[i].GetString();
@@ -2737,10 +2753,7 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
                     ASKCOIN_RETURN;
                 }
 
-                rapidjson::StringBuffer buffer;
-                rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-                data.Accept(writer);
-                std::string tx_id_verify = coin_hash_b64(buffer.GetString(), buffer.GetSize());
+                std::string tx_id_verify = fly::base::base64_encode(&tx_hashes[i * 32], 32);
             
                 if(tx_id != tx_id_verify)
                 {
@@ -2786,7 +2799,7 @@ void Blockchain::do_peer_message(std::unique_ptr<fly::net::Message<Json>> &messa
                     ASKCOIN_RETURN;
                 }
 
-                if(!verify_sign(pubkey, tx_id, tx_sign))
+                if(!tx_sign_ok[i])
                 {
                     punish_peer(peer);
                     ASKCOIN_RETURN;
@@ -5671,71 +5684,36 @@ void Blockchain::finish_detail(std::shared_ptr<Pending_Detail_Request> request)
             }
 
             m_miner_pubkeys.insert(miner_pubkey);
-            std::string block_data;
-            leveldb::Status s;
-            
-            if(block_id == 1)
-            {
-                s = m_db->Get(leveldb::ReadOptions(), "0", &block_data);
-            }
-            else
-            {
-                s = m_db->Get(leveldb::ReadOptions(), pre_hash, &block_data);
-            }
-            
-            if(!s.ok())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            rapidjson::Document doc_parent;
-            const char *block_data_str = block_data.c_str();
-            doc_parent.Parse(block_data_str);
-            
-            if(doc_parent.HasParseError())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            if(!doc_parent.IsObject())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            if(!doc_parent.HasMember("children"))
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            rapidjson::Value &children = doc_parent["children"];
-
-            if(!children.IsArray())
-            {
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
-            bool exist_in_children = false;
+            Store_Status s;
+            std::string edge_key = child_edge_key(block_id == 1 ? "0" : pre_hash, block_hash);
+            bool exist_in_children = true;
             bool exist_block_hash = true;
             
-            for(rapidjson::Value::ConstValueIterator iter = children.Begin(); iter != children.End(); ++iter)
             {
-                if(block_hash == iter->GetString())
+                std::string edge_data;
+                Store_Status s = m_committer.get(edge_key, &edge_data);
+
+                if(!s.ok())
                 {
-                    exist_in_children = true;
-                    LOG_DEBUG_INFO("exist_in_children = true, block_hash: %s, pre_hash: %s", block_hash.c_str(), pre_hash.c_str());
-                    break;
+                    if(!s.is_not_found())
+                    {
+                        CONSOLE_LOG_FATAL("read from leveldb failed, key: %s, reason: %s", edge_key.c_str(), s.to_string().c_str());
+                        ASKCOIN_EXIT(EXIT_FAILURE);
+                    }
+
+                    exist_in_children = false;
                 }
             }
             
             {
                 std::string block_data;
-                leveldb::Status s = m_db->Get(leveldb::ReadOptions(), block_hash, &block_data);
+                Store_Status s = m_committer.get(block_hash, &block_data);
             
                 if(!s.ok())
                 {
-                    if(!s.IsNotFound())
+                    if(!s.is_not_found())
                     {
-                        CONSOLE_LOG_FATAL("read from leveldb failed, hash: %s, reason: %s", block_hash.c_str(), s.ToString().c_str());
+                        CONSOLE_LOG_FATAL("read from leveldb failed, hash: %s, reason: %s", block_hash.c_str(), s.to_string().c_str());
                         ASKCOIN_EXIT(EXIT_FAILURE);
                     }
                     
@@ -5757,41 +5735,23 @@ void Blockchain::finish_detail(std::shared_ptr<Pending_Detail_Request> request)
             doc_1.AddMember("tx", doc["tx"], allocator);
             rapidjson::Value children_arr(rapidjson::kArrayType);
             doc_1.AddMember("children", children_arr, allocator);
-            rapidjson::StringBuffer buffer_1;
-            rapidjson::Writer<rapidjson::StringBuffer> writer_1(buffer_1);
-            doc_1.Accept(writer_1);
-            leveldb::WriteBatch batch;
-            batch.Put(block_hash, leveldb::Slice(buffer_1.GetString(), buffer_1.GetSize()));
+            std::unique_ptr<Store_Batch> batch(new Store_Batch);
+            Block_Store::put_block(*batch, block_hash, doc_1);
+            batch->put(edge_key, std::string());
             doc["hash"] = doc_1["hash"];
             doc["sign"] = doc_1["sign"];
             doc["data"] = doc_1["data"];
-            children.PushBack(rapidjson::StringRef(block_hash.c_str()), doc_parent.GetAllocator());
-            rapidjson::StringBuffer buffer_2;
-            rapidjson::Writer<rapidjson::StringBuffer> writer_2(buffer_2);
-            doc_parent.Accept(writer_2);
-
-            if(block_id == 1)
-            {
-                batch.Put("0", leveldb::Slice(buffer_2.GetString(), buffer_2.GetSize()));
-            }
-            else
-            {
-                batch.Put(pre_hash, leveldb::Slice(buffer_2.GetString(), buffer_2.GetSize()));
-            }
             
             LOG_DEBUG_INFO("finish_detail, block_id: %lu, block_hash: %s, start write to leveldb", block_id, block_hash.c_str());
-            s = m_db->Write(leveldb::WriteOptions(), &batch);
-            
-            if(!s.ok())
-            {
-                LOG_FATAL("writebatch failed, block_hash: %s, pre_hash: %s", block_hash.c_str(), pre_hash.c_str());
-                ASKCOIN_EXIT(EXIT_FAILURE);
-            }
-            
+            put_verified_marker(*batch, block_id, block_hash);
+            batch->put(height_key(block_id), block_hash);
+
+            // consecutive blocks of a sync queue up here and are written in groups
+            m_committer.commit(std::move(batch));
             char hash_raw[32];
             fly::base::base64_decode(block_hash.c_str(), block_hash.length(), hash_raw, 32);
             std::string hex_hash = fly::base::byte2hexstr(hash_raw, 32);
-            LOG_INFO("finish_detail, block_id: %lu, block_hash: %s (hex: %s), write to leveldb completely", block_id, \
+            LOG_INFO("finish_detail, block_id: %lu, block_hash: %s (hex: %s), queued to leveldb", block_id, \
                      block_hash.c_str(), hex_hash.c_str());
             m_blocks.insert(std::make_pair(block_hash, cur_block));
             m_block_by_id.insert(std::make_pair(block_id, cur_block));
@@ -0,0 +1,75 @@
+#include "pow_cache.hpp"
+
+Pow_Cache::Pow_Cache()
+{
+}
+
+std::string Pow_Cache::key(const std::string &block_hash, const char data_hash[32], uint32 zero_bits)
+{
+    std::string k = block_hash;
+    k.append(data_hash, 32);
+    k.append((const char*)&zero_bits, sizeof(zero_bits));
+    
+    return k;
+}
+
+bool Pow_Cache::get(const std::string &block_hash, const char data_hash[32], uint32 zero_bits, bool &result)
+{
+    std::string k = key(block_hash, data_hash, zero_bits);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_map.find(k);
+
+    if(iter == m_map.end())
+    {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        
+        return false;
+    }
+
+    m_lru.splice(m_lru.begin(), m_lru, iter->second);
+    result = iter->second->second;
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    
+    return true;
+}
+
+void Pow_Cache::put(const std::string &block_hash, const char data_hash[32], uint32 zero_bits, bool result)
+{
+    std::string k = key(block_hash, data_hash, zero_bits);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_map.find(k);
+
+    if(iter != m_map.end())
+    {
+        iter->second->second = result;
+        m_lru.splice(m_lru.begin(), m_lru, iter->second);
+        
+        return;
+    }
+
+    m_lru.push_front(std::make_pair(k, result));
+    m_map[k] = m_lru.begin();
+
+    if(m_lru.size() > MAX_SIZE)
+    {
+        m_map.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+}
+
+uint64 Pow_Cache::hits() const
+{
+    return m_hits.load(std::memory_order_relaxed);
+}
+
+uint64 Pow_Cache::misses() const
+{
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+uint32 Pow_Cache::size()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    
+    return m_lru.size();
+}
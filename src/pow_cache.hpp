@@ -0,0 +1,36 @@
+#ifndef POW_CACHE
+#define POW_CACHE
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include "fly/base/common.hpp"
+#include "fly/base/singleton.hpp"
+
+// remembers the result of the asic resistant pow check, the same block usually
+// arrives from many peers by BLOCK_BROADCAST, BLOCK_BRIEF_RSP and BLOCK_DETAIL_RSP.
+// an entry is keyed by block hash, hash of block data and zero_bits, so a block
+// hash which is sent along with other data is verified again.
+class Pow_Cache : public fly::base::Singleton<Pow_Cache>
+{
+public:
+    Pow_Cache();
+    bool get(const std::string &block_hash, const char data_hash[32], uint32 zero_bits, bool &result);
+    void put(const std::string &block_hash, const char data_hash[32], uint32 zero_bits, bool result);
+    uint64 hits() const;
+    uint64 misses() const;
+    uint32 size();
+    
+private:
+    std::string key(const std::string &block_hash, const char data_hash[32], uint32 zero_bits);
+    const uint32 MAX_SIZE = 20000;
+    std::list<std::pair<std::string, bool>> m_lru;
+    std::unordered_map<std::string, std::list<std::pair<std::string, bool>>::iterator> m_map;
+    std::mutex m_mutex;
+    std::atomic<uint64> m_hits{0};
+    std::atomic<uint64> m_misses{0};
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include <cstring>
+#include "snapshot.hpp"
+
+Snapshot_Writer::Snapshot_Writer()
+{
+}
+
+void Snapshot_Writer::put_uint32(uint32 value)
+{
+    char buf[4];
+
+    for(uint32 i = 0; i < 4; ++i)
+    {
+        buf[i] = (char)(value >> (i * 8));
+    }
+
+    m_buf.append(buf, 4);
+}
+
+void Snapshot_Writer::put_uint64(uint64 value)
+{
+    char buf[8];
+
+    for(uint32 i = 0; i < 8; ++i)
+    {
+        buf[i] = (char)(value >> (i * 8));
+    }
+
+    m_buf.append(buf, 8);
+}
+
+void Snapshot_Writer::put_string(const std::string &value)
+{
+    put_uint32(value.length());
+    m_buf.append(value);
+}
+
+const std::string& Snapshot_Writer::finish()
+{
+    char buf[20] = {0};
+    fly::base::sha1(m_buf.data(), m_buf.length(), buf, 20);
+    m_buf.append(buf, 20);
+
+    return m_buf;
+}
+
+Snapshot_Reader::Snapshot_Reader(const std::string &data)
+    : m_data(data)
+{
+    m_pos = 0;
+    m_end = data.length();
+}
+
+bool Snapshot_Reader::verify()
+{
+    if(m_data.length() < 20)
+    {
+        return false;
+    }
+
+    char buf[20] = {0};
+    uint64 len = m_data.length() - 20;
+
+    if(!fly::base::sha1(m_data.data(), len, buf, 20))
+    {
+        return false;
+    }
+
+    if(memcmp(buf, m_data.data() + len, 20) != 0)
+    {
+        return false;
+    }
+
+    m_end = len;
+
+    return true;
+}
+
+bool Snapshot_Reader::get_uint32(uint32 &value)
+{
+    if(m_pos + 4 > m_end)
+    {
+        return false;
+    }
+
+    value = 0;
+
+    for(uint32 i = 0; i < 4; ++i)
+    {
+        value |= (uint32)(uint8)m_data[m_pos + i] << (i * 8);
+    }
+
+    m_pos += 4;
+
+    return true;
+}
+
+bool Snapshot_Reader::get_uint64(uint64 &value)
+{
+    if(m_pos + 8 > m_end)
+    {
+        return false;
+    }
+
+    value = 0;
+
+    for(uint32 i = 0; i < 8; ++i)
+    {
+        value |= (uint64)(uint8)m_data[m_pos + i] << (i * 8);
+    }
+
+    m_pos += 8;
+
+    return true;
+}
+
+bool Snapshot_Reader::get_string(std::string &value)
+{
+    uint32 len = 0;
+
+    if(!get_uint32(len))
+    {
+        return false;
+    }
+
+    if(m_pos + len > m_end)
+    {
+        return false;
+    }
+
+    value.assign(m_data, m_pos, len);
+    m_pos += len;
+
+    return true;
+}
+
+bool Snapshot_Reader::eof() const
+{
+    return m_pos == m_end;
+}
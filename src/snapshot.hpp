@@ -0,0 +1,45 @@
+#ifndef SNAPSHOT
+#define SNAPSHOT
+
+#include <string>
+#include "fly/base/common.hpp"
+
+const uint32 SNAPSHOT_VERSION = 1;
+
+// binary encoding of the in-memory chain state written to leveldb under
+// "snapshot_<block_id>". integers are little-endian fixed width, strings are
+// prefixed by a uint32 length. the whole payload is followed by its sha1.
+class Snapshot_Writer
+{
+public:
+    Snapshot_Writer();
+    void put_uint32(uint32 value);
+    void put_uint64(uint64 value);
+    void put_string(const std::string &value);
+
+    // appends the sha1 of everything written so far and returns the payload
+    const std::string& finish();
+
+private:
+    std::string m_buf;
+};
+
+class Snapshot_Reader
+{
+public:
+    Snapshot_Reader(const std::string &data);
+
+    // checks and strips the sha1 appended by Snapshot_Writer::finish
+    bool verify();
+    bool get_uint32(uint32 &value);
+    bool get_uint64(uint64 &value);
+    bool get_string(std::string &value);
+    bool eof() const;
+
+private:
+    const std::string &m_data;
+    uint64 m_pos;
+    uint64 m_end;
+};
+
+#endif
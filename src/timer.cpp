@@ -24,6 +24,15 @@ uint64 Timer::now_msec()
     return now_msec;
 }
 
+uint64 Timer::now_usec()
+{
+    struct timeval _tv;
+    gettimeofday(&_tv, NULL);
+    uint64 now_usec = (uint64)_tv.tv_sec * 1000000 + (uint64)_tv.tv_usec;
+
+    return now_usec;
+}
+
 Timer_Controller::Timer_Controller()
 {
 }
@@ -21,6 +21,7 @@ public:
     Timer(uint64 id, uint64 tick, std::function<void()> cb, uint32 interval_tick, bool oneshot = false);
     ~Timer();
     static uint64 now_msec();
+    static uint64 now_usec();
     uint64 m_tick;
     uint64 m_id;
     uint32 m_interval_tick;
@@ -839,6 +839,13 @@ void coin_hash(const char *data, uint32 size, char h_256[CSHA256::OUTPUT_SIZE])
     CHash256().Write(data, size).Finalize(h_256);
 }
 
+// coin_hash of num independent buffers into h_256 (num * 32 bytes)
+void coin_hash_multi(const char* const data[], const uint32 size[], uint32 num, char *h_256)
+{
+    std::vector<size_t> len(size, size + num);
+    SHA256DMulti((unsigned char*)h_256, (const unsigned char* const*)data, &len[0], num);
+}
+
 std::string coin_hash_b64(const char *data, uint32 size)
 {
     char h_256[CSHA256::OUTPUT_SIZE];
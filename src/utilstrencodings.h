@@ -191,6 +191,7 @@ bool TimingResistantEqual(const T& a, const T& b)
 bool ParseFixedPoint(const std::string &val, int decimals, int64_t *amount_out);
 
 void coin_hash(const char *data, uint32 size, char h_256[CSHA256::OUTPUT_SIZE]);
+void coin_hash_multi(const char* const data[], const uint32 size[], uint32 num, char *h_256);
 std::string coin_hash_b64(const char *data, uint32 size);
 std::string coin_addr_b64(const char *pubkey, uint32 size);
 
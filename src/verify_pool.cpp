@@ -0,0 +1,197 @@
+#include <unistd.h>
+#include <atomic>
+#include "verify_pool.hpp"
+
+Verify_Pool::Verify_Pool()
+{
+    int32 cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if(cpu_num < 1)
+    {
+        cpu_num = 1;
+    }
+
+    // every pow job streams the whole __asic_resistant_data__, more threads than
+    // half of the cores only compete for memory bandwidth.
+    m_lanes[LANE_SIGN].m_thread_num = cpu_num;
+    m_lanes[LANE_POW].m_thread_num = cpu_num > 1 ? cpu_num / 2 : 1;
+}
+
+Verify_Pool::~Verify_Pool()
+{
+    stop();
+    wait();
+}
+
+void Verify_Pool::set_thread_num(uint32 sign_thread_num, uint32 pow_thread_num)
+{
+    if(sign_thread_num > 0)
+    {
+        m_lanes[LANE_SIGN].m_thread_num = sign_thread_num;
+    }
+
+    if(pow_thread_num > 0)
+    {
+        m_lanes[LANE_POW].m_thread_num = pow_thread_num;
+    }
+}
+
+uint32 Verify_Pool::thread_num(uint32 lane)
+{
+    return m_lanes[lane].m_thread_num;
+}
+
+void Verify_Pool::start()
+{
+    for(uint32 lane = 0; lane < LANE_NUM; ++lane)
+    {
+        for(uint32 i = 0; i < m_lanes[lane].m_thread_num; ++i)
+        {
+            m_lanes[lane].m_threads.push_back(std::thread(std::bind(&Verify_Pool::do_work, this, lane)));
+        }
+    }
+}
+
+void Verify_Pool::stop()
+{
+    for(uint32 lane = 0; lane < LANE_NUM; ++lane)
+    {
+        std::lock_guard<std::mutex> guard(m_lanes[lane].m_mutex);
+        m_lanes[lane].m_stop = true;
+        m_lanes[lane].m_not_empty.notify_all();
+        m_lanes[lane].m_not_full.notify_all();
+    }
+}
+
+void Verify_Pool::wait()
+{
+    for(uint32 lane = 0; lane < LANE_NUM; ++lane)
+    {
+        for(auto &thread : m_lanes[lane].m_threads)
+        {
+            if(thread.joinable())
+            {
+                thread.join();
+            }
+        }
+
+        m_lanes[lane].m_threads.clear();
+    }
+}
+
+void Verify_Pool::do_work(uint32 lane)
+{
+    Lane &l = m_lanes[lane];
+
+    while(true)
+    {
+        std::unique_lock<std::mutex> lock(l.m_mutex);
+        l.m_not_empty.wait(lock, [&] {
+                return l.m_stop || !l.m_jobs.empty();
+            });
+
+        if(l.m_jobs.empty())
+        {
+            return;
+        }
+
+        std::function<void()> job = std::move(l.m_jobs.front());
+        l.m_jobs.pop_front();
+        l.m_not_full.notify_one();
+        lock.unlock();
+        job();
+    }
+}
+
+void Verify_Pool::post(uint32 lane, std::function<void()> job)
+{
+    Lane &l = m_lanes[lane];
+    std::unique_lock<std::mutex> lock(l.m_mutex);
+    l.m_not_full.wait(lock, [&] {
+            return l.m_stop || l.m_jobs.size() < MAX_QUEUE_SIZE;
+        });
+
+    if(l.m_stop)
+    {
+        lock.unlock();
+        job();
+
+        return;
+    }
+
+    l.m_jobs.push_back(std::move(job));
+    l.m_not_empty.notify_one();
+}
+
+bool Verify_Pool::try_post(uint32 lane, std::function<void()> job)
+{
+    Lane &l = m_lanes[lane];
+    std::lock_guard<std::mutex> guard(l.m_mutex);
+
+    if(l.m_stop || l.m_jobs.size() >= MAX_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    l.m_jobs.push_back(std::move(job));
+    l.m_not_empty.notify_one();
+
+    return true;
+}
+
+void Verify_Pool::run(uint32 lane, uint32 num, std::function<void(uint32)> job)
+{
+    if(num == 0)
+    {
+        return;
+    }
+
+    struct Batch
+    {
+        std::atomic<uint32> m_next {0};
+        uint32 m_done = 0;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+    };
+
+    auto batch = std::make_shared<Batch>();
+
+    // a helper which starts after the batch is done finds no index left, so it
+    // never touches job, which may refer to the stack of the caller.
+    auto worker = [batch, num, &job] {
+        uint32 cnt = 0;
+
+        for(uint32 i = batch->m_next.fetch_add(1); i < num; i = batch->m_next.fetch_add(1))
+        {
+            job(i);
+            ++cnt;
+        }
+
+        if(cnt > 0)
+        {
+            std::lock_guard<std::mutex> guard(batch->m_mutex);
+            batch->m_done += cnt;
+
+            if(batch->m_done == num)
+            {
+                batch->m_cv.notify_one();
+            }
+        }
+    };
+
+    uint32 helper_num = std::min(num, m_lanes[lane].m_thread_num + 1) - 1;
+
+    for(uint32 i = 0; i < helper_num; ++i)
+    {
+        if(!try_post(lane, worker))
+        {
+            break;
+        }
+    }
+
+    worker();
+    std::unique_lock<std::mutex> lock(batch->m_mutex);
+    batch->m_cv.wait(lock, [&] {
+            return batch->m_done == num;
+        });
+}
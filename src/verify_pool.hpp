@@ -0,0 +1,64 @@
+#ifndef VERIFY_POOL
+#define VERIFY_POOL
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include "fly/base/common.hpp"
+#include "fly/base/singleton.hpp"
+
+// long-lived executor for verification work. LANE_SIGN takes cpu bound jobs
+// (ecdsa signatures, block parsing), LANE_POW takes the asic resistant pow which
+// is bound by memory bandwidth, so it usually wants fewer threads. every lane has
+// its own threads and bounded queue, a burst of one kind can not starve the other.
+class Verify_Pool : public fly::base::Singleton<Verify_Pool>
+{
+public:
+    enum LANE
+    {
+        LANE_SIGN = 0,
+        LANE_POW,
+        LANE_NUM
+    };
+
+    Verify_Pool();
+    ~Verify_Pool();
+    void set_thread_num(uint32 sign_thread_num, uint32 pow_thread_num);
+    uint32 thread_num(uint32 lane);
+    void start();
+    void stop();
+    void wait();
+
+    // queues job on the lane, blocks while the queue of the lane is full
+    void post(uint32 lane, std::function<void()> job);
+
+    // runs job(0) ... job(num - 1) on the lane and returns after all of them
+    // finished. the calling thread takes jobs as well, so it never waits on a
+    // full queue and may itself be a thread of the pool.
+    void run(uint32 lane, uint32 num, std::function<void(uint32)> job);
+
+private:
+    bool try_post(uint32 lane, std::function<void()> job);
+    void do_work(uint32 lane);
+
+    struct Lane
+    {
+        std::deque<std::function<void()>> m_jobs;
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        uint32 m_thread_num = 0;
+
+        // guarded by m_mutex like the queue, every lane stops on its own
+        bool m_stop = false;
+    };
+
+    const uint32 MAX_QUEUE_SIZE = 4096;
+    Lane m_lanes[LANE_NUM];
+};
+
+#endif